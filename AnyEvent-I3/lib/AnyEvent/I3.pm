@@ -101,11 +101,15 @@ use constant TYPE_GET_BINDING_MODES => 8;
 use constant TYPE_GET_CONFIG => 9;
 use constant TYPE_SEND_TICK => 10;
 use constant TYPE_SYNC => 11;
+use constant TYPE_GET_CLIENTS => 12;
+use constant TYPE_RUN_COMMANDS => 14;
+use constant TYPE_GET_STATS => 15;
 
 our %EXPORT_TAGS = ( 'all' => [
     qw(i3 TYPE_RUN_COMMAND TYPE_COMMAND TYPE_GET_WORKSPACES TYPE_SUBSCRIBE TYPE_GET_OUTPUTS
        TYPE_GET_TREE TYPE_GET_MARKS TYPE_GET_BAR_CONFIG TYPE_GET_VERSION
-       TYPE_GET_BINDING_MODES TYPE_GET_CONFIG TYPE_SEND_TICK TYPE_SYNC)
+       TYPE_GET_BINDING_MODES TYPE_GET_CONFIG TYPE_SEND_TICK TYPE_SYNC
+       TYPE_GET_CLIENTS TYPE_RUN_COMMANDS TYPE_GET_STATS)
 ] );
 
 our @EXPORT_OK = ( @{ $EXPORT_TAGS{all} } );
@@ -548,6 +552,32 @@ sub sync {
     $self->message(TYPE_SYNC, $payload);
 }
 
+=head2 get_clients
+
+Gets the connected IPC clients and the size of their output queues.
+
+=cut
+sub get_clients {
+    my ($self) = @_;
+
+    $self->_ensure_connection;
+
+    $self->message(TYPE_GET_CLIENTS);
+}
+
+=head2 get_stats
+
+Gets internal counters of i3.
+
+=cut
+sub get_stats {
+    my ($self) = @_;
+
+    $self->_ensure_connection;
+
+    $self->message(TYPE_GET_STATS);
+}
+
 =head2 command($content)
 
 Makes i3 execute the given command
@@ -564,6 +594,22 @@ sub command {
     $self->message(TYPE_RUN_COMMAND, $content)
 }
 
+=head2 commands(\@commands)
+
+Makes i3 execute all given commands, rendering the layout only once after the
+last command. The reply contains the reply of each command.
+
+    my $replies = i3->commands([ "workspace 3", "layout tabbed" ])->recv;
+
+=cut
+sub commands {
+    my ($self, $commands) = @_;
+
+    $self->_ensure_connection;
+
+    $self->message(TYPE_RUN_COMMANDS, $commands)
+}
+
 =head1 AUTHOR
 
 Michael Stapelberg, C<< <michael at i3wm.org> >>
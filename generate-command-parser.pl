@@ -126,6 +126,14 @@ for my $state (@keys, '__CALL') {
     $cnt++;
 }
 say $enumfh "\n} cmdp_state;";
+
+# The kind of every token is determined here once, so that the parser can
+# dispatch on it instead of comparing token names.
+my @kinds = qw(number string word end line error);
+say $enumfh 'typedef enum {';
+say $enumfh '    TOKEN_LITERAL = 0,';
+say $enumfh join(",\n", map { '    TOKEN_' . uc($_) } @kinds);
+say $enumfh '} cmdp_token_kind;';
 close($enumfh);
 
 # Third step: Generate the call function.
@@ -205,18 +213,79 @@ close($callfh);
 
 # Fourth step: Generate the token datastructures.
 
+# Escapes a character for use in a C character constant.
+sub c_char {
+    my ($char) = @_;
+    return "'\\\\'" if $char eq '\\';
+    return "'\\''" if $char eq "'";
+    return "'$char'";
+}
+
+# Builds a trie of all literals of the given state, so that the parser can find
+# the matching literal in a single pass over the input instead of comparing
+# every literal. Literals are matched case-insensitively, so the trie stores
+# them lowercased. Node 0 is the root, and 0 is used as "no node" for the child
+# and sibling references. Every node stores the (lowest) index of the token
+# whose literal ends at that node, or -1.
+sub build_trie {
+    my ($tokens) = @_;
+    my @nodes = ({ char => '', child => 0, sibling => 0, token => -1 });
+    for my $idx (0 .. $#$tokens) {
+        my $name = $tokens->[$idx]->{token};
+        next unless $name =~ /^'(.*)'$/;
+        my $node = 0;
+        for my $char (split(//, lc($1))) {
+            my $child = $nodes[$node]->{child};
+            my $last = 0;
+            while ($child != 0 && $nodes[$child]->{char} ne $char) {
+                $last = $child;
+                $child = $nodes[$child]->{sibling};
+            }
+            if ($child == 0) {
+                push @nodes, { char => $char, child => 0, sibling => 0, token => -1 };
+                $child = $#nodes;
+                if ($last == 0) {
+                    $nodes[$node]->{child} = $child;
+                } else {
+                    $nodes[$last]->{sibling} = $child;
+                }
+            }
+            $node = $child;
+        }
+        $nodes[$node]->{token} = $idx if $nodes[$node]->{token} == -1;
+    }
+    die "Too many literals in a single state" if scalar @nodes > 65535;
+    return @nodes;
+}
+
 open(my $tokfh, '>', "GENERATED_${prefix}_tokens.h");
 
 for my $state (@keys) {
     my $tokens = $states{$state};
+    my @trie = build_trie($tokens);
+    say $tokfh 'static const cmdp_trie_node trie_' . $state . '[' . scalar @trie . '] = {';
+    for my $node (@trie) {
+        my $char = ($node->{char} eq '' ? "'\\0'" : c_char($node->{char}));
+        say $tokfh "    { $char, $node->{child}, $node->{sibling}, $node->{token} },";
+    }
+    say $tokfh '};';
+
     say $tokfh 'static cmdp_token tokens_' . $state . '[' . scalar @$tokens . '] = {';
     for my $token (@$tokens) {
         my $call_identifier = 0;
         my $token_name = $token->{token};
+        my $kind;
+        my $length = 0;
         if ($token_name =~ /^'/) {
             # To make the C code simpler, we leave out the trailing single
             # quote of the literal. We can do strdup(literal + 1); then :).
             $token_name =~ s/'$//;
+            $kind = 'TOKEN_LITERAL';
+            $length = length($token_name) - 1;
+        } else {
+            die qq|Unknown token "$token_name" in state $state|
+                unless grep { $_ eq $token_name } @kinds;
+            $kind = 'TOKEN_' . uc($token_name);
         }
         my $next_state = $token->{next_state};
         if ($next_state =~ /^call /) {
@@ -224,7 +293,7 @@ for my $state (@keys) {
             $next_state = '__CALL';
         }
         my $identifier = $token->{identifier};
-        say $tokfh qq|    { "$token_name", "$identifier", $next_state, { $call_identifier } },|;
+        say $tokfh qq|    { "$token_name", "$identifier", $kind, $length, $next_state, { $call_identifier } },|;
     }
     say $tokfh '};';
 }
@@ -232,7 +301,7 @@ for my $state (@keys) {
 say $tokfh 'static cmdp_token_ptr tokens[' . scalar @keys . '] = {';
 for my $state (@keys) {
     my $tokens = $states{$state};
-    say $tokfh '    { tokens_' . $state . ', ' . scalar @$tokens . ' },';
+    say $tokfh '    { tokens_' . $state . ', ' . scalar @$tokens . ', trie_' . $state . ' },';
 }
 say $tokfh '};';
 
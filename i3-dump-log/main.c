@@ -26,6 +26,7 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <signal.h>
+#include <time.h>
 
 #include "libi3.h"
 #include "shmlog.h"
@@ -63,6 +64,157 @@ static void disable_shmlog(void) {
     free(reply);
 }
 
+/*
+ * Reads size bytes at *pos into value, unless that would go beyond end.
+ *
+ */
+static bool unpack(const char **pos, const char *end, void *value, size_t size) {
+    if (size > (size_t)(end - *pos))
+        return false;
+    memcpy(value, *pos, size);
+    *pos += size;
+    return true;
+}
+
+/*
+ * Formats and prints a record of the binary SHM log format, prefixed with the
+ * time, just like i3 does in the text format. Returns false if the record is
+ * malformed.
+ *
+ */
+static bool print_record(const i3_shmlog_record *record) {
+    const char *fmt = (const char *)record + sizeof(i3_shmlog_record);
+    const char *end = (const char *)record + record->size;
+    const char *pos = fmt + record->format_length + 1;
+    if (pos > end || fmt[record->format_length] != '\0')
+        return false;
+
+    const int64_t timestamp = (int64_t)record->timestamp + header->realtime_offset;
+    const time_t t = timestamp / 1000000000;
+    struct tm result;
+    char prefix[64];
+    if (strftime(prefix, sizeof(prefix), "%x %X - ", localtime_r(&t, &result)) > 0)
+        fputs(prefix, stdout);
+
+    const char *walk = fmt;
+    const char *percent;
+    while ((percent = strchr(walk, '%')) != NULL) {
+        fwrite(walk, 1, percent - walk, stdout);
+
+        printf_conversion conv;
+        if ((walk = parse_printf_conversion(percent, &conv)) == NULL)
+            return false;
+
+        int width = 0, precision = 0;
+        if (conv.star_width && !unpack(&pos, end, &width, sizeof(int)))
+            return false;
+        if (conv.star_precision && !unpack(&pos, end, &precision, sizeof(int)))
+            return false;
+
+/* Calls printf() with the '*' arguments the conversion needs. */
+#define PRINT_CONVERSION(value)                                      \
+    do {                                                             \
+        if (conv.star_width && conv.star_precision)                  \
+            printf(spec, width, precision, value);                   \
+        else if (conv.star_width)                                    \
+            printf(spec, width, value);                              \
+        else if (conv.star_precision)                                \
+            printf(spec, precision, value);                          \
+        else                                                         \
+            printf(spec, value);                                     \
+    } while (0)
+
+        char spec[sizeof(conv.spec) + 3];
+        switch (conv.type) {
+            case PRINTF_ARG_NONE:
+                fputc('%', stdout);
+                break;
+            case PRINTF_ARG_INT: {
+                int64_t value;
+                if (!unpack(&pos, end, &value, sizeof(int64_t)))
+                    return false;
+                if (conv.conversion == 'c') {
+                    snprintf(spec, sizeof(spec), "%sc", conv.spec);
+                    PRINT_CONVERSION((int)value);
+                } else {
+                    snprintf(spec, sizeof(spec), "%sll%c", conv.spec, conv.conversion);
+                    PRINT_CONVERSION((long long)value);
+                }
+                break;
+            }
+            case PRINTF_ARG_UINT: {
+                uint64_t value;
+                if (!unpack(&pos, end, &value, sizeof(uint64_t)))
+                    return false;
+                snprintf(spec, sizeof(spec), "%sll%c", conv.spec, conv.conversion);
+                PRINT_CONVERSION((unsigned long long)value);
+                break;
+            }
+            case PRINTF_ARG_DOUBLE: {
+                double value;
+                if (!unpack(&pos, end, &value, sizeof(double)))
+                    return false;
+                snprintf(spec, sizeof(spec), "%s%c", conv.spec, conv.conversion);
+                PRINT_CONVERSION(value);
+                break;
+            }
+            case PRINTF_ARG_LONG_DOUBLE: {
+                long double value;
+                if (!unpack(&pos, end, &value, sizeof(long double)))
+                    return false;
+                snprintf(spec, sizeof(spec), "%sL%c", conv.spec, conv.conversion);
+                PRINT_CONVERSION(value);
+                break;
+            }
+            case PRINTF_ARG_POINTER: {
+                uint64_t value;
+                if (!unpack(&pos, end, &value, sizeof(uint64_t)))
+                    return false;
+                snprintf(spec, sizeof(spec), "%sp", conv.spec);
+                PRINT_CONVERSION((void *)(uintptr_t)value);
+                break;
+            }
+            case PRINTF_ARG_STRING: {
+                const size_t len = strnlen(pos, end - pos);
+                if (len == (size_t)(end - pos))
+                    return false;
+                snprintf(spec, sizeof(spec), "%ss", conv.spec);
+                PRINT_CONVERSION(pos);
+                pos += len + 1;
+                break;
+            }
+            case PRINTF_ARG_UNSUPPORTED:
+                return false;
+        }
+#undef PRINT_CONVERSION
+    }
+    fputs(walk, stdout);
+    return true;
+}
+
+/*
+ * Prints the log contents between walk and end.
+ *
+ */
+static void print_range(const char *end) {
+    if (header->format != SHMLOG_FORMAT_BINARY) {
+        swrite(STDOUT_FILENO, walk, end - walk);
+        walk = (char *)end;
+        return;
+    }
+
+    while ((size_t)(end - walk) >= sizeof(i3_shmlog_record)) {
+        const i3_shmlog_record *record = (const i3_shmlog_record *)walk;
+        if (record->size < sizeof(i3_shmlog_record) || record->size > (size_t)(end - walk))
+            break;
+        if (!print_record(record))
+            fprintf(stderr, "i3-dump-log: skipping malformed record at offset %zd\n", walk - logbuffer);
+        walk += record->size;
+    }
+    walk = (char *)end;
+    fflush(stdout);
+}
+
 static int check_for_wrap(void) {
     if (wrap_count == header->wrap_count)
         return 0;
@@ -70,17 +222,14 @@ static int check_for_wrap(void) {
     /* The log wrapped. Print the remaining content and reset walk to the top
      * of the log. */
     wrap_count = header->wrap_count;
-    const int len = (logbuffer + header->offset_last_wrap) - walk;
-    swrite(STDOUT_FILENO, walk, len);
+    print_range(logbuffer + header->offset_last_wrap);
     walk = logbuffer + sizeof(i3_shmlog_header);
     return 1;
 }
 
 static void print_till_end(void) {
     check_for_wrap();
-    const int len = (logbuffer + header->offset_next_write) - walk;
-    swrite(STDOUT_FILENO, walk, len);
-    walk += len;
+    print_range(logbuffer + header->offset_next_write);
 }
 
 void errorlog(char *fmt, ...) {
@@ -215,7 +364,10 @@ int main(int argc, char *argv[]) {
     /* We first need to print old content in case there was at least one
      * wrapping already. */
 
-    if (*walk != '\0') {
+    if (header->format == SHMLOG_FORMAT_BINARY) {
+        /* i3 keeps track of the oldest record which is still intact. */
+        walk = logbuffer + header->offset_oldest;
+    } else if (*walk != '\0') {
         /* In case there was a write to the buffer already, skip the first
          * old line, it very likely is mangled. Not a problem, though, the log
          * is chatty enough to have plenty lines left. */
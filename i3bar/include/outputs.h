@@ -67,6 +67,9 @@ struct i3_output {
     int statusline_width;
     /* Whether statusline block short texts where used on last statusline render. */
     bool statusline_short_text;
+    /* Hash of everything rendered to buffer on the last draw, 0 if buffer
+     * has to be redrawn. */
+    uint64_t content_hash;
     /* The actual window on which we draw. */
     surface_t bar;
 
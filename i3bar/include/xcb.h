@@ -132,6 +132,21 @@ void reconfig_windows(bool redraw_bars);
  */
 void draw_bars(bool force_unhide);
 
+/*
+ * Schedules a call of draw_bars() right before the event loop blocks the next
+ * time, so that any number of updates handled in one loop iteration result in
+ * a single repaint. The bars are unhidden if any of the calls asked for it.
+ *
+ */
+void schedule_draw_bars(bool unhide);
+
+/*
+ * Marks the statusline as changed, so that its width is predicted again and
+ * it is redrawn on all outputs on the next draw_bars().
+ *
+ */
+void invalidate_statusline(void);
+
 /*
  * Redraw the bars, i.e. simply copy the buffer to the barwindow
  *
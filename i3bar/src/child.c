@@ -100,7 +100,7 @@ static void copy_statusline(struct statusline_head *from, struct statusline_head
 /*
  * Replaces the statusline in memory with an error message. Pass a format
  * string and format parameters as you would in `printf'. The next time
- * `draw_bars' is called, the error message text will be drawn on the bar in
+ * `draw_bars' runs, the error message text will be drawn on the bar in
  * the space allocated for the statusline.
  */
 __attribute__((format(printf, 1, 2))) static void set_statusline_error(const char *format, ...) {
@@ -131,6 +131,7 @@ __attribute__((format(printf, 1, 2))) static void set_statusline_error(const cha
 finish:
     FREE(message);
     va_end(args);
+    invalidate_statusline();
 }
 
 /*
@@ -327,6 +328,7 @@ static int stdin_end_array(void *context) {
     DLOG("copying statusline_buffer to statusline_head\n");
     clear_statusline(&statusline_head, true);
     copy_statusline(&statusline_buffer, &statusline_head);
+    invalidate_statusline();
 
     DLOG("dumping statusline:\n");
     struct status_block *current;
@@ -397,6 +399,7 @@ static void read_flat_input(char *buffer, int length) {
     }
 
     first->full_text = i3string_from_utf8(buffer);
+    invalidate_statusline();
 }
 
 static bool read_json_input(unsigned char *input, int length) {
@@ -414,7 +417,7 @@ static bool read_json_input(unsigned char *input, int length) {
 
         set_statusline_error("Could not parse JSON (%s)", message);
         yajl_free_error(parser, (unsigned char *)message);
-        draw_bars(false);
+        schedule_draw_bars(false);
     } else if (parser_context.has_urgent) {
         has_urgent = true;
     }
@@ -438,7 +441,7 @@ static void stdin_io_cb(struct ev_loop *loop, ev_io *watcher, int revents) {
         read_flat_input((char *)buffer, rec);
     }
     free(buffer);
-    draw_bars(has_urgent);
+    schedule_draw_bars(has_urgent);
 }
 
 /*
@@ -463,13 +466,14 @@ static void stdin_io_first_line_cb(struct ev_loop *loop, ev_io *watcher, int rev
         if (config.hide_on_modifier) {
             stop_child();
         }
-        draw_bars(read_json_input(buffer + consumed, rec - consumed));
+        schedule_draw_bars(read_json_input(buffer + consumed, rec - consumed));
     } else {
         /* In case of plaintext, we just add a single block and change its
          * full_text pointer later. */
         struct status_block *new_block = scalloc(1, sizeof(struct status_block));
         TAILQ_INSERT_TAIL(&statusline_head, new_block, blocks);
         read_flat_input((char *)buffer, rec);
+        schedule_draw_bars(false);
     }
     free(buffer);
     ev_io_stop(main_loop, stdin_io);
@@ -500,7 +504,7 @@ static void child_sig_cb(struct ev_loop *loop, ev_child *watcher, int revents) {
         set_statusline_error("status_command process exited unexpectedly (exit %d)", exit_status);
 
     cleanup();
-    draw_bars(false);
+    schedule_draw_bars(false);
 }
 
 static void child_write_output(void) {
@@ -521,7 +525,7 @@ static void child_write_output(void) {
             child.click_events = false;
             kill_child();
             set_statusline_error("child_write_output failed");
-            draw_bars(false);
+            schedule_draw_bars(false);
         }
     }
 }
@@ -29,6 +29,11 @@ const char *sock_path;
 
 typedef void (*handler_t)(char *);
 
+/* Set by the event handlers, so that a burst of events only leads to one
+ * request for the outputs and workspaces (see got_data()). */
+static bool outputs_needed = false;
+static bool workspaces_needed = false;
+
 /*
  * Called, when we get a reply to a command from i3.
  * Since i3 does not give us much feedback on commands, we do not much
@@ -45,7 +50,7 @@ static void got_command_reply(char *reply) {
 static void got_workspace_reply(char *reply) {
     DLOG("Got workspace data!\n");
     parse_workspaces_json(reply);
-    draw_bars(false);
+    schedule_draw_bars(false);
 }
 
 /*
@@ -80,7 +85,7 @@ static void got_output_reply(char *reply) {
         i3_send_msg(I3_IPC_MESSAGE_TYPE_GET_WORKSPACES, NULL);
     }
 
-    draw_bars(false);
+    schedule_draw_bars(false);
 }
 
 /*
@@ -134,7 +139,7 @@ handler_t reply_handlers[] = {
  */
 static void got_workspace_event(char *event) {
     DLOG("Got workspace event!\n");
-    i3_send_msg(I3_IPC_MESSAGE_TYPE_GET_WORKSPACES, NULL);
+    workspaces_needed = true;
 }
 
 /*
@@ -143,9 +148,9 @@ static void got_workspace_event(char *event) {
  */
 static void got_output_event(char *event) {
     DLOG("Got output event!\n");
-    i3_send_msg(I3_IPC_MESSAGE_TYPE_GET_OUTPUTS, NULL);
+    outputs_needed = true;
     if (!config.disable_ws) {
-        i3_send_msg(I3_IPC_MESSAGE_TYPE_GET_WORKSPACES, NULL);
+        workspaces_needed = true;
     }
 }
 
@@ -156,7 +161,7 @@ static void got_output_event(char *event) {
 static void got_mode_event(char *event) {
     DLOG("Got mode event!\n");
     parse_mode_json(event);
-    draw_bars(false);
+    schedule_draw_bars(false);
 }
 
 /*
@@ -197,7 +202,7 @@ static void got_bar_config_update(char *event) {
     }
     free(old_command);
 
-    draw_bars(false);
+    schedule_draw_bars(false);
 }
 
 /* Data structure to easily call the event handlers later */
@@ -209,85 +214,123 @@ handler_t event_handlers[] = {
     &got_bar_config_update,
 };
 
+/* The data received from i3 which has not been dispatched yet. The buffer is
+ * reused for all messages and only grows when a message does not fit. */
+static char *ipc_buffer;
+static size_t ipc_buffer_len;
+static size_t ipc_buffer_size;
+
+/*
+ * Calls the handler for the given message from i3. The payload must be
+ * terminated by a 0-byte.
+ *
+ */
+static void dispatch_message(uint32_t type, char *payload) {
+    if (type & (1UL << 31)) {
+        type ^= 1UL << 31;
+        event_handlers[type](payload);
+    } else {
+        if (reply_handlers[type])
+            reply_handlers[type](payload);
+    }
+}
+
 /*
- * Called, when we get a message from i3
+ * Called, when we get data from i3. Reads everything that is available
+ * without blocking, dispatches all complete messages in the order in which
+ * they were received and keeps incomplete messages for the next call. The
+ * outputs and workspaces are requested at most once after all messages were
+ * handled, redraws are coalesced by schedule_draw_bars().
  *
  */
 static void got_data(struct ev_loop *loop, ev_io *watcher, int events) {
     DLOG("Got data!\n");
-    int fd = watcher->fd;
-
-    /* First we only read the header, because we know its length */
-    uint32_t header_len = strlen(I3_IPC_MAGIC) + sizeof(uint32_t) * 2;
-    char *header = smalloc(header_len);
-
-    /* We first parse the fixed-length IPC header, to know, how much data
-     * we have to expect */
-    uint32_t rec = 0;
-    while (rec < header_len) {
-        int n = read(fd, header + rec, header_len - rec);
+    const int fd = watcher->fd;
+    const size_t header_len = strlen(I3_IPC_MAGIC) + sizeof(uint32_t) * 2;
+    bool eof = false;
+
+    while (true) {
+        /* Keep one byte free to 0-terminate the payload of the last message
+         * in place. */
+        if (ipc_buffer_size - ipc_buffer_len < 4096) {
+            ipc_buffer_size = (ipc_buffer_size == 0 ? 65536 : ipc_buffer_size * 2);
+            ipc_buffer = srealloc(ipc_buffer, ipc_buffer_size);
+        }
+        const size_t available = ipc_buffer_size - ipc_buffer_len - 1;
+        const ssize_t n = recv(fd, ipc_buffer + ipc_buffer_len, available, MSG_DONTWAIT);
         if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
             ELOG("read() failed: %s\n", strerror(errno));
             exit(EXIT_FAILURE);
         }
         if (n == 0) {
-            /* EOF received. Since i3 will restart i3bar instances as appropriate,
-             * we exit here. */
-            DLOG("EOF received, exiting...\n");
-#ifdef I3_ASAN_ENABLED
-            __lsan_do_leak_check();
-#endif
-            clean_xcb();
-            exit(EXIT_SUCCESS);
+            eof = true;
+            break;
         }
-        rec += n;
+        ipc_buffer_len += n;
+        if ((size_t)n < available)
+            break;
     }
 
-    if (strncmp(header, I3_IPC_MAGIC, strlen(I3_IPC_MAGIC))) {
-        ELOG("Wrong magic code: %.*s\n Expected: %s\n",
-             (int)strlen(I3_IPC_MAGIC),
-             header,
-             I3_IPC_MAGIC);
-        exit(EXIT_FAILURE);
-    }
+    size_t consumed = 0;
+    while (ipc_buffer_len - consumed >= header_len) {
+        char *walk = ipc_buffer + consumed;
+        if (strncmp(walk, I3_IPC_MAGIC, strlen(I3_IPC_MAGIC))) {
+            ELOG("Wrong magic code: %.*s\n Expected: %s\n",
+                 (int)strlen(I3_IPC_MAGIC),
+                 walk,
+                 I3_IPC_MAGIC);
+            exit(EXIT_FAILURE);
+        }
 
-    char *walk = header + strlen(I3_IPC_MAGIC);
-    uint32_t size;
-    memcpy(&size, (uint32_t *)walk, sizeof(uint32_t));
-    walk += sizeof(uint32_t);
-    uint32_t type;
-    memcpy(&type, (uint32_t *)walk, sizeof(uint32_t));
+        uint32_t size, type;
+        memcpy(&size, walk + strlen(I3_IPC_MAGIC), sizeof(uint32_t));
+        memcpy(&type, walk + strlen(I3_IPC_MAGIC) + sizeof(uint32_t), sizeof(uint32_t));
+        if (ipc_buffer_len - consumed - header_len < size)
+            break;
+
+        /* Temporarily terminate the payload, overwriting the first byte of
+         * the next message (or the free space at the end of the buffer). */
+        char *payload = walk + header_len;
+        const char next = payload[size];
+        payload[size] = '\0';
+        dispatch_message(type, payload);
+        payload[size] = next;
+
+        consumed += header_len + size;
+    }
 
-    /* Now that we know, what to expect, we can start read()ing the rest
-     * of the message */
-    char *buffer = smalloc(size + 1);
-    rec = 0;
+    if (consumed > 0) {
+        memmove(ipc_buffer, ipc_buffer + consumed, ipc_buffer_len - consumed);
+        ipc_buffer_len -= consumed;
+    }
 
-    while (rec < size) {
-        int n = read(fd, buffer + rec, size - rec);
-        if (n == -1) {
-            ELOG("read() failed: %s\n", strerror(errno));
-            exit(EXIT_FAILURE);
-        }
-        if (n == 0) {
-            ELOG("Nothing to read!\n");
+    if (eof) {
+        if (ipc_buffer_len > 0) {
+            ELOG("Connection to i3 closed in the middle of a message!\n");
             exit(EXIT_FAILURE);
         }
-        rec += n;
+        /* EOF received. Since i3 will restart i3bar instances as appropriate,
+         * we exit here. */
+        DLOG("EOF received, exiting...\n");
+#ifdef I3_ASAN_ENABLED
+        __lsan_do_leak_check();
+#endif
+        clean_xcb();
+        exit(EXIT_SUCCESS);
     }
-    buffer[size] = '\0';
 
-    /* And call the callback (indexed by the type) */
-    if (type & (1UL << 31)) {
-        type ^= 1UL << 31;
-        event_handlers[type](buffer);
-    } else {
-        if (reply_handlers[type])
-            reply_handlers[type](buffer);
+    if (outputs_needed) {
+        outputs_needed = false;
+        i3_send_msg(I3_IPC_MESSAGE_TYPE_GET_OUTPUTS, NULL);
+    }
+    if (workspaces_needed) {
+        workspaces_needed = false;
+        i3_send_msg(I3_IPC_MESSAGE_TYPE_GET_WORKSPACES, NULL);
     }
-
-    FREE(header);
-    FREE(buffer);
 }
 
 /*
@@ -95,6 +95,21 @@ bool activated_mode = false;
 /* The output in which the tray should be displayed. */
 static i3_output *output_for_tray;
 
+/* Set by schedule_draw_bars(), draw_bars() is called from xcb_prep_cb(). */
+static bool draw_scheduled = false;
+static bool draw_scheduled_unhide = false;
+
+/* The predicted statusline widths are only recomputed after the statusline
+ * changed, see invalidate_statusline(). */
+static bool statusline_dirty = true;
+static uint32_t full_statusline_width;
+static uint32_t short_statusline_width;
+
+/* Bumped when the statusline or the font and colors change. Both are part of
+ * the content hash of every output. */
+static uint32_t statusline_generation = 0;
+static uint32_t config_generation = 0;
+
 /* The parsed colors */
 struct xcb_colors_t {
     color_t bar_fg;
@@ -440,6 +455,7 @@ void init_colors(const struct xcb_color_strings_t *new_colors) {
 #undef PARSE_COLOR_FALLBACK
 
     init_tray_colors();
+    config_generation++;
     xcb_flush(xcb_connection);
 }
 
@@ -862,7 +878,7 @@ static void handle_client_message(xcb_client_message_event_t *event) {
             /* Trigger an update to copy the statusline text to the appropriate
              * position */
             configure_trayclients();
-            draw_bars(false);
+            schedule_draw_bars(false);
         }
     }
 }
@@ -896,7 +912,7 @@ static void handle_destroy_notify(xcb_destroy_notify_event_t *event) {
 
             /* Trigger an update, we now have more space for the statusline */
             configure_trayclients();
-            draw_bars(false);
+            schedule_draw_bars(false);
             return;
         }
     }
@@ -925,7 +941,7 @@ static void handle_map_notify(xcb_map_notify_event_t *event) {
 
             /* Trigger an update, we now have more space for the statusline */
             configure_trayclients();
-            draw_bars(false);
+            schedule_draw_bars(false);
             return;
         }
     }
@@ -953,7 +969,7 @@ static void handle_unmap_notify(xcb_unmap_notify_event_t *event) {
 
             /* Trigger an update, we now have more space for the statusline */
             configure_trayclients();
-            draw_bars(false);
+            schedule_draw_bars(false);
             return;
         }
     }
@@ -1167,6 +1183,15 @@ static void xcb_prep_cb(struct ev_loop *loop, ev_prepare *watcher, int revents)
         free(event);
     }
 
+    /* Everything handled in this loop iteration has been processed by now, so
+     * this is the one place where scheduled redraws happen. */
+    if (draw_scheduled) {
+        bool unhide = draw_scheduled_unhide;
+        draw_scheduled = false;
+        draw_scheduled_unhide = false;
+        draw_bars(unhide);
+    }
+
     xcb_flush(xcb_connection);
 }
 
@@ -1322,6 +1347,11 @@ void init_xcb_late(char *fontname) {
     if (config.separator_symbol)
         separator_symbol_width = predict_text_width(config.separator_symbol);
 
+    /* Text widths depend on the font, and the rest of the config might have
+     * changed as well. */
+    invalidate_statusline();
+    config_generation++;
+
     xcb_flush(xcb_connection);
 
     if (config.hide_on_modifier == M_HIDE)
@@ -1793,6 +1823,7 @@ void reconfig_windows(bool redraw_bars) {
             draw_util_surface_init(xcb_connection, &walk->bar, bar_id, NULL, walk->rect.w, bar_height);
             draw_util_surface_init(xcb_connection, &walk->buffer, buffer_id, NULL, walk->rect.w, bar_height);
             draw_util_surface_init(xcb_connection, &walk->statusline_buffer, statusline_buffer_id, NULL, walk->rect.w, bar_height);
+            walk->content_hash = 0;
 
             xcb_void_cookie_t strut_cookie = config_strut_partial(walk);
 
@@ -1874,6 +1905,7 @@ void reconfig_windows(bool redraw_bars) {
             draw_util_surface_init(xcb_connection, &(walk->bar), walk->bar.id, NULL, walk->rect.w, bar_height);
             draw_util_surface_init(xcb_connection, &(walk->buffer), walk->buffer.id, NULL, walk->rect.w, bar_height);
             draw_util_surface_init(xcb_connection, &(walk->statusline_buffer), walk->statusline_buffer.id, NULL, walk->rect.w, bar_height);
+            walk->content_hash = 0;
 
             xcb_void_cookie_t map_cookie, umap_cookie;
             if (redraw_bars) {
@@ -1921,6 +1953,77 @@ void reconfig_windows(bool redraw_bars) {
     }
 }
 
+#define HASH_VALUE(hash, value) (hash) = fnv1a_64((hash), &(value), sizeof(value))
+
+static uint64_t hash_i3string(uint64_t hash, i3String *str) {
+    size_t num_bytes = i3string_get_num_bytes(str);
+    HASH_VALUE(hash, num_bytes);
+    return fnv1a_64(hash, i3string_as_utf8(str), num_bytes);
+}
+
+/*
+ * Hashes everything draw_bars() renders to the buffer of the given output,
+ * so that outputs whose content did not change can be skipped. Sets *urgent
+ * if one of the workspace buttons on the output is urgent.
+ *
+ */
+static uint64_t output_content_hash(i3_output *output, bool use_focus_colors, bool *urgent) {
+    uint64_t hash = FNV1A_64_OFFSET_BASIS;
+    HASH_VALUE(hash, config_generation);
+    HASH_VALUE(hash, statusline_generation);
+    HASH_VALUE(hash, use_focus_colors);
+    HASH_VALUE(hash, output->rect.w);
+    HASH_VALUE(hash, bar_height);
+
+    int tray_width = get_tray_width(output->trayclients);
+    HASH_VALUE(hash, tray_width);
+
+    if (!config.disable_ws) {
+        i3_ws *ws_walk;
+        TAILQ_FOREACH(ws_walk, output->workspaces, tailq) {
+            hash = hash_i3string(hash, ws_walk->name);
+            HASH_VALUE(hash, ws_walk->name_width);
+            HASH_VALUE(hash, ws_walk->visible);
+            HASH_VALUE(hash, ws_walk->focused);
+            HASH_VALUE(hash, ws_walk->urgent);
+            if (ws_walk->urgent) {
+                *urgent = true;
+            }
+        }
+    }
+
+    if (binding.name && !config.disable_binding_mode_indicator) {
+        hash = hash_i3string(hash, binding.name);
+        HASH_VALUE(hash, binding.width);
+    }
+
+    /* 0 is reserved for buffers which have to be redrawn. */
+    return (hash == 0 ? 1 : hash);
+}
+
+#undef HASH_VALUE
+
+/*
+ * Schedules a call of draw_bars() right before the event loop blocks the next
+ * time, so that any number of updates handled in one loop iteration result in
+ * a single repaint. The bars are unhidden if any of the calls asked for it.
+ *
+ */
+void schedule_draw_bars(bool unhide) {
+    draw_scheduled = true;
+    draw_scheduled_unhide |= unhide;
+}
+
+/*
+ * Marks the statusline as changed, so that its width is predicted again and
+ * it is redrawn on all outputs on the next draw_bars().
+ *
+ */
+void invalidate_statusline(void) {
+    statusline_dirty = true;
+    statusline_generation++;
+}
+
 /*
  * Render the bars, with buttons and statusline
  *
@@ -1928,9 +2031,13 @@ void reconfig_windows(bool redraw_bars) {
 void draw_bars(bool unhide) {
     DLOG("Drawing bars...\n");
 
-    uint32_t full_statusline_width = predict_statusline_length(false);
-    uint32_t short_statusline_width = predict_statusline_length(true);
+    if (statusline_dirty) {
+        full_statusline_width = predict_statusline_length(false);
+        short_statusline_width = predict_statusline_length(true);
+        statusline_dirty = false;
+    }
 
+    bool drawn = false;
     i3_output *outputs_walk;
     SLIST_FOREACH(outputs_walk, outputs, slist) {
         int workspace_width = 0;
@@ -1945,6 +2052,17 @@ void draw_bars(bool unhide) {
         }
 
         bool use_focus_colors = output_has_focus(outputs_walk);
+        bool has_urgent = false;
+        uint64_t content_hash = output_content_hash(outputs_walk, use_focus_colors, &has_urgent);
+        if (has_urgent || (binding.name && !config.disable_binding_mode_indicator)) {
+            unhide = true;
+        }
+
+        if (content_hash == outputs_walk->content_hash) {
+            DLOG("Output %s unchanged, skipping...\n", outputs_walk->name);
+            continue;
+        }
+        outputs_walk->content_hash = content_hash;
 
         /* First things first: clear the backbuffer */
         draw_util_clear_surface(&(outputs_walk->buffer), (use_focus_colors ? colors.focus_bar_bg : colors.bar_bg));
@@ -1973,7 +2091,6 @@ void draw_bars(bool unhide) {
                     fg_color = colors.urgent_ws_fg;
                     bg_color = colors.urgent_ws_bg;
                     border_color = colors.urgent_ws_border;
-                    unhide = true;
                 }
 
                 /* Draw the border of the button. */
@@ -2024,7 +2141,6 @@ void draw_bars(bool unhide) {
                            bar_height / 2 - font.height / 2,
                            binding.width);
 
-            unhide = true;
             workspace_width += 2 * logical_px(ws_hoff_px) + 2 * logical_px(1) + binding.width;
         }
 
@@ -2056,6 +2172,10 @@ void draw_bars(bool unhide) {
             outputs_walk->statusline_width = statusline_width;
             outputs_walk->statusline_short_text = use_short_text;
         }
+
+        draw_util_copy_surface(&(outputs_walk->buffer), &(outputs_walk->bar), 0, 0,
+                               0, 0, outputs_walk->rect.w, outputs_walk->rect.h);
+        drawn = true;
     }
 
     /* Assure the bar is hidden/unhidden according to the specified hidden_state and mode */
@@ -2067,7 +2187,9 @@ void draw_bars(bool unhide) {
         hide_bars();
     }
 
-    redraw_bars();
+    if (drawn) {
+        xcb_flush(xcb_connection);
+    }
 }
 
 /*
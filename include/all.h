@@ -41,6 +41,8 @@
 #include <yajl/yajl_version.h>
 
 #include "data.h"
+#include "xid_map.h"
+#include "snapshot.h"
 #include "util.h"
 #include "ipc.h"
 #include "tree.h"
@@ -23,3 +23,13 @@ void run_assignments(i3Window *window);
  *
  */
 Assignment *assignment_for(i3Window *window, int type);
+
+/**
+ * To be called after the assignments were reloaded, while the previous
+ * assignments have not been freed yet: Makes every window remember the
+ * identical new assignment instead of a previous assignment it already ran,
+ * so that unchanged assignments are not run again. Previous assignments
+ * without an identical new one are forgotten.
+ *
+ */
+void assignments_reloaded(void);
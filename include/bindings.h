@@ -36,6 +36,15 @@ Binding *configure_binding(const char *bindtype, const char *modifiers, const ch
  */
 void grab_all_keys(xcb_connection_t *conn);
 
+/**
+ * Grabs the keys needed for the bindings of the current mode like
+ * grab_all_keys(), but only ungrabs and grabs the keys which changed since the
+ * last call to grab_all_keys() or update_key_grabs() instead of starting from
+ * scratch. Used when reloading the configuration.
+ *
+ */
+void update_key_grabs(xcb_connection_t *conn);
+
 /**
  * Release the button grabs on all managed windows and regrab them,
  * reevaluating which buttons need to be grabbed.
@@ -30,6 +30,13 @@ void cmd_criteria_init(I3_CMD);
  */
 void cmd_criteria_match_windows(I3_CMD);
 
+/**
+ * Restricts the criteria to the given container, just like [con_id=…] would,
+ * but without formatting and parsing the criteria.
+ *
+ */
+void cmd_criteria_set_con(I3_CMD, Con *con);
+
 /**
  * Interprets a ctype=cvalue pair and adds it to the current match
  * specification.
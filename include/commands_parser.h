@@ -63,6 +63,32 @@ char *parse_string(const char **walk, bool as_word);
  */
 CommandResult *parse_command(const char *input, yajl_gen gen);
 
+/**
+ * Starts a batch of commands. Commands which are run with command_batch_run()
+ * do not render the tree themselves; instead, the outermost
+ * command_batch_end() reports whether any of them needs a tree_render().
+ * Batches can be nested.
+ *
+ */
+void command_batch_begin(void);
+
+/**
+ * Parses and executes the given command as part of the current batch, just
+ * like parse_command(). If con is not NULL, the first command (up to the
+ * first semicolon) operates on con, as if it was prefixed with [con_id=…]
+ * criteria.
+ *
+ * Free the returned CommandResult with command_result_free().
+ */
+CommandResult *command_batch_run(const char *input, yajl_gen gen, Con *con);
+
+/**
+ * Ends a batch of commands. Returns true if this was the outermost batch and
+ * any of its commands needs a tree_render(), which the caller has to do.
+ *
+ */
+bool command_batch_end(void);
+
 /**
  * Frees a CommandResult
  */
@@ -32,6 +32,13 @@ Con *con_new(Con *parent, i3Window *window);
  */
 void con_free(Con *con);
 
+/**
+ * Marks the given container and all of its parents as dirty, meaning that the
+ * next tree_render() cannot skip the workspace containing it.
+ *
+ */
+void con_mark_dirty(Con *con);
+
 /**
  * Sets input focus to the given container. Will be updated in X11 in the next
  * run of x_push_changes().
@@ -166,6 +173,42 @@ bool con_inside_focused(Con *con);
  */
 bool con_has_parent(Con *con, Con *parent);
 
+/**
+ * Adds the container to the index used by con_by_window_id(). Has to be called
+ * whenever con->window is set to a new window.
+ *
+ */
+void con_index_window(Con *con);
+
+/**
+ * Removes the container from the index used by con_by_window_id(). Has to be
+ * called before con->window is freed or moved to another container.
+ *
+ */
+void con_unindex_window(Con *con);
+
+/**
+ * Adds the container to the index used by con_by_frame_id(). Called from
+ * x_con_init() once the frame has been created.
+ *
+ */
+void con_index_frame(Con *con);
+
+/**
+ * Removes the container from the index used by con_by_frame_id(). Called from
+ * x_con_kill() and x_con_reframe().
+ *
+ */
+void con_unindex_frame(Con *con);
+
+/**
+ * Verifies that the window and frame indexes match the containers in
+ * all_cons. Returns false (and logs the differences) if they do not. This is
+ * expensive and only meant to be used in debug builds.
+ *
+ */
+bool con_index_check(void);
+
 /**
  * Returns the container with the given client window ID or NULL if no such
  * container exists.
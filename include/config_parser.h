@@ -16,6 +16,23 @@
 SLIST_HEAD(variables_head, Variable);
 extern pid_t config_error_nagbar_pid;
 
+/**
+ * Counters about the config cache (see --config-cache), reported by the
+ * GET_STATS IPC message.
+ *
+ */
+struct config_cache_stats {
+    /** Number of configs which were replayed from the cache. */
+    uint64_t hits;
+    /** Number of configs which had to be parsed although the cache is
+     * enabled. */
+    uint64_t misses;
+    /** Number of configs which were stored in the cache. */
+    uint64_t stores;
+};
+
+extern struct config_cache_stats config_cache_stats;
+
 /**
  * An intermediate reprsentation of the result of a parse_config call.
  * Currently unused, but the JSON output will be useful in the future when we
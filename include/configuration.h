@@ -67,7 +67,6 @@ struct Colortriple {
 struct Variable {
     char *key;
     char *value;
-    char *next_match;
 
     SLIST_ENTRY(Variable)
     variables;
@@ -430,7 +429,8 @@ typedef enum {
  * load_type specifies the type of loading: C_VALIDATE is used to only verify
  * the correctness of the config file (used with the flag -C). C_LOAD will load
  * the config for normal use and display errors in the nagbar. C_RELOAD will
- * also clear the previous config.
+ * also clear the previous config and only apply what changed compared to it
+ * (key grabs, button grabs, assignments, decorations and bar configs).
  */
 bool load_configuration(const char *override_configfile, config_load_t load_type);
 
@@ -234,10 +234,16 @@ struct Workspace_Assignment {
 struct Ignore_Event {
     int sequence;
     int response_type;
-    time_t added;
+    /* Event loop time (ev_now()) at which the event was added. */
+    double added;
 
-    SLIST_ENTRY(Ignore_Event)
+    /* Entry in the hash bucket of the sequence number. */
+    LIST_ENTRY(Ignore_Event)
     ignore_events;
+
+    /* Entry in the list of all ignored events, oldest first. */
+    TAILQ_ENTRY(Ignore_Event)
+    expiry;
 };
 
 /**
@@ -269,10 +275,22 @@ struct Startup_Sequence {
  * non-matching pattern.
  *
  */
+#define REGEX_CACHE_SIZE 8
+
 struct regex {
     char *pattern;
     pcre *regex;
     pcre_extra *extra;
+    /** If the pattern is an anchored literal (like ^Firefox$), the literal
+     * without the anchors, otherwise NULL. Such patterns are matched using
+     * strcmp() and allow looking up the matching container directly. */
+    char *exact;
+    /** Results of regex_matches_cached(), indexed by a hash of the key. */
+    struct regex_cache_entry {
+        const void *key;
+        uint64_t generation;
+        bool result;
+    } cache[REGEX_CACHE_SIZE];
 };
 
 /**
@@ -417,6 +435,9 @@ struct xoutput {
     /** x, y, width, height */
     Rect rect;
 
+    /** Refresh rate of the current mode in millihertz, or 0 if unknown. */
+    uint32_t refresh_rate;
+
     TAILQ_ENTRY(xoutput)
     outputs;
 };
@@ -442,6 +463,13 @@ struct Window {
     char *class_class;
     char *class_instance;
 
+    /** Generations of WM_CLASS, the name and WM_WINDOW_ROLE. Each time one
+     * of them changes, it gets a new value from a global counter, so that
+     * cached criteria results for the old value are not used anymore. */
+    uint64_t class_generation;
+    uint64_t name_generation;
+    uint64_t role_generation;
+
     /** The name of the window. */
     i3String *name;
 
@@ -632,6 +660,14 @@ struct mark_t {
 struct Con {
     bool mapped;
 
+    /** Set when this container or one of its descendants changed since the
+     * last x_push_changes(), see con_mark_dirty(). Hidden workspaces which are
+     * not dirty are skipped entirely by tree_render(). */
+    bool dirty;
+    /** Set by tree_render() on hidden workspaces which were skipped because
+     * nothing changed in them. */
+    bool render_skipped;
+
     /* Should this container be marked urgent? This gets set when the window
      * inside this container (if any) sets the urgency hint, for example. */
     bool urgent;
@@ -664,6 +700,11 @@ struct Con {
     /** Only applicable for containers of type CT_WORKSPACE. */
     gaps_t gaps;
 
+    /** For workspaces: the EWMH desktop index (or NET_WM_DESKTOP_ALL for
+     * internal workspaces) for which _NET_WM_DESKTOP of the windows on this
+     * workspace was last updated by ewmh_update_wm_desktop(). */
+    uint32_t ewmh_desktop;
+
     struct Con *parent;
 
     /* The position and size for this con. These coordinates are absolute. Note
@@ -705,8 +746,14 @@ struct Con {
     /* timer used for disabling urgency */
     struct ev_timer *urgency_timer;
 
-    /** Cache for the decoration rendering */
-    struct deco_render_params *deco_render_params;
+    /** Cache for the decoration rendering. Only compared against when
+     * deco_render_params_valid is set; clear that flag to force a redraw. */
+    struct deco_render_params deco_render_params;
+    bool deco_render_params_valid;
+
+    /** Number of children whose decorations were last drawn onto this
+     * container’s pixmap (see x_deco_recurse()). */
+    int deco_children;
 
     /* Only workspace-containers can have floating clients */
     TAILQ_HEAD(floating_head, Con)
@@ -39,12 +39,24 @@ void ewmh_update_desktop_names(void);
 void ewmh_update_desktop_viewport(void);
 
 /**
- * Updates _NET_WM_DESKTOP for all windows.
+ * Updates _NET_WM_DESKTOP for all windows on workspaces whose EWMH desktop
+ * index changed (because workspaces were created, closed, renamed or moved)
+ * since the last call. Windows which move between workspaces have to be
+ * updated using ewmh_update_wm_desktop_con().
  * A request will only be made if the cached value differs from the calculated value.
  *
  */
 void ewmh_update_wm_desktop(void);
 
+/**
+ * Updates _NET_WM_DESKTOP for all windows in the given container (including
+ * the container itself), e.g. after it was moved to a different workspace or
+ * its sticky state changed.
+ * A request will only be made if the cached value differs from the calculated value.
+ *
+ */
+void ewmh_update_wm_desktop_con(Con *con);
+
 /**
  * Updates _NET_ACTIVE_WINDOW with the currently focused window.
  *
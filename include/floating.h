@@ -136,6 +136,10 @@ typedef enum {
  * specified (client, border on which the click originally was), the original
  * rect of the client, the event and the new coordinates (x, y).
  *
+ * Pointer motion is coalesced to at most one callback per frame of the output
+ * on which the drag started (see Output.refresh_rate); the final position is
+ * always passed to the callback before the drag ends.
+ *
  */
 drag_result_t drag_pointer(Con *con, const xcb_button_press_event_t *event,
                            xcb_window_t confine_to, border_t border, int cursor,
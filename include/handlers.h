@@ -18,6 +18,19 @@ extern int randr_base;
 extern int xkb_base;
 extern int shape_base;
 
+/**
+ * Counters about the handling of X11 events, reported by the GET_STATS IPC
+ * message.
+ *
+ */
+struct event_stats {
+    /** Number of PropertyNotify events which were merged into an earlier one
+     * for the same window and property. */
+    uint64_t coalesced_property_notifies;
+};
+
+extern struct event_stats event_stats;
+
 /**
  * Adds the given sequence to the list of events which are ignored.
  * If this ignore should only affect a specific response_type, pass
@@ -34,6 +47,15 @@ void add_ignore_event(const int sequence, const int response_type);
  */
 bool event_is_ignored(const int sequence, const int response_type);
 
+/**
+ * Runs the handlers of all queued PropertyNotify events. All GetProperty
+ * requests are sent before waiting for the first reply, so that there is only
+ * a single round trip to the X server. Returns true if any handlers ran (they
+ * might have caused new events to be read from X11).
+ *
+ */
+bool flush_property_notifies(void);
+
 /**
  * Takes an xcb_generic_event_t and calls the appropriate handler, based on the
  * event type.
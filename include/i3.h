@@ -76,3 +76,4 @@ extern xcb_window_t root;
 extern struct ev_loop *main_loop;
 extern bool only_check_config;
 extern bool force_xinerama;
+extern bool use_config_cache;
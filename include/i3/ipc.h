@@ -66,6 +66,18 @@ typedef struct i3_ipc_header {
 /** Trigger an i3 sync protocol message via IPC. */
 #define I3_IPC_MESSAGE_TYPE_SYNC 11
 
+/** Request the list of IPC clients and their output queues. */
+#define I3_IPC_MESSAGE_TYPE_GET_CLIENTS 12
+
+/** Request the layout tree as a binary snapshot (see docs/ipc). */
+#define I3_IPC_MESSAGE_TYPE_GET_TREE_SNAPSHOT 13
+
+/** Run a JSON array of commands as a batch, rendering only once. */
+#define I3_IPC_MESSAGE_TYPE_RUN_COMMANDS 14
+
+/** Request internal counters (e.g. about criteria matching). */
+#define I3_IPC_MESSAGE_TYPE_GET_STATS 15
+
 /*
  * Messages from i3 to clients
  *
@@ -82,6 +94,10 @@ typedef struct i3_ipc_header {
 #define I3_IPC_REPLY_TYPE_CONFIG 9
 #define I3_IPC_REPLY_TYPE_TICK 10
 #define I3_IPC_REPLY_TYPE_SYNC 11
+#define I3_IPC_REPLY_TYPE_CLIENTS 12
+#define I3_IPC_REPLY_TYPE_TREE_SNAPSHOT 13
+#define I3_IPC_REPLY_TYPE_COMMANDS 14
+#define I3_IPC_REPLY_TYPE_STATS 15
 
 /*
  * Events from i3 to clients. Events have the first bit set high.
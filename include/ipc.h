@@ -19,27 +19,59 @@
 #include "data.h"
 #include "tree.h"
 #include "configuration.h"
+#include "snapshot.h"
 
 #include "i3/ipc.h"
 
 extern char *current_socketpath;
 
+/* Returns the bit which represents the given event type (one of the
+ * I3_IPC_EVENT_* constants) in ipc_client.events. */
+#define IPC_EVENT_BIT(message_type) (1U << ((message_type) & ~I3_IPC_EVENT_MASK))
+
+/*
+ * A serialized IPC message, consisting of the i3-ipc header followed by the
+ * payload. Events are serialized only once and the same ipc_message is queued
+ * for every subscribed client, hence the reference count.
+ *
+ */
+typedef struct ipc_message {
+    int refcount;
+    size_t size;
+    uint8_t data[];
+} ipc_message;
+
 typedef struct ipc_client {
     int fd;
 
-    /* The events which this client wants to receive */
-    int num_events;
-    char **events;
+    /* The events which this client wants to receive, as a bitmask of
+     * IPC_EVENT_BIT() values. */
+    uint32_t events;
 
     /* For clients which subscribe to the tick event: whether the first tick
      * event has been sent by i3. */
     bool first_tick_sent;
 
+    /* Set when the client exceeded ipc_max_pending. No more messages are
+     * queued for it and it is disconnected from the main loop, since it might
+     * still be used by the handler which is currently running. */
+    bool doomed;
+
     struct ev_io *read_callback;
     struct ev_io *write_callback;
     struct ev_timer *timeout;
-    uint8_t *buffer;
-    size_t buffer_size;
+
+    /* Messages which could not be written to the socket yet, stored in a ring
+     * buffer of pending_capacity entries, starting at index pending_first. */
+    ipc_message **pending;
+    uint32_t pending_capacity;
+    uint32_t pending_first;
+    uint32_t pending_count;
+    /* The number of bytes of the first pending message which were already
+     * written. */
+    size_t pending_offset;
+    /* The total number of bytes in the queue which still need to be written. */
+    size_t pending_bytes;
 
     TAILQ_ENTRY(ipc_client)
     clients;
@@ -79,12 +111,19 @@ void ipc_new_client(EV_P_ struct ev_io *w, int revents);
  */
 int ipc_create_socket(const char *filename);
 
+/**
+ * Returns true if at least one connected IPC client is subscribed to the
+ * given event type. Used to avoid serializing events nobody listens to.
+ *
+ */
+bool ipc_has_event_subscribers(uint32_t message_type);
+
 /**
  * Sends the specified event to all IPC clients which are currently connected
  * and subscribed to this kind of event.
  *
  */
-void ipc_send_event(const char *event, uint32_t message_type, const char *payload);
+void ipc_send_event(uint32_t message_type, const char *payload);
 
 /**
  * Calls to ipc_shutdown() should provide a reason for the shutdown.
@@ -102,6 +141,13 @@ void ipc_shutdown(shutdown_reason_t reason);
 
 void dump_node(yajl_gen gen, Con *con, bool inplace_restart);
 
+/**
+ * Like dump_node(), but writes a binary snapshot (see snapshot.h) instead of
+ * JSON.
+ *
+ */
+void dump_node_snapshot(snapshot_gen *gen, Con *con, bool inplace_restart);
+
 /**
  * Generates a json workspace event. Returns a dynamically allocated yajl
  * generator. Free with yajl_gen_free().
@@ -121,6 +167,14 @@ void ipc_send_workspace_event(const char *change, Con *current, Con *old);
  */
 void ipc_send_window_event(const char *property, Con *con);
 
+/**
+ * Returns the given bar configuration serialized as in the reply to
+ * GET_BAR_CONFIG and in barconfig_update events. The caller has to free the
+ * returned string.
+ *
+ */
+char *ipc_serialize_bar_config(Barconfig *barconfig);
+
 /**
  * For the barconfig update events, we send the serialized barconfig.
  */
@@ -136,3 +190,11 @@ void ipc_send_binding_event(const char *event_type, Binding *bind);
   * socket.
   */
 void ipc_set_kill_timeout(ev_tstamp new);
+
+/**
+ * Set the maximum number of bytes which may be queued for a client which does
+ * not read its events. Clients exceeding this limit are disconnected. 0 means
+ * no limit.
+ *
+ */
+void ipc_set_max_pending(size_t new);
@@ -14,6 +14,7 @@
 
 #include <stdbool.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <xcb/xcb.h>
 #include <xcb/xproto.h>
@@ -461,6 +462,13 @@ void draw_text_ascii(const char *text, xcb_drawable_t drawable,
  */
 int predict_text_width(i3String *text);
 
+/**
+ * Returns the number of hits and misses of the text layout cache which is
+ * used for Pango fonts.
+ *
+ */
+void get_text_cache_stats(uint64_t *hits, uint64_t *misses);
+
 /**
  * Returns the visual type associated with the given screen.
  *
@@ -536,6 +544,67 @@ char *get_config_path(const char *override_configpath, bool use_system_paths);
 int mkdirp(const char *path, mode_t mode);
 #endif
 
+/** The initial value of a 64-bit FNV-1a hash, see fnv1a_64(). */
+#define FNV1A_64_OFFSET_BASIS UINT64_C(14695981039346656037)
+
+/**
+ * Adds the given bytes to a 64-bit FNV-1a hash. Start with
+ * FNV1A_64_OFFSET_BASIS and pass the result of the previous call to hash
+ * several chunks of data.
+ *
+ */
+uint64_t fnv1a_64(uint64_t hash, const void *data, size_t len);
+
+/** The type of argument which a printf conversion consumes. */
+typedef enum {
+    /* %% */
+    PRINTF_ARG_NONE = 0,
+    /* d, i, c */
+    PRINTF_ARG_INT,
+    /* o, u, x, X */
+    PRINTF_ARG_UINT,
+    /* a, A, e, E, f, F, g, G */
+    PRINTF_ARG_DOUBLE,
+    /* The same, with the L length modifier */
+    PRINTF_ARG_LONG_DOUBLE,
+    /* s */
+    PRINTF_ARG_STRING,
+    /* p */
+    PRINTF_ARG_POINTER,
+    /* Anything else (%n, %m, wide characters, positional arguments, …) */
+    PRINTF_ARG_UNSUPPORTED,
+} printf_arg_t;
+
+/** A single printf conversion specification, see parse_printf_conversion(). */
+typedef struct printf_conversion {
+    printf_arg_t type;
+    /* The conversion character, e.g. 'd'. */
+    char conversion;
+    /* The length modifier: 'H' (hh), 'h', 'l', 'L' (ll or L), 'j', 'z', 't'
+     * or '\0' if there is none. */
+    char length;
+    /* Whether the width and/or the precision are given as '*' (and therefore
+     * consume an int argument each, width first). */
+    bool star_width;
+    bool star_precision;
+    /* The precision if it was given literally, -1 otherwise. */
+    int precision;
+    /* The specification without length modifier and conversion character,
+     * e.g. "%-8.3" for "%-8.3ld". */
+    char spec[32];
+} printf_conversion;
+
+/**
+ * Parses the printf conversion specification which fmt points to (fmt[0] has
+ * to be '%') into conv. Returns a pointer to the first character after the
+ * specification, or NULL if it is malformed.
+ *
+ * This is used to pack the arguments of log messages into the SHM log and to
+ * format them again in i3-dump-log.
+ *
+ */
+const char *parse_printf_conversion(const char *fmt, printf_conversion *conv);
+
 /** Helper structure for usage in format_placeholders(). */
 typedef struct placeholder_t {
     /* The placeholder to be replaced, e.g., "%title". */
@@ -40,3 +40,11 @@ json_content_t json_determine_content(const char *buf, const size_t len);
 bool json_validate(const char *buf, const size_t len);
 
 void tree_append_json(Con *con, const char *buf, const size_t len, char **errormsg);
+
+/**
+ * Like tree_append_json(), but for a binary snapshot as generated by
+ * dump_node_snapshot(). The snapshot is read in place, feeding the same
+ * callbacks which are used for JSON.
+ *
+ */
+void tree_append_snapshot(Con *con, const char *buf, const size_t len, char **errormsg);
@@ -34,6 +34,7 @@
 extern char *errorfilename;
 extern char *shmlogname;
 extern int shmlog_size;
+extern int shmlog_format;
 
 /**
  * Initializes logging by creating an error logfile in /tmp (or
@@ -97,6 +98,14 @@ void errorlog(char *fmt, ...)
 void verboselog(char *fmt, ...)
     __attribute__((format(printf, 1, 2)));
 
+/**
+ * Wakes up all processes (i3-dump-log -f) waiting for new messages in the SHM
+ * log, but only if something was logged since the last call. This is called
+ * once per event loop iteration instead of once per message.
+ *
+ */
+void flush_log_wakeups(void);
+
 /**
  * Deletes the unused log files. Useful if i3 exits immediately, eg.
  * because --get-socketpath was called. We don't care for syscall
@@ -31,9 +31,43 @@ void manage_existing_windows(xcb_window_t root);
 void restore_geometry(void);
 
 /**
- * Do some sanity checks and then reparent the window.
+ * Starts managing the given window: the window attributes (for which the
+ * caller already sent the request) and geometry are collected by
+ * manage_process_pending(), which will then decide whether to manage the
+ * window.
  *
  */
 void manage_window(xcb_window_t window,
                    xcb_get_window_attributes_cookie_t cookie,
                    bool needs_to_be_mapped);
+
+/**
+ * Handles all windows which are being managed and whose replies arrived.
+ * Called by the main loop before it waits for new events. Returns true if any
+ * reply was collected or any window advanced, since collecting replies might
+ * have read new events from X11 as well.
+ *
+ */
+bool manage_process_pending(void);
+
+/**
+ * Waits until all windows which are being managed are put into the tree.
+ * Used when events need to see the result, e.g. ClientMessages.
+ *
+ */
+void manage_finish_pending(void);
+
+/**
+ * Returns true if the given window is being managed but not yet part of the
+ * tree.
+ *
+ */
+bool manage_window_is_pending(xcb_window_t window);
+
+/**
+ * Stops managing the given window if it is not yet part of the tree, e.g.
+ * because it was unmapped or destroyed. Returns true if the window was being
+ * managed.
+ *
+ */
+bool manage_window_cancel(xcb_window_t window);
@@ -36,12 +36,25 @@ bool match_is_empty(Match *match);
  */
 void match_copy(Match *dest, Match *src);
 
+/**
+ * Returns true if both matches specify the same criteria.
+ *
+ */
+bool match_equals(Match *a, Match *b);
+
 /**
  * Check if a match data structure matches the given window.
  *
  */
 bool match_matches_window(Match *match, i3Window *window);
 
+/**
+ * Like match_matches_window(), but for the window of the given container,
+ * which saves looking up the container of the window.
+ *
+ */
+bool match_matches_con(Match *match, Con *con);
+
 /**
  * Frees the given match. It must not be used afterwards!
  *
@@ -11,6 +11,24 @@
 
 #include <config.h>
 
+/**
+ * Counters about the use of regular expressions, reported by the GET_STATS
+ * IPC message.
+ *
+ */
+struct regex_stats {
+    /** Number of compiled regular expressions (and how many of them use the
+     * PCRE JIT compiler). */
+    uint64_t compiled;
+    uint64_t jit_compiled;
+    /** Number of times a regular expression was evaluated. */
+    uint64_t evaluations;
+    /** Number of times regex_matches_cached() returned a cached result. */
+    uint64_t cache_hits;
+};
+
+extern struct regex_stats regex_stats;
+
 /**
  * Creates a new 'regex' struct containing the given pattern and a PCRE
  * compiled regular expression. Also, calls pcre_study because this regex will
@@ -36,3 +54,13 @@ void regex_free(struct regex *regex);
  *
  */
 bool regex_matches(struct regex *regex, const char *input);
+
+/**
+ * Like regex_matches(), but caches the result for the given key (like the
+ * window which the input belongs to). As long as the generation of the input
+ * stays the same, the cached result is returned without evaluating the
+ * regular expression again. The generation must change whenever the input
+ * changes and must never be reused for a different input of the same key.
+ *
+ */
+bool regex_matches_cached(struct regex *regex, const char *input, const void *key, uint64_t generation);
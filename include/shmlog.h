@@ -20,6 +20,15 @@
 /* Default shmlog size if not set by user. */
 extern const int default_shmlog_size;
 
+/* The log contains the formatted messages, one after another. */
+#define SHMLOG_FORMAT_TEXT 0
+/* The log contains i3_shmlog_record entries, formatted by i3-dump-log. */
+#define SHMLOG_FORMAT_BINARY 1
+
+/* Maximum size of a single record (including its header) in the binary
+ * format. */
+#define SHMLOG_RECORD_MAX_SIZE 4096
+
 /**
  * Header of the shmlog file. Used by i3/src/log.c and i3/i3-dump-log/main.c.
  *
@@ -41,6 +50,20 @@ typedef struct i3_shmlog_header {
      * and don’t matter — clients use an equality check (==). */
     uint32_t wrap_count;
 
+    /* SHMLOG_FORMAT_TEXT or SHMLOG_FORMAT_BINARY. */
+    uint32_t format;
+
+    /* Binary format only: byte offset of the oldest record which was not
+     * (partially) overwritten since the last wrap. Records between this
+     * offset and offset_last_wrap are older than the ones at the beginning of
+     * the log. */
+    uint32_t offset_oldest;
+
+    /* Binary format only: CLOCK_REALTIME minus CLOCK_MONOTONIC (in ns) at the
+     * time the log was opened, to convert the record timestamps into
+     * wall-clock time. */
+    int64_t realtime_offset;
+
 #if !defined(__OpenBSD__)
     /* pthread condvar which will be broadcasted whenever there is a new
      * message in the log. i3-dump-log uses this to implement -f (follow, like
@@ -48,3 +71,28 @@ typedef struct i3_shmlog_header {
     pthread_cond_t condvar;
 #endif
 } i3_shmlog_header;
+
+/**
+ * A log message in the binary format. The format string (NUL-terminated)
+ * follows this header, and the arguments of the message follow the format
+ * string, packed in the order they are consumed:
+ *
+ *  • int for '*' widths and precisions
+ *  • int64_t for d, i, c, uint64_t for o, u, x, X and p
+ *  • double or long double for floating point conversions
+ *  • the NUL-terminated string for s (cut at the precision, if any)
+ *
+ * Messages which cannot be packed (e.g. because they are too long) are stored
+ * pre-formatted, as a record with format string "%s".
+ *
+ */
+typedef struct i3_shmlog_record {
+    /* Size of the whole record in bytes, a multiple of 8. */
+    uint32_t size;
+
+    /* Length of the format string, excluding its NUL byte. */
+    uint32_t format_length;
+
+    /* CLOCK_MONOTONIC time at which the message was logged, in ns. */
+    uint64_t timestamp;
+} i3_shmlog_record;
@@ -0,0 +1,125 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved dynamic tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * snapshot.c: Compact binary serialization of the layout tree, used for
+ *             in-place restarts and the GET_TREE_SNAPSHOT IPC message.
+ *
+ */
+#pragma once
+
+#include <config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <yajl/yajl_parse.h>
+
+/*
+ * A snapshot contains exactly the same data as the JSON which dump_node()
+ * generates, but stored as a flat array of fixed-size tokens plus a table of
+ * deduplicated strings, so that it can be read in place (e.g. from an mmap()ed
+ * file) without any parsing or copying. All integers are stored in native
+ * byte order; snapshots are not meant to be moved between machines.
+ *
+ * Layout:
+ *   snapshot_header
+ *   snapshot_token[num_tokens]
+ *   snapshot_string[num_strings]
+ *   string data (strings_size bytes, every string is NUL-terminated)
+ *
+ */
+
+#define SNAPSHOT_MAGIC "i3-snap"
+#define SNAPSHOT_VERSION 1
+
+typedef struct snapshot_header {
+    /* SNAPSHOT_MAGIC, including the terminating NUL byte. */
+    char magic[8];
+    uint32_t version;
+    uint32_t num_tokens;
+    uint32_t num_strings;
+    uint32_t strings_size;
+} snapshot_header;
+
+typedef enum {
+    SNAP_MAP_OPEN = 0,
+    SNAP_MAP_CLOSE = 1,
+    SNAP_ARRAY_OPEN = 2,
+    SNAP_ARRAY_CLOSE = 3,
+    SNAP_KEY = 4,
+    SNAP_STRING = 5,
+    SNAP_INTEGER = 6,
+    SNAP_DOUBLE = 7,
+    SNAP_BOOL = 8,
+    SNAP_NULL = 9,
+} snapshot_token_t;
+
+typedef struct snapshot_token {
+    /* One of snapshot_token_t. */
+    uint32_t type;
+    /* For SNAP_KEY and SNAP_STRING: index into the string table. */
+    uint32_t string;
+    union {
+        /* SNAP_INTEGER and SNAP_BOOL */
+        int64_t integer;
+        /* SNAP_DOUBLE */
+        double number;
+    } value;
+} snapshot_token;
+
+typedef struct snapshot_string {
+    /* Offset of the string, relative to the start of the string data. */
+    uint32_t offset;
+    /* Length of the string, excluding the terminating NUL byte. */
+    uint32_t length;
+} snapshot_string;
+
+typedef struct snapshot_gen snapshot_gen;
+
+/**
+ * Allocates a new snapshot generator. Its functions mirror the yajl_gen API
+ * so that dump_node() can write either format.
+ *
+ */
+snapshot_gen *snapshot_gen_alloc(void);
+
+void snapshot_gen_map_open(snapshot_gen *gen);
+void snapshot_gen_map_close(snapshot_gen *gen);
+void snapshot_gen_array_open(snapshot_gen *gen);
+void snapshot_gen_array_close(snapshot_gen *gen);
+void snapshot_gen_integer(snapshot_gen *gen, long long number);
+void snapshot_gen_double(snapshot_gen *gen, double number);
+void snapshot_gen_bool(snapshot_gen *gen, int boolean);
+void snapshot_gen_null(snapshot_gen *gen);
+void snapshot_gen_string(snapshot_gen *gen, const unsigned char *str, size_t len);
+
+/**
+ * Returns the serialized snapshot. The buffer is owned by the generator and
+ * stays valid until the next call of any snapshot_gen function.
+ *
+ */
+void snapshot_gen_get_buf(snapshot_gen *gen, const unsigned char **buf, size_t *len);
+
+/**
+ * Frees the snapshot generator and its buffer.
+ *
+ */
+void snapshot_gen_free(snapshot_gen *gen);
+
+/**
+ * Returns true if the given buffer starts with a snapshot header (of any
+ * version).
+ *
+ */
+bool snapshot_is_snapshot(const char *buf, size_t len);
+
+/**
+ * Walks over the snapshot in buf and calls the given yajl callbacks for each
+ * token, just as yajl_parse() would for the equivalent JSON. Strings are
+ * passed as pointers into buf. Returns false (and sets *errormsg, if it is not
+ * NULL) if the snapshot is malformed or a callback returned 0.
+ *
+ */
+bool snapshot_parse(const char *buf, size_t len, const yajl_callbacks *callbacks, void *ctx, char **errormsg);
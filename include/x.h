@@ -15,6 +15,23 @@
 /** Stores the X11 window ID of the currently focused window */
 extern xcb_window_t focused_id;
 
+/**
+ * Counters about the requests which x_push_changes() sends to update the
+ * window stack, reported by the GET_STATS IPC message.
+ *
+ */
+struct render_stats {
+    /** Number of calls of x_push_changes(). */
+    uint64_t renders;
+    /** Number of requests (event masks, restacking and the
+     * _NET_CLIENT_LIST{,_STACKING} hints) sent for the window stack, during
+     * the last render and in total. */
+    uint64_t last_stack_requests;
+    uint64_t stack_requests;
+};
+
+extern struct render_stats render_stats;
+
 /**
  * Initializes the X11 part for the given container. Called exactly once for
  * every container from con_new().
@@ -55,6 +72,14 @@ void x_con_kill(Con *con);
  */
 void x_con_reframe(Con *con);
 
+/**
+ * Verifies that the frame index used by state_for_frame() matches the list of
+ * container states. Returns false (and logs the differences) if it does not.
+ * This is expensive and only meant to be used in debug builds.
+ *
+ */
+bool x_index_check(void);
+
 /**
  * Returns true if the client supports the given protocol atom (like WM_DELETE_WINDOW)
  *
@@ -73,6 +98,14 @@ void x_window_kill(xcb_window_t window, kill_window_t kill_window);
  */
 void x_draw_decoration(Con *con);
 
+/**
+ * Returns true if the given container is a hidden workspace which was skipped
+ * by tree_render() and has not changed since (see con_mark_dirty()), meaning
+ * that nothing in its subtree needs to be pushed to X11.
+ *
+ */
+bool x_can_skip_subtree(Con *con);
+
 /**
  * Recursively calls x_draw_decoration. This cannot be done in x_push_node
  * because x_push_node uses focus order to recurse (see the comment above)
@@ -133,7 +166,7 @@ void x_set_warp_to(Rect *rect);
 /**
  * Applies the given mask to the event mask of every i3 window decoration X11
  * window. This is useful to disable EnterNotify while resizing so that focus
- * is untouched.
+ * is untouched. The next call of x_push_changes() restores the event masks.
  *
  */
 void x_mask_event_mask(uint32_t mask);
@@ -0,0 +1,62 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved dynamic tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * xid_map.c: Hash map from X11 IDs (windows, pixmaps, …) to pointers, used to
+ *            avoid linear scans over all containers in the event handlers.
+ *
+ */
+#pragma once
+
+#include <config.h>
+
+#include <stdint.h>
+
+/**
+ * One slot of an xid_map. An id of XCB_NONE marks an empty slot.
+ *
+ */
+typedef struct xid_map_slot {
+    uint32_t id;
+    void *value;
+} xid_map_slot;
+
+/**
+ * Open addressing hash map (linear probing) from X11 IDs to pointers. A
+ * zero-initialized xid_map is a valid, empty map; the slots are allocated on
+ * the first insertion.
+ *
+ */
+typedef struct xid_map {
+    uint32_t capacity;
+    uint32_t count;
+    xid_map_slot *slots;
+} xid_map;
+
+/**
+ * Returns the value stored for the given ID or NULL if there is none.
+ *
+ */
+void *xid_map_get(const xid_map *map, uint32_t id);
+
+/**
+ * Stores the given value for the given ID, replacing any previous value.
+ * Storing XCB_NONE is not allowed.
+ *
+ */
+void xid_map_put(xid_map *map, uint32_t id, void *value);
+
+/**
+ * Removes the given ID from the map. Returns the value which was stored for it
+ * or NULL if the ID was not in the map.
+ *
+ */
+void *xid_map_remove(xid_map *map, uint32_t id);
+
+/**
+ * Removes all entries and frees the memory used by the map.
+ *
+ */
+void xid_map_free(xid_map *map);
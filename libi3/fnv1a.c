@@ -0,0 +1,23 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved dynamic tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ */
+#include "libi3.h"
+
+/*
+ * Adds the given bytes to a 64-bit FNV-1a hash. Start with
+ * FNV1A_64_OFFSET_BASIS and pass the result of the previous call to hash
+ * several chunks of data.
+ *
+ */
+uint64_t fnv1a_64(uint64_t hash, const void *data, size_t len) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= UINT64_C(1099511628211);
+    }
+    return hash;
+}
@@ -17,6 +17,8 @@
 #include <cairo/cairo-xcb.h>
 #include <pango/pangocairo.h>
 
+#include "queue.h"
+
 static const i3Font *savedFont = NULL;
 
 static xcb_visualtype_t *root_visual_type;
@@ -80,6 +82,157 @@ static bool load_pango_font(i3Font *font, const char *desc) {
     return true;
 }
 
+/*
+ * Cache of shaped PangoLayouts, so that the same text (e.g. a status line
+ * block which did not change or a window title) does not have to be laid out
+ * again on every redraw. Entries are evicted in least recently used order and
+ * the whole cache is flushed when the font is freed.
+ *
+ */
+#define TEXT_CACHE_SIZE 256
+#define TEXT_CACHE_BUCKETS 512
+
+struct text_cache_entry {
+    uint64_t hash;
+    const PangoFontDescription *desc;
+    bool pango_markup;
+    /* The maximum width the text is ellipsized at when drawing, or -1 for
+     * layouts which are only used to measure the text. */
+    int max_width;
+    char *text;
+    size_t text_len;
+
+    PangoLayout *layout;
+    int width;
+
+    struct text_cache_entry *next_in_bucket;
+    TAILQ_ENTRY(text_cache_entry)
+    lru;
+};
+
+static TAILQ_HEAD(text_cache_head, text_cache_entry) text_cache_lru =
+    TAILQ_HEAD_INITIALIZER(text_cache_lru);
+static struct text_cache_entry *text_cache_buckets[TEXT_CACHE_BUCKETS];
+static int text_cache_count;
+static uint64_t text_cache_hits;
+static uint64_t text_cache_misses;
+
+/* All cached layouts are created with this context, which belongs to a
+ * 1x1 surface on the root window. */
+static cairo_surface_t *measure_surface;
+static cairo_t *measure_cr;
+static PangoContext *measure_context;
+
+static PangoContext *get_measure_context(void) {
+    if (measure_context == NULL) {
+        /* root_visual_type is cached in load_pango_font */
+        measure_surface = cairo_xcb_surface_create(conn, root_screen->root, root_visual_type, 1, 1);
+        measure_cr = cairo_create(measure_surface);
+        measure_context = pango_cairo_create_context(measure_cr);
+        pango_cairo_context_set_resolution(measure_context, get_dpi_value());
+    }
+    return measure_context;
+}
+
+static uint64_t text_cache_hash(const char *text, size_t text_len, bool pango_markup, int max_width) {
+    uint64_t hash = fnv1a_64(FNV1A_64_OFFSET_BASIS, text, text_len);
+    hash = fnv1a_64(hash, &max_width, sizeof(max_width));
+    return fnv1a_64(hash, &pango_markup, sizeof(pango_markup));
+}
+
+static void text_cache_evict(struct text_cache_entry *entry) {
+    struct text_cache_entry **walk = &(text_cache_buckets[entry->hash % TEXT_CACHE_BUCKETS]);
+    while (*walk != entry) {
+        walk = &((*walk)->next_in_bucket);
+    }
+    *walk = entry->next_in_bucket;
+
+    TAILQ_REMOVE(&text_cache_lru, entry, lru);
+    text_cache_count--;
+    g_object_unref(entry->layout);
+    free(entry->text);
+    free(entry);
+}
+
+/*
+ * Flushes the text cache and frees the measuring context.
+ *
+ */
+static void text_cache_flush(void) {
+    while (!TAILQ_EMPTY(&text_cache_lru)) {
+        text_cache_evict(TAILQ_FIRST(&text_cache_lru));
+    }
+
+    if (measure_context != NULL) {
+        g_object_unref(measure_context);
+        cairo_destroy(measure_cr);
+        cairo_surface_destroy(measure_surface);
+        measure_context = NULL;
+        measure_cr = NULL;
+        measure_surface = NULL;
+    }
+}
+
+/*
+ * Returns the cache entry containing the layout of the given text in the
+ * current font, laying it out if it is not yet cached.
+ *
+ */
+static struct text_cache_entry *text_cache_get(const char *text, size_t text_len, bool pango_markup, int max_width) {
+    const PangoFontDescription *desc = savedFont->specific.pango_desc;
+    const uint64_t hash = text_cache_hash(text, text_len, pango_markup, max_width);
+    struct text_cache_entry *entry = text_cache_buckets[hash % TEXT_CACHE_BUCKETS];
+    for (; entry != NULL; entry = entry->next_in_bucket) {
+        if (entry->hash == hash &&
+            entry->desc == desc &&
+            entry->pango_markup == pango_markup &&
+            entry->max_width == max_width &&
+            entry->text_len == text_len &&
+            memcmp(entry->text, text, text_len) == 0) {
+            text_cache_hits++;
+            TAILQ_REMOVE(&text_cache_lru, entry, lru);
+            TAILQ_INSERT_HEAD(&text_cache_lru, entry, lru);
+            return entry;
+        }
+    }
+
+    text_cache_misses++;
+    if (text_cache_count == TEXT_CACHE_SIZE) {
+        text_cache_evict(TAILQ_LAST(&text_cache_lru, text_cache_head));
+    }
+
+    PangoLayout *layout = pango_layout_new(get_measure_context());
+    pango_layout_set_font_description(layout, desc);
+    if (max_width >= 0) {
+        pango_layout_set_width(layout, max_width * PANGO_SCALE);
+        pango_layout_set_wrap(layout, PANGO_WRAP_CHAR);
+        pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
+    }
+
+    if (pango_markup)
+        pango_layout_set_markup(layout, text, text_len);
+    else
+        pango_layout_set_text(layout, text, text_len);
+
+    entry = smalloc(sizeof(struct text_cache_entry));
+    entry->hash = hash;
+    entry->desc = desc;
+    entry->pango_markup = pango_markup;
+    entry->max_width = max_width;
+    entry->text = smalloc(text_len);
+    memcpy(entry->text, text, text_len);
+    entry->text_len = text_len;
+    entry->layout = layout;
+    pango_layout_get_pixel_size(layout, &(entry->width), NULL);
+
+    entry->next_in_bucket = text_cache_buckets[hash % TEXT_CACHE_BUCKETS];
+    text_cache_buckets[hash % TEXT_CACHE_BUCKETS] = entry;
+    TAILQ_INSERT_HEAD(&text_cache_lru, entry, lru);
+    text_cache_count++;
+
+    return entry;
+}
+
 /*
  * Draws text using Pango rendering.
  *
@@ -92,19 +245,9 @@ static void draw_text_pango(const char *text, size_t text_len,
     cairo_surface_t *surface = cairo_xcb_surface_create(conn, drawable,
                                                         visual, x + max_width, y + savedFont->height);
     cairo_t *cr = cairo_create(surface);
-    PangoLayout *layout = create_layout_with_dpi(cr);
+    PangoLayout *layout = text_cache_get(text, text_len, pango_markup, max_width)->layout;
     gint height;
 
-    pango_layout_set_font_description(layout, savedFont->specific.pango_desc);
-    pango_layout_set_width(layout, max_width * PANGO_SCALE);
-    pango_layout_set_wrap(layout, PANGO_WRAP_CHAR);
-    pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
-
-    if (pango_markup)
-        pango_layout_set_markup(layout, text, text_len);
-    else
-        pango_layout_set_text(layout, text, text_len);
-
     /* Do the drawing */
     cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
     cairo_set_source_rgba(cr, pango_font_red, pango_font_green, pango_font_blue, pango_font_alpha);
@@ -116,7 +259,6 @@ static void draw_text_pango(const char *text, size_t text_len,
     pango_cairo_show_layout(cr, layout);
 
     /* Free resources */
-    g_object_unref(layout);
     cairo_destroy(cr);
     cairo_surface_destroy(surface);
 }
@@ -126,30 +268,17 @@ static void draw_text_pango(const char *text, size_t text_len,
  *
  */
 static int predict_text_width_pango(const char *text, size_t text_len, bool pango_markup) {
-    /* Create a dummy Pango layout */
-    /* root_visual_type is cached in load_pango_font */
-    cairo_surface_t *surface = cairo_xcb_surface_create(conn, root_screen->root, root_visual_type, 1, 1);
-    cairo_t *cr = cairo_create(surface);
-    PangoLayout *layout = create_layout_with_dpi(cr);
-
-    /* Get the font width */
-    gint width;
-    pango_layout_set_font_description(layout, savedFont->specific.pango_desc);
-
-    if (pango_markup)
-        pango_layout_set_markup(layout, text, text_len);
-    else
-        pango_layout_set_text(layout, text, text_len);
-
-    pango_cairo_update_layout(cr, layout);
-    pango_layout_get_pixel_size(layout, &width, NULL);
-
-    /* Free resources */
-    g_object_unref(layout);
-    cairo_destroy(cr);
-    cairo_surface_destroy(surface);
+    return text_cache_get(text, text_len, pango_markup, -1)->width;
+}
 
-    return width;
+/*
+ * Returns the number of hits and misses of the text layout cache which is
+ * used for Pango fonts.
+ *
+ */
+void get_text_cache_stats(uint64_t *hits, uint64_t *misses) {
+    *hits = text_cache_hits;
+    *misses = text_cache_misses;
 }
 
 /*
@@ -278,6 +407,8 @@ void free_font(void) {
             break;
         }
         case FONT_TYPE_PANGO:
+            /* The cached layouts reference the font description */
+            text_cache_flush();
             /* Free the font description */
             pango_font_description_free(savedFont->specific.pango_desc);
             break;
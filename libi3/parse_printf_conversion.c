@@ -0,0 +1,133 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved dynamic tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ */
+#include "libi3.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Parses the printf conversion specification which fmt points to (fmt[0] has
+ * to be '%') into conv. Returns a pointer to the first character after the
+ * specification, or NULL if it is malformed.
+ *
+ * This is used to pack the arguments of log messages into the SHM log and to
+ * format them again in i3-dump-log.
+ *
+ */
+const char *parse_printf_conversion(const char *fmt, printf_conversion *conv) {
+    const char *walk = fmt + 1;
+
+    memset(conv, 0, sizeof(printf_conversion));
+    conv->precision = -1;
+
+    if (*walk == '%') {
+        conv->type = PRINTF_ARG_NONE;
+        conv->conversion = '%';
+        strcpy(conv->spec, "%");
+        return walk + 1;
+    }
+
+    /* flags */
+    while (*walk != '\0' && strchr("-+ #0'", *walk) != NULL)
+        walk++;
+
+    /* field width */
+    if (*walk == '*') {
+        conv->star_width = true;
+        walk++;
+    } else {
+        while (*walk >= '0' && *walk <= '9')
+            walk++;
+    }
+
+    /* precision */
+    if (*walk == '.') {
+        walk++;
+        if (*walk == '*') {
+            conv->star_precision = true;
+            walk++;
+        } else {
+            conv->precision = 0;
+            while (*walk >= '0' && *walk <= '9')
+                conv->precision = conv->precision * 10 + (*(walk++) - '0');
+        }
+    }
+
+    const size_t spec_len = walk - fmt;
+    if (spec_len >= sizeof(conv->spec))
+        return NULL;
+    memcpy(conv->spec, fmt, spec_len);
+    conv->spec[spec_len] = '\0';
+
+    /* length modifier */
+    switch (*walk) {
+        case 'h':
+            conv->length = (walk[1] == 'h' ? 'H' : 'h');
+            walk += (walk[1] == 'h' ? 2 : 1);
+            break;
+        case 'l':
+            conv->length = (walk[1] == 'l' ? 'L' : 'l');
+            walk += (walk[1] == 'l' ? 2 : 1);
+            break;
+        case 'q':
+        case 'L':
+            conv->length = 'L';
+            walk++;
+            break;
+        case 'j':
+        case 'z':
+        case 't':
+            conv->length = *(walk++);
+            break;
+    }
+
+    conv->conversion = *walk;
+    switch (*walk) {
+        case 'd':
+        case 'i':
+            conv->type = PRINTF_ARG_INT;
+            break;
+        case 'c':
+            conv->type = (conv->length == '\0' ? PRINTF_ARG_INT : PRINTF_ARG_UNSUPPORTED);
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            conv->type = PRINTF_ARG_UINT;
+            break;
+        case 'a':
+        case 'A':
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+            if (conv->length == '\0' || conv->length == 'l')
+                conv->type = PRINTF_ARG_DOUBLE;
+            else if (conv->length == 'L')
+                conv->type = PRINTF_ARG_LONG_DOUBLE;
+            else
+                conv->type = PRINTF_ARG_UNSUPPORTED;
+            break;
+        case 's':
+            conv->type = (conv->length == '\0' ? PRINTF_ARG_STRING : PRINTF_ARG_UNSUPPORTED);
+            break;
+        case 'p':
+            conv->type = PRINTF_ARG_POINTER;
+            break;
+        case '\0':
+            return NULL;
+        default:
+            conv->type = PRINTF_ARG_UNSUPPORTED;
+            break;
+    }
+
+    return walk + 1;
+}
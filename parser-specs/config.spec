@@ -54,6 +54,7 @@ state INITIAL:
   'workspace'                              -> WORKSPACE
   'ipc_socket', 'ipc-socket'               -> IPC_SOCKET
   'ipc_kill_timeout'                       -> IPC_KILL_TIMEOUT
+  'ipc_max_pending'                        -> IPC_MAX_PENDING
   'restart_state'                          -> RESTART_STATE
   'popup_during_fullscreen'                -> POPUP_DURING_FULLSCREEN
   exectype = 'exec_always', 'exec'         -> EXEC
@@ -331,6 +332,11 @@ state IPC_KILL_TIMEOUT:
   timeout = number
       -> call cfg_ipc_kill_timeout(&timeout)
 
+# ipc_max_pending <bytes>
+state IPC_MAX_PENDING:
+  bytes = number
+      -> call cfg_ipc_max_pending(&bytes)
+
 # restart_state <path> (for testcases)
 state RESTART_STATE:
   path = string
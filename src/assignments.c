@@ -17,7 +17,11 @@
 void run_assignments(i3Window *window) {
     DLOG("Checking if any assignments match this window\n");
 
-    bool needs_tree_render = false;
+    /* All commands operate on the window's container. If the window is not
+     * managed (yet), they would not match anything. */
+    Con *con = con_by_window_id(window->id);
+
+    command_batch_begin();
 
     /* Check if any assignments match */
     Assignment *current;
@@ -45,20 +49,19 @@ void run_assignments(i3Window *window) {
         window->ran_assignments = srealloc(window->ran_assignments, sizeof(Assignment *) * window->nr_assignments);
         window->ran_assignments[window->nr_assignments - 1] = current;
 
-        DLOG("matching assignment, execute command %s\n", current->dest.command);
-        char *full_command;
-        sasprintf(&full_command, "[id=\"%d\"] %s", window->id, current->dest.command);
-        CommandResult *result = parse_command(full_command, NULL);
-        free(full_command);
-
-        if (result->needs_tree_render)
-            needs_tree_render = true;
+        if (con == NULL) {
+            DLOG("window 0x%08x is not managed, not executing command %s\n", window->id, current->dest.command);
+            continue;
+        }
 
+        DLOG("matching assignment, execute command %s\n", current->dest.command);
+        CommandResult *result = command_batch_run(current->dest.command, NULL, con);
         command_result_free(result);
     }
 
-    /* If any of the commands required re-rendering, we will do that now. */
-    if (needs_tree_render)
+    /* If any of the commands required re-rendering, we will do that now,
+     * unless we are part of a larger batch (e.g. while managing a window). */
+    if (command_batch_end())
         tree_render();
 }
 
@@ -79,3 +82,43 @@ Assignment *assignment_for(i3Window *window, int type) {
 
     return NULL;
 }
+
+static bool assignment_equals(Assignment *a, Assignment *b) {
+    if (a->type != b->type || !match_equals(&(a->match), &(b->match)))
+        return false;
+    /* All destinations are strings, A_NO_FOCUS has none. */
+    if (a->dest.command == NULL || b->dest.command == NULL)
+        return (a->dest.command == b->dest.command);
+    return (strcmp(a->dest.command, b->dest.command) == 0);
+}
+
+/*
+ * To be called after the assignments were reloaded, while the previous
+ * assignments have not been freed yet: Makes every window remember the
+ * identical new assignment instead of a previous assignment it already ran,
+ * so that unchanged assignments are not run again. Previous assignments
+ * without an identical new one are forgotten.
+ *
+ */
+void assignments_reloaded(void) {
+    Con *con;
+    TAILQ_FOREACH(con, &all_cons, all_cons) {
+        i3Window *window = con->window;
+        if (window == NULL || window->nr_assignments == 0)
+            continue;
+
+        uint32_t kept = 0;
+        for (uint32_t c = 0; c < window->nr_assignments; c++) {
+            Assignment *current;
+            TAILQ_FOREACH(current, &assignments, assignments) {
+                if (assignment_equals(window->ran_assignments[c], current))
+                    break;
+            }
+            if (current != NULL)
+                window->ran_assignments[kept++] = current;
+        }
+        window->nr_assignments = kept;
+        if (kept == 0)
+            FREE(window->ran_assignments);
+    }
+}
@@ -122,29 +122,51 @@ static bool binding_in_current_group(const Binding *bind) {
     }
 }
 
-static void grab_keycode_for_binding(xcb_connection_t *conn, Binding *bind, uint32_t keycode) {
-    /* Grab the key in all combinations */
-#define GRAB_KEY(modifier)                                                                       \
-    do {                                                                                         \
-        xcb_grab_key(conn, 0, root, modifier, keycode, XCB_GRAB_MODE_SYNC, XCB_GRAB_MODE_ASYNC); \
-    } while (0)
-    const int mods = (bind->event_state_mask & 0xFFFF);
-    DLOG("Binding %p Grabbing keycode %d with event state mask 0x%x (mods 0x%x)\n",
-         bind, keycode, bind->event_state_mask, mods);
-    GRAB_KEY(mods);
-    /* Also bind the key with active NumLock */
-    GRAB_KEY(mods | xcb_numlock_mask);
-    /* Also bind the key with active CapsLock */
-    GRAB_KEY(mods | XCB_MOD_MASK_LOCK);
-    /* Also bind the key with active NumLock+CapsLock */
-    GRAB_KEY(mods | xcb_numlock_mask | XCB_MOD_MASK_LOCK);
+/* A key grab on the root window, see collect_key_grabs(). */
+struct key_grab {
+    uint16_t modifiers;
+    xcb_keycode_t keycode;
+};
+
+/* A sorted list of key grabs without duplicates. */
+struct key_grabs {
+    struct key_grab *grabs;
+    uint32_t count;
+    uint32_t size;
+};
+
+/* The keys which are currently grabbed, as of the last call to
+ * grab_all_keys() or update_key_grabs(). */
+static struct key_grabs grabbed_keys;
+
+static void key_grabs_add(struct key_grabs *list, xcb_keycode_t keycode, uint16_t modifiers) {
+    if (list->count == list->size) {
+        list->size = (list->size == 0 ? 64 : list->size * 2);
+        list->grabs = srealloc(list->grabs, list->size * sizeof(struct key_grab));
+    }
+    list->grabs[list->count++] = (struct key_grab){
+        .modifiers = modifiers,
+        .keycode = keycode};
+}
+
+static int key_grab_cmp(const void *a, const void *b) {
+    const struct key_grab *first = a;
+    const struct key_grab *second = b;
+    if (first->keycode != second->keycode)
+        return (first->keycode < second->keycode ? -1 : 1);
+    if (first->modifiers != second->modifiers)
+        return (first->modifiers < second->modifiers ? -1 : 1);
+    return 0;
 }
 
 /*
- * Grab the bound keys (tell X to send us keypress events for those keycodes)
+ * Fills the given list with the key grabs needed for the bindings of the
+ * current mode.
  *
  */
-void grab_all_keys(xcb_connection_t *conn) {
+static void collect_key_grabs(struct key_grabs *list) {
+    list->count = 0;
+
     Binding *bind;
     TAILQ_FOREACH(bind, bindings, bindings) {
         if (bind->input_type != B_KEYBOARD)
@@ -155,7 +177,15 @@ void grab_all_keys(xcb_connection_t *conn) {
 
         /* The easy case: the user specified a keycode directly. */
         if (bind->keycode > 0) {
-            grab_keycode_for_binding(conn, bind, bind->keycode);
+            const int mods = (bind->event_state_mask & 0xFFFF);
+            DLOG("Binding %p Grabbing keycode %d with event state mask 0x%x (mods 0x%x)\n",
+                 bind, bind->keycode, bind->event_state_mask, mods);
+            /* Grab the key in all combinations: also with active NumLock,
+             * active CapsLock and active NumLock+CapsLock. */
+            key_grabs_add(list, bind->keycode, mods);
+            key_grabs_add(list, bind->keycode, mods | xcb_numlock_mask);
+            key_grabs_add(list, bind->keycode, mods | XCB_MOD_MASK_LOCK);
+            key_grabs_add(list, bind->keycode, mods | xcb_numlock_mask | XCB_MOD_MASK_LOCK);
             continue;
         }
 
@@ -164,9 +194,75 @@ void grab_all_keys(xcb_connection_t *conn) {
             const int keycode = binding_keycode->keycode;
             const int mods = (binding_keycode->modifiers & 0xFFFF);
             DLOG("Binding %p Grabbing keycode %d with mods %d\n", bind, keycode, mods);
-            xcb_grab_key(conn, 0, root, mods, keycode, XCB_GRAB_MODE_SYNC, XCB_GRAB_MODE_ASYNC);
+            key_grabs_add(list, keycode, mods);
+        }
+    }
+
+    if (list->count == 0)
+        return;
+
+    /* Sort and remove duplicates so that update_key_grabs() can compute the
+     * difference of two lists in a single pass. */
+    qsort(list->grabs, list->count, sizeof(struct key_grab), key_grab_cmp);
+    uint32_t unique = 1;
+    for (uint32_t i = 1; i < list->count; i++) {
+        if (key_grab_cmp(&(list->grabs[i]), &(list->grabs[unique - 1])) != 0)
+            list->grabs[unique++] = list->grabs[i];
+    }
+    list->count = unique;
+}
+
+/*
+ * Grab the bound keys (tell X to send us keypress events for those keycodes)
+ *
+ */
+void grab_all_keys(xcb_connection_t *conn) {
+    collect_key_grabs(&grabbed_keys);
+    for (uint32_t i = 0; i < grabbed_keys.count; i++) {
+        const struct key_grab *grab = &(grabbed_keys.grabs[i]);
+        xcb_grab_key(conn, 0, root, grab->modifiers, grab->keycode, XCB_GRAB_MODE_SYNC, XCB_GRAB_MODE_ASYNC);
+    }
+}
+
+/*
+ * Grabs the keys needed for the bindings of the current mode like
+ * grab_all_keys(), but only ungrabs and grabs the keys which changed since the
+ * last call to grab_all_keys() or update_key_grabs() instead of starting from
+ * scratch. Used when reloading the configuration.
+ *
+ */
+void update_key_grabs(xcb_connection_t *conn) {
+    struct key_grabs new_grabs = {NULL, 0, 0};
+    collect_key_grabs(&new_grabs);
+
+    uint32_t old_idx = 0, new_idx = 0, ungrabbed = 0, grabbed = 0;
+    while (old_idx < grabbed_keys.count || new_idx < new_grabs.count) {
+        int cmp;
+        if (old_idx == grabbed_keys.count)
+            cmp = 1;
+        else if (new_idx == new_grabs.count)
+            cmp = -1;
+        else
+            cmp = key_grab_cmp(&(grabbed_keys.grabs[old_idx]), &(new_grabs.grabs[new_idx]));
+
+        if (cmp < 0) {
+            const struct key_grab *grab = &(grabbed_keys.grabs[old_idx++]);
+            xcb_ungrab_key(conn, grab->keycode, root, grab->modifiers);
+            ungrabbed++;
+        } else if (cmp > 0) {
+            const struct key_grab *grab = &(new_grabs.grabs[new_idx++]);
+            xcb_grab_key(conn, 0, root, grab->modifiers, grab->keycode, XCB_GRAB_MODE_SYNC, XCB_GRAB_MODE_ASYNC);
+            grabbed++;
+        } else {
+            old_idx++;
+            new_idx++;
         }
     }
+    DLOG("Updated key grabs: %u ungrabbed, %u grabbed, %u unchanged\n",
+         ungrabbed, grabbed, new_grabs.count - grabbed);
+
+    FREE(grabbed_keys.grabs);
+    grabbed_keys = new_grabs;
 }
 
 /*
@@ -191,30 +287,117 @@ void regrab_all_buttons(xcb_connection_t *conn) {
     xcb_ungrab_server(conn);
 }
 
+/* One translated keycode (with its modifiers) of a binding, see
+ * build_binding_table(). */
+struct binding_candidate {
+    Binding *bind;
+    i3_event_state_mask_t modifiers;
+};
+
+/* All candidates for one (input type, keycode/button) pair, in the order of
+ * the bindings list (i.e. more specific bindings first, see
+ * reorder_bindings()). The candidates of a binding are adjacent. */
+struct binding_slot {
+    struct binding_candidate *candidates;
+    uint32_t count;
+    uint32_t size;
+};
+
+/* Dispatch table for the bindings of the current mode, indexed by input type
+ * and keycode/button (both are 8 bit in X11). Built by build_binding_table()
+ * whenever translate_keysyms() ran, so that get_binding() does not need to
+ * walk through all bindings for every key press. */
+static struct binding_slot binding_table[2][256];
+static struct bindings_head *binding_table_bindings;
+
+/* Bindings which are currently marked as B_UPON_KEYRELEASE_IGNORE_MODS. */
+static Binding **ignore_mods_bindings;
+static uint32_t ignore_mods_count;
+static uint32_t ignore_mods_size;
+
+static void add_ignore_mods_binding(Binding *bind) {
+    if (ignore_mods_count == ignore_mods_size) {
+        ignore_mods_size = (ignore_mods_size == 0 ? 8 : ignore_mods_size * 2);
+        ignore_mods_bindings = srealloc(ignore_mods_bindings, ignore_mods_size * sizeof(Binding *));
+    }
+    ignore_mods_bindings[ignore_mods_count++] = bind;
+}
+
+/*
+ * (Re-)builds the dispatch table from the translated keycodes of the bindings
+ * of the current mode.
+ *
+ */
+static void build_binding_table(void) {
+    for (int type = 0; type < 2; type++) {
+        for (int code = 0; code < 256; code++) {
+            FREE(binding_table[type][code].candidates);
+            binding_table[type][code].count = binding_table[type][code].size = 0;
+        }
+    }
+    ignore_mods_count = 0;
+    binding_table_bindings = bindings;
+
+    Binding *bind;
+    TAILQ_FOREACH(bind, bindings, bindings) {
+        if (bind->release == B_UPON_KEYRELEASE_IGNORE_MODS)
+            add_ignore_mods_binding(bind);
+
+        struct Binding_Keycode *binding_keycode;
+        TAILQ_FOREACH(binding_keycode, &(bind->keycodes_head), keycodes) {
+            struct binding_slot *slot = &binding_table[bind->input_type][binding_keycode->keycode];
+            if (slot->count == slot->size) {
+                slot->size = (slot->size == 0 ? 4 : slot->size * 2);
+                slot->candidates = srealloc(slot->candidates, slot->size * sizeof(struct binding_candidate));
+            }
+            slot->candidates[slot->count++] = (struct binding_candidate){
+                .bind = bind,
+                .modifiers = binding_keycode->modifiers};
+        }
+    }
+}
+
 /*
  * Returns a pointer to the Binding with the specified modifiers and
  * keycode or NULL if no such binding exists.
  *
  */
 static Binding *get_binding(i3_event_state_mask_t state_filtered, bool is_release, uint16_t input_code, input_type_t input_type) {
-    Binding *bind;
     Binding *result = NULL;
 
+    if (binding_table_bindings != bindings)
+        build_binding_table();
+
     if (!is_release) {
         /* On a press event, we first reset all B_UPON_KEYRELEASE_IGNORE_MODS
          * bindings back to B_UPON_KEYRELEASE */
-        TAILQ_FOREACH(bind, bindings, bindings) {
-            if (bind->input_type != input_type)
+        for (uint32_t i = 0; i < ignore_mods_count;) {
+            Binding *bind = ignore_mods_bindings[i];
+            if (bind->input_type != input_type) {
+                i++;
                 continue;
+            }
             if (bind->release == B_UPON_KEYRELEASE_IGNORE_MODS)
                 bind->release = B_UPON_KEYRELEASE;
+            ignore_mods_bindings[i] = ignore_mods_bindings[--ignore_mods_count];
         }
     }
 
     const uint32_t xkb_group_state = (state_filtered & 0xFFFF0000);
     const uint32_t modifiers_state = (state_filtered & 0x0000FFFF);
-    TAILQ_FOREACH(bind, bindings, bindings) {
-        if (bind->input_type != input_type) {
+    const struct binding_slot *slot = &binding_table[input_type][input_code & 0xFF];
+    for (uint32_t i = 0; i < slot->count;) {
+        Binding *bind = slot->candidates[i].bind;
+
+        /* Check all translated keycodes of this binding. */
+        bool found_keycode = false;
+        for (; i < slot->count && slot->candidates[i].bind == bind; i++) {
+            const uint32_t modifiers_mask = (slot->candidates[i].modifiers & 0x0000FFFF);
+            if (modifiers_mask == modifiers_state ||
+                (bind->release == B_UPON_KEYRELEASE_IGNORE_MODS && is_release))
+                found_keycode = true;
+        }
+        if (!found_keycode) {
             continue;
         }
 
@@ -225,43 +408,10 @@ static Binding *get_binding(i3_event_state_mask_t state_filtered, bool is_releas
             continue;
         }
 
-        /* For keyboard bindings where a symbol was specified by the user, we
-         * need to look in the array of translated keycodes for the event’s
-         * keycode */
-        bool found_keycode = false;
-        if (input_type == B_KEYBOARD && bind->symbol != NULL) {
-            xcb_keycode_t input_keycode = (xcb_keycode_t)input_code;
-            struct Binding_Keycode *binding_keycode;
-            TAILQ_FOREACH(binding_keycode, &(bind->keycodes_head), keycodes) {
-                const uint32_t modifiers_mask = (binding_keycode->modifiers & 0x0000FFFF);
-                const bool mods_match = (modifiers_mask == modifiers_state);
-                DLOG("binding_keycode->modifiers = %d, modifiers_mask = %d, modifiers_state = %d, mods_match = %s\n",
-                     binding_keycode->modifiers, modifiers_mask, modifiers_state, (mods_match ? "yes" : "no"));
-                if (binding_keycode->keycode == input_keycode &&
-                    (mods_match || (bind->release == B_UPON_KEYRELEASE_IGNORE_MODS && is_release))) {
-                    found_keycode = true;
-                    break;
-                }
-            }
-        } else {
-            /* This case is easier: The user specified a keycode */
-            if (bind->keycode != input_code) {
-                continue;
-            }
-
-            struct Binding_Keycode *binding_keycode;
-            TAILQ_FOREACH(binding_keycode, &(bind->keycodes_head), keycodes) {
-                const uint32_t modifiers_mask = (binding_keycode->modifiers & 0x0000FFFF);
-                const bool mods_match = (modifiers_mask == modifiers_state);
-                DLOG("binding_keycode->modifiers = %d, modifiers_mask = %d, modifiers_state = %d, mods_match = %s\n",
-                     binding_keycode->modifiers, modifiers_mask, modifiers_state, (mods_match ? "yes" : "no"));
-                if (mods_match || (bind->release == B_UPON_KEYRELEASE_IGNORE_MODS && is_release)) {
-                    found_keycode = true;
-                    break;
-                }
-            }
-        }
-        if (!found_keycode) {
+        /* The user specified a keycode (or button) instead of a symbol: make
+         * sure it is not just equal in its lower 8 bits. */
+        if ((input_type != B_KEYBOARD || bind->symbol == NULL) &&
+            bind->keycode != input_code) {
             continue;
         }
 
@@ -271,6 +421,7 @@ static Binding *get_binding(i3_event_state_mask_t state_filtered, bool is_releas
          * actual key or button and the release event will still be matched. */
         if (bind->release == B_UPON_KEYRELEASE && !is_release) {
             bind->release = B_UPON_KEYRELEASE_IGNORE_MODS;
+            add_ignore_mods_binding(bind);
             DLOG("marked bind %p as B_UPON_KEYRELEASE_IGNORE_MODS\n", bind);
             if (result) {
                 break;
@@ -604,6 +755,8 @@ out:
     xkb_state_unref(dummy_state_numlock);
     xkb_state_unref(dummy_state_numlock_no_shift);
 
+    build_binding_table();
+
     if (has_errors) {
         start_config_error_nagbar(current_configpath, true);
     }
@@ -641,7 +794,7 @@ void switch_mode(const char *new_mode) {
         sasprintf(&event_msg, "{\"change\":\"%s\", \"pango_markup\":%s}",
                   mode->name, (mode->pango_markup ? "true" : "false"));
 
-        ipc_send_event("mode", I3_IPC_EVENT_MODE, event_msg);
+        ipc_send_event(I3_IPC_EVENT_MODE, event_msg);
         FREE(event_msg);
 
         return;
@@ -174,6 +174,48 @@ void cmd_criteria_match_windows(I3_CMD) {
     owindow *next, *current;
 
     DLOG("match specification finished, matching...\n");
+
+    /* Some criteria can only be fulfilled by a single container, which we can
+     * look up directly. The other criteria then only need to be checked on
+     * that container instead of on all of them. Window criteria can be
+     * fulfilled by window-less containers if a mark is specified, so we only
+     * use them without a mark. */
+    bool narrowed = true;
+    Con *candidate = NULL;
+    if (current_match->con_id != NULL) {
+        candidate = current_match->con_id;
+    } else if (current_match->mark != NULL && current_match->mark->exact != NULL) {
+        /* The regular expression also matches the mark followed by a newline,
+         * so if no container has exactly this mark, we check all of them. */
+        candidate = con_by_mark(current_match->mark->exact);
+        narrowed = (candidate != NULL);
+    } else if (current_match->mark == NULL && current_match->id != XCB_NONE) {
+        candidate = con_by_window_id(current_match->id);
+    } else {
+        narrowed = false;
+    }
+    if (narrowed)
+        DLOG("criteria narrowed down to con %p\n", candidate);
+
+    /* [urgent=latest] and [urgent=oldest] compare the urgency of all windows.
+     * We look up the matching urgency time once, so that only the windows
+     * which became urgent at that time need to be checked. */
+    const bool check_urgent = (!narrowed && current_match->mark == NULL &&
+                               (current_match->urgent == U_LATEST || current_match->urgent == U_OLDEST));
+    struct timeval urgent = {0, 0};
+    if (check_urgent) {
+        Con *con;
+        TAILQ_FOREACH(con, &all_cons, all_cons) {
+            if (con->window == NULL || con->window->urgent.tv_sec == 0)
+                continue;
+            const struct timeval *time = &(con->window->urgent);
+            const bool later = (time->tv_sec > urgent.tv_sec ||
+                                (time->tv_sec == urgent.tv_sec && time->tv_usec > urgent.tv_usec));
+            if (urgent.tv_sec == 0 || (current_match->urgent == U_LATEST) == later)
+                urgent = *time;
+        }
+    }
+
     /* copy the old list head to iterate through it and start with a fresh
      * list which will contain only matching windows */
     struct owindows_head old = owindows;
@@ -185,6 +227,14 @@ void cmd_criteria_match_windows(I3_CMD) {
         current = next;
         next = TAILQ_NEXT(next, owindows);
 
+        if ((narrowed && current->con != candidate) ||
+            (check_urgent && (current->con->window == NULL || urgent.tv_sec == 0 ||
+                              current->con->window->urgent.tv_sec != urgent.tv_sec ||
+                              current->con->window->urgent.tv_usec != urgent.tv_usec))) {
+            FREE(current);
+            continue;
+        }
+
         DLOG("checking if con %p / %s matches\n", current->con, current->con->name);
 
         /* We use this flag to prevent matching on window-less containers if
@@ -225,7 +275,7 @@ void cmd_criteria_match_windows(I3_CMD) {
         }
 
         if (current->con->window != NULL) {
-            if (match_matches_window(current_match, current->con->window)) {
+            if (match_matches_con(current_match, current->con)) {
                 DLOG("matches window!\n");
                 accept_match = true;
             } else {
@@ -248,6 +298,16 @@ void cmd_criteria_match_windows(I3_CMD) {
     }
 }
 
+/*
+ * Restricts the criteria to the given container, just like [con_id=…] would,
+ * but without formatting and parsing the criteria.
+ *
+ */
+void cmd_criteria_set_con(I3_CMD, Con *con) {
+    current_match->con_id = con;
+    cmd_criteria_match_windows(current_match, cmd_output);
+}
+
 /*
  * Interprets a ctype=cvalue pair and adds it to the current match
  * specification.
@@ -1443,7 +1503,10 @@ void cmd_sticky(I3_CMD, const char *action) {
      * sure it gets pushed to the front now. */
     output_push_sticky_windows(focused);
 
-    ewmh_update_wm_desktop();
+    TAILQ_FOREACH(current, &owindows, owindows) {
+        if (current->con->window != NULL)
+            ewmh_update_wm_desktop_con(current->con);
+    }
 
     cmd_output->needs_tree_render = true;
     ysuccess(true);
@@ -1577,8 +1640,8 @@ void cmd_reload(I3_CMD) {
     x_set_i3_atoms();
     /* Send an IPC event just in case the ws names have changed */
     ipc_send_workspace_event("reload", NULL, NULL);
-    /* Send an update event for the barconfig just in case it has changed */
-    update_barconfig();
+    /* load_configuration() already sent barconfig_update events for all bars
+     * whose configuration changed. */
 
     // XXX: default reply for now, make this a better reply
     ysuccess(true);
@@ -1897,7 +1960,7 @@ void cmd_title_format(I3_CMD, const char *format) {
             current->con->window->name_x_changed = true;
         } else {
             /* For windowless containers we also need to force the redrawing. */
-            FREE(current->con->deco_render_params);
+            current->con->deco_render_params_valid = false;
         }
     }
 
@@ -2005,6 +2068,8 @@ void cmd_rename_workspace(I3_CMD, const char *old_name, const char *new_name) {
     ewmh_update_desktop_names();
     ewmh_update_desktop_viewport();
     ewmh_update_current_desktop();
+    /* Renaming might have changed the order of the workspaces. */
+    ewmh_update_wm_desktop();
 
     startup_sequence_rename_workspace(old_name_copy, new_name);
     free(old_name_copy);
@@ -49,6 +49,9 @@
 typedef struct token {
     char *name;
     char *identifier;
+    cmdp_token_kind kind;
+    /* For literals: the length of the literal (without the leading quote). */
+    uint16_t literal_len;
     /* This might be __CALL */
     cmdp_state next_state;
     union {
@@ -56,9 +59,20 @@ typedef struct token {
     } extra;
 } cmdp_token;
 
+/* A node of the per-state trie of (lowercased) literals. Index 0 is the root,
+ * and 0 is used as "no node" for child and sibling. */
+typedef struct trie_node {
+    char c;
+    uint16_t child;
+    uint16_t sibling;
+    /* Index of the first token whose literal ends at this node, or -1. */
+    int16_t token;
+} cmdp_trie_node;
+
 typedef struct tokenptr {
     cmdp_token *array;
     int n;
+    const cmdp_trie_node *trie;
 } cmdp_token_ptr;
 
 #include "GENERATED_command_tokens.h"
@@ -165,6 +179,31 @@ static void clear_stack(void) {
     }
 }
 
+/*
+ * Returns the index of the first token in the current state whose literal
+ * matches the beginning of walk (case-insensitively), or -1 if no literal
+ * matches. The trie is walked once, so the cost only depends on the length
+ * of the longest matching literal, not on the number of literals.
+ *
+ */
+static int find_literal(const cmdp_token_ptr *ptr, const char *walk) {
+    const cmdp_trie_node *trie = ptr->trie;
+    int result = -1;
+    uint16_t node = trie[0].child;
+    while (node != 0 && *walk != '\0') {
+        const char c = (*walk >= 'A' && *walk <= 'Z' ? *walk - 'A' + 'a' : *walk);
+        while (node != 0 && trie[node].c != c)
+            node = trie[node].sibling;
+        if (node == 0)
+            break;
+        if (trie[node].token != -1 && (result == -1 || trie[node].token < result))
+            result = trie[node].token;
+        node = trie[node].child;
+        walk++;
+    }
+    return result;
+}
+
 /*******************************************************************************
  * The parser itself.
  ******************************************************************************/
@@ -254,14 +293,7 @@ char *parse_string(const char **walk, bool as_word) {
     return str;
 }
 
-/*
- * Parses and executes the given command. If a caller-allocated yajl_gen is
- * passed, a json reply will be generated in the format specified by the ipc
- * protocol. Pass NULL if no json reply is required.
- *
- * Free the returned CommandResult with command_result_free().
- */
-CommandResult *parse_command(const char *input, yajl_gen gen) {
+static CommandResult *parse_command_on(const char *input, yajl_gen gen, Con *con) {
     DLOG("COMMAND: *%s*\n", input);
     state = INITIAL;
     CommandResult *result = scalloc(1, sizeof(CommandResult));
@@ -281,6 +313,8 @@ CommandResult *parse_command(const char *input, yajl_gen gen) {
 // TODO: make this testable
 #ifndef TEST_PARSER
     cmd_criteria_init(&current_match, &subcommand_output);
+    if (con != NULL)
+        cmd_criteria_set_con(&current_match, &subcommand_output, con);
 #endif
 
     /* The "<=" operator is intentional: We also handle the terminating 0-byte
@@ -293,16 +327,17 @@ CommandResult *parse_command(const char *input, yajl_gen gen) {
             walk++;
 
         cmdp_token_ptr *ptr = &(tokens[state]);
+        const int literal = find_literal(ptr, walk);
         token_handled = false;
         for (c = 0; c < ptr->n; c++) {
             token = &(ptr->array[c]);
 
             /* A literal. */
-            if (token->name[0] == '\'') {
-                if (strncasecmp(walk, token->name + 1, strlen(token->name) - 1) == 0) {
+            if (token->kind == TOKEN_LITERAL) {
+                if (c == literal) {
                     if (token->identifier != NULL)
                         push_string(token->identifier, sstrdup(token->name + 1));
-                    walk += strlen(token->name) - 1;
+                    walk += token->literal_len;
                     next_state(token);
                     token_handled = true;
                     break;
@@ -310,7 +345,7 @@ CommandResult *parse_command(const char *input, yajl_gen gen) {
                 continue;
             }
 
-            if (strcmp(token->name, "number") == 0) {
+            if (token->kind == TOKEN_NUMBER) {
                 /* Handle numbers. We only accept decimal numbers for now. */
                 char *end = NULL;
                 errno = 0;
@@ -333,9 +368,8 @@ CommandResult *parse_command(const char *input, yajl_gen gen) {
                 break;
             }
 
-            if (strcmp(token->name, "string") == 0 ||
-                strcmp(token->name, "word") == 0) {
-                char *str = parse_string(&walk, (token->name[0] != 's'));
+            if (token->kind == TOKEN_STRING || token->kind == TOKEN_WORD) {
+                char *str = parse_string(&walk, (token->kind == TOKEN_WORD));
                 if (str != NULL) {
                     if (token->identifier)
                         push_string(token->identifier, str);
@@ -349,7 +383,7 @@ CommandResult *parse_command(const char *input, yajl_gen gen) {
                 }
             }
 
-            if (strcmp(token->name, "end") == 0) {
+            if (token->kind == TOKEN_END) {
                 if (*walk == '\0' || *walk == ',' || *walk == ';') {
                     next_state(token);
                     token_handled = true;
@@ -383,7 +417,7 @@ CommandResult *parse_command(const char *input, yajl_gen gen) {
             char *tokenwalk = possible_tokens;
             for (c = 0; c < ptr->n; c++) {
                 token = &(ptr->array[c]);
-                if (token->name[0] == '\'') {
+                if (token->kind == TOKEN_LITERAL) {
                     /* A literal is copied to the error message enclosed with
                      * single quotes. */
                     *tokenwalk++ = '\'';
@@ -451,6 +485,64 @@ CommandResult *parse_command(const char *input, yajl_gen gen) {
     return result;
 }
 
+/*
+ * Parses and executes the given command. If a caller-allocated yajl_gen is
+ * passed, a json reply will be generated in the format specified by the ipc
+ * protocol. Pass NULL if no json reply is required.
+ *
+ * Free the returned CommandResult with command_result_free().
+ */
+CommandResult *parse_command(const char *input, yajl_gen gen) {
+    return parse_command_on(input, gen, NULL);
+}
+
+/* Nesting depth of command_batch_begin() and whether any command of the
+ * current batch needs a tree_render(). */
+static int batch_depth = 0;
+static bool batch_needs_tree_render = false;
+
+/*
+ * Starts a batch of commands. Commands which are run with command_batch_run()
+ * do not render the tree themselves; instead, the outermost
+ * command_batch_end() reports whether any of them needs a tree_render().
+ * Batches can be nested.
+ *
+ */
+void command_batch_begin(void) {
+    batch_depth++;
+}
+
+/*
+ * Parses and executes the given command as part of the current batch, just
+ * like parse_command(). If con is not NULL, the first command (up to the
+ * first semicolon) operates on con, as if it was prefixed with [con_id=…]
+ * criteria.
+ *
+ * Free the returned CommandResult with command_result_free().
+ */
+CommandResult *command_batch_run(const char *input, yajl_gen gen, Con *con) {
+    assert(batch_depth > 0);
+    CommandResult *result = parse_command_on(input, gen, con);
+    if (result->needs_tree_render)
+        batch_needs_tree_render = true;
+    return result;
+}
+
+/*
+ * Ends a batch of commands. Returns true if this was the outermost batch and
+ * any of its commands needs a tree_render(), which the caller has to do.
+ *
+ */
+bool command_batch_end(void) {
+    assert(batch_depth > 0);
+    if (--batch_depth > 0)
+        return false;
+
+    const bool needs_tree_render = batch_needs_tree_render;
+    batch_needs_tree_render = false;
+    return needs_tree_render;
+}
+
 /*
  * Frees a CommandResult
  */
@@ -464,7 +556,7 @@ void command_result_free(CommandResult *result) {
 
 /*******************************************************************************
  * Code for building the stand-alone binary test.commands_parser which is used
- * by t/187-commands-parser.t.
+ * by t/187-commands-parser.t, and the microbenchmark bench.commands_parser.
  ******************************************************************************/
 
 #ifdef TEST_PARSER
@@ -492,6 +584,7 @@ void errorlog(char *fmt, ...) {
     va_end(args);
 }
 
+#ifndef BENCH_PARSER
 int main(int argc, char *argv[]) {
     if (argc < 2) {
         fprintf(stderr, "Syntax: %s <command>\n", argv[0]);
@@ -505,4 +598,62 @@ int main(int argc, char *argv[]) {
 
     yajl_gen_free(gen);
 }
+#else
+/*
+ * Stand-alone microbenchmark bench.commands_parser: parses each of the given
+ * commands (or a built-in set of typical commands) the given number of times
+ * and prints the average time per command. The debug output of the parser is
+ * sent to /dev/null so that only the parser itself is measured.
+ *
+ */
+int main(int argc, char *argv[]) {
+    static const char *default_commands[] = {
+        "workspace 3",
+        "workspace next_on_output",
+        "move container to workspace number 4",
+        "[class=\"^Firefox$\" title=\"foo\"] focus",
+        "focus left; move right; split vertical",
+        "resize grow width 10 px or 10 ppt",
+        "layout toggle split",
+        "exec --no-startup-id i3-sensible-terminal",
+        "mark --add --toggle foo",
+        "nop this is a comment",
+    };
+    if (argc < 2) {
+        fprintf(stderr, "Syntax: %s <iterations> [command...]\n", argv[0]);
+        return 1;
+    }
+    const long iterations = strtol(argv[1], NULL, 10);
+    const char **commands = (argc > 2 ? (const char **)argv + 2 : default_commands);
+    const int num_commands = (argc > 2 ? argc - 2 : (int)(sizeof(default_commands) / sizeof(default_commands[0])));
+
+    if (freopen("/dev/null", "w", stderr) == NULL) {
+        perror("freopen");
+        return 1;
+    }
+    FILE *out = fdopen(dup(STDOUT_FILENO), "w");
+    if (out == NULL || freopen("/dev/null", "w", stdout) == NULL) {
+        perror("freopen");
+        return 1;
+    }
+
+    yajl_gen gen = yajl_gen_alloc(NULL);
+    for (int c = 0; c < num_commands; c++) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long i = 0; i < iterations; i++) {
+            CommandResult *result = parse_command(commands[c], gen);
+            command_result_free(result);
+            yajl_gen_clear(gen);
+            yajl_gen_reset(gen, NULL);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        const double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+        fprintf(out, "%10.1f ns  %s\n", (iterations > 0 ? ns / iterations : 0), commands[c]);
+    }
+    yajl_gen_free(gen);
+    fclose(out);
+    return 0;
+}
+#endif
 #endif
@@ -22,15 +22,22 @@ static void con_on_remove_child(Con *con);
 void con_force_split_parents_redraw(Con *con) {
     Con *parent = con;
 
+    con_mark_dirty(con);
+
     while (parent != NULL && parent->type != CT_WORKSPACE && parent->type != CT_DOCKAREA) {
         if (!con_is_leaf(parent)) {
-            FREE(parent->deco_render_params);
+            parent->deco_render_params_valid = false;
         }
 
         parent = parent->parent;
     }
 }
 
+/* Indexes from X11 window IDs to containers, see con_by_window_id() and
+ * con_by_frame_id(). */
+static xid_map cons_by_window;
+static xid_map cons_by_frame;
+
 /*
  * Create a new container (and attach it to the given parent, if not NULL).
  * This function only initializes the data structures.
@@ -41,7 +48,10 @@ Con *con_new_skeleton(Con *parent, i3Window *window) {
     new->on_remove_child = con_on_remove_child;
     TAILQ_INSERT_TAIL(&all_cons, new, all_cons);
     new->type = CT_CON;
+    new->dirty = true;
     new->window = window;
+    new->ewmh_desktop = NET_WM_DESKTOP_NONE;
+    con_index_window(new);
     new->border_style = config.default_border;
     new->current_border_width = -1;
     if (window) {
@@ -77,8 +87,9 @@ Con *con_new(Con *parent, i3Window *window) {
  *
  */
 void con_free(Con *con) {
+    con_unindex_window(con);
+    con_unindex_frame(con);
     free(con->name);
-    FREE(con->deco_render_params);
     TAILQ_REMOVE(&all_cons, con, all_cons);
     while (!TAILQ_EMPTY(&(con->swallow_head))) {
         Match *match = TAILQ_FIRST(&(con->swallow_head));
@@ -214,6 +225,17 @@ void con_detach(Con *con) {
     }
 }
 
+/*
+ * Marks the given container and all of its parents as dirty, meaning that the
+ * next tree_render() cannot skip the workspace containing it.
+ *
+ */
+void con_mark_dirty(Con *con) {
+    for (Con *current = con; current != NULL; current = current->parent) {
+        current->dirty = true;
+    }
+}
+
 /*
  * Sets input focus to the given container. Will be updated in X11 in the next
  * run of x_push_changes().
@@ -222,6 +244,7 @@ void con_detach(Con *con) {
 void con_focus(Con *con) {
     assert(con != NULL);
     DLOG("con_focus = %p\n", con);
+    con_mark_dirty(con);
 
     /* 1: set focused-pointer to the new con */
     /* 2: exchange the position of the container in focus stack of the parent all the way up */
@@ -604,17 +627,97 @@ bool con_has_parent(Con *con, Con *parent) {
     return con_has_parent(current, parent);
 }
 
+/*
+ * Adds the container to the index used by con_by_window_id(). Has to be called
+ * whenever con->window is set to a new window.
+ *
+ */
+void con_index_window(Con *con) {
+    if (con->window == NULL || con->window->id == XCB_NONE) {
+        return;
+    }
+    xid_map_put(&cons_by_window, con->window->id, con);
+}
+
+/*
+ * Removes the container from the index used by con_by_window_id(). Has to be
+ * called before con->window is freed or moved to another container.
+ *
+ */
+void con_unindex_window(Con *con) {
+    if (con->window == NULL || xid_map_get(&cons_by_window, con->window->id) != con) {
+        return;
+    }
+    xid_map_remove(&cons_by_window, con->window->id);
+}
+
+/*
+ * Adds the container to the index used by con_by_frame_id(). Called from
+ * x_con_init() once the frame has been created.
+ *
+ */
+void con_index_frame(Con *con) {
+    xid_map_put(&cons_by_frame, con->frame.id, con);
+}
+
+/*
+ * Removes the container from the index used by con_by_frame_id(). Called from
+ * x_con_kill() and x_con_reframe().
+ *
+ */
+void con_unindex_frame(Con *con) {
+    if (xid_map_get(&cons_by_frame, con->frame.id) != con) {
+        return;
+    }
+    xid_map_remove(&cons_by_frame, con->frame.id);
+}
+
+/*
+ * Verifies that the window and frame indexes match the containers in
+ * all_cons. Returns false (and logs the differences) if they do not. This is
+ * expensive and only meant to be used in debug builds.
+ *
+ */
+bool con_index_check(void) {
+    bool ok = true;
+    uint32_t windows = 0, frames = 0;
+    Con *con;
+    TAILQ_FOREACH(con, &all_cons, all_cons) {
+        if (con->window != NULL && con->window->id != XCB_NONE) {
+            windows++;
+            if (xid_map_get(&cons_by_window, con->window->id) != con) {
+                ELOG("Window 0x%08x of con %p is not indexed\n", con->window->id, con);
+                ok = false;
+            }
+        }
+        if (con->frame.id != XCB_NONE) {
+            frames++;
+            if (xid_map_get(&cons_by_frame, con->frame.id) != con) {
+                ELOG("Frame 0x%08x of con %p is not indexed\n", con->frame.id, con);
+                ok = false;
+            }
+        }
+    }
+    if (windows != cons_by_window.count) {
+        ELOG("Window index contains %u entries, but there are %u windows\n",
+             cons_by_window.count, windows);
+        ok = false;
+    }
+    if (frames != cons_by_frame.count) {
+        ELOG("Frame index contains %u entries, but there are %u frames\n",
+             cons_by_frame.count, frames);
+        ok = false;
+    }
+    return ok;
+}
+
 /*
  * Returns the container with the given client window ID or NULL if no such
  * container exists.
  *
  */
 Con *con_by_window_id(xcb_window_t window) {
-    Con *con;
-    TAILQ_FOREACH(con, &all_cons, all_cons)
-    if (con->window != NULL && con->window->id == window)
-        return con;
-    return NULL;
+    return xid_map_get(&cons_by_window, window);
 }
 
 /*
@@ -648,11 +751,7 @@ bool con_exists(Con *con) {
  *
  */
 Con *con_by_frame_id(xcb_window_t frame) {
-    Con *con;
-    TAILQ_FOREACH(con, &all_cons, all_cons)
-    if (con->frame.id == frame)
-        return con;
-    return NULL;
+    return xid_map_get(&cons_by_frame, frame);
 }
 
 /*
@@ -951,6 +1050,8 @@ void con_fix_percent(Con *con) {
     Con *child;
     int children = con_num_children(con);
 
+    con_mark_dirty(con);
+
     // calculate how much we have distributed and how many containers
     // with a percentage set we have
     double total = 0.0;
@@ -1017,6 +1118,7 @@ void con_toggle_fullscreen(Con *con, int fullscreen_mode) {
  */
 static void con_set_fullscreen_mode(Con *con, fullscreen_mode_t fullscreen_mode) {
     con->fullscreen_mode = fullscreen_mode;
+    con_mark_dirty(con);
 
     DLOG("mode now: %d\n", con->fullscreen_mode);
 
@@ -1295,12 +1397,12 @@ static bool _con_move_to_con(Con *con, Con *target, bool behind_focused, bool fi
     }
 
     /* Ensure the container will be redrawn. */
-    FREE(con->deco_render_params);
+    con->deco_render_params_valid = false;
 
     CALL(parent, on_remove_child);
 
     ipc_send_window_event("move", con);
-    ewmh_update_wm_desktop();
+    ewmh_update_wm_desktop_con(con);
     return true;
 }
 
@@ -1717,6 +1819,8 @@ int con_border_style(Con *con) {
  *
  */
 void con_set_border_style(Con *con, int border_style, int border_width) {
+    con_mark_dirty(con);
+
     /* Handle the simple case: non-floating containerns */
     if (!con_is_floating(con)) {
         con->border_style = border_style;
@@ -1953,15 +2057,21 @@ static void con_on_remove_child(Con *con) {
     if (con->type == CT_WORKSPACE) {
         if (TAILQ_EMPTY(&(con->focus_head)) && !workspace_is_visible(con)) {
             LOG("Closing old workspace (%p / %s), it is empty\n", con, con->name);
-            yajl_gen gen = ipc_marshal_workspace_event("empty", con, NULL);
+            /* The event has to be serialized before the workspace is freed. */
+            yajl_gen gen = NULL;
+            if (ipc_has_event_subscribers(I3_IPC_EVENT_WORKSPACE)) {
+                gen = ipc_marshal_workspace_event("empty", con, NULL);
+            }
             tree_close_internal(con, DONT_KILL_WINDOW, false);
 
-            const unsigned char *payload;
-            ylength length;
-            y(get_buf, &payload, &length);
-            ipc_send_event("workspace", I3_IPC_EVENT_WORKSPACE, (const char *)payload);
+            if (gen != NULL) {
+                const unsigned char *payload;
+                ylength length;
+                y(get_buf, &payload, &length);
+                ipc_send_event(I3_IPC_EVENT_WORKSPACE, (const char *)payload);
 
-            y(free);
+                y(free);
+            }
         }
         return;
     }
@@ -2414,6 +2524,9 @@ bool con_swap(Con *first, Con *second) {
      * doesn't change during the swap. */
     SWAP(first->percent, second->percent, double);
 
+    con_mark_dirty(first);
+    con_mark_dirty(second);
+
     if (restore_focus) {
         con_focus(restore_focus);
     }
@@ -39,16 +39,186 @@ void update_barconfig(void) {
     }
 }
 
-static void free_configuration(void) {
-    assert(conn != NULL);
+/*
+ * Frees all assignments of the given list.
+ *
+ */
+static void free_assignments(struct assignments_head *head) {
+    while (!TAILQ_EMPTY(head)) {
+        struct Assignment *assign = TAILQ_FIRST(head);
+        if (assign->type == A_TO_WORKSPACE || assign->type == A_TO_WORKSPACE_NUMBER)
+            FREE(assign->dest.workspace);
+        else if (assign->type == A_COMMAND)
+            FREE(assign->dest.command);
+        else if (assign->type == A_TO_OUTPUT)
+            FREE(assign->dest.output);
+        match_free(&(assign->match));
+        TAILQ_REMOVE(head, assign, assignments);
+        FREE(assign);
+    }
+}
 
-    /* If we are currently in a binding mode, we first revert to the default
-     * since we have no guarantee that the current mode will even still exist
-     * after parsing the config again. See #2228. */
-    switch_mode("default");
+/*
+ * The parts of the previous configuration which are compared with the
+ * reloaded configuration, so that only the changes need to be applied. See
+ * save_previous_config() and apply_config_changes().
+ *
+ */
+struct previous_config {
+    /* A copy of the previous config. Its pointers must not be used. */
+    Config config;
+    char *font_pattern;
+
+    /* The buttons which are grabbed on all windows. */
+    int *buttons;
+
+    /* The previous assignments, to which windows still refer in their
+     * ran_assignments. */
+    struct assignments_head assignments;
+
+    /* The previous bar configs, serialized like for barconfig_update. */
+    int num_bars;
+    char **bar_ids;
+    char **bar_configs;
+};
+
+static void save_previous_config(struct previous_config *previous) {
+    previous->config = config;
+    previous->font_pattern = (config.font.pattern != NULL ? sstrdup(config.font.pattern) : NULL);
+    previous->buttons = bindings_get_buttons_to_grab();
+
+    TAILQ_INIT(&(previous->assignments));
+    while (!TAILQ_EMPTY(&assignments)) {
+        struct Assignment *assign = TAILQ_FIRST(&assignments);
+        TAILQ_REMOVE(&assignments, assign, assignments);
+        TAILQ_INSERT_TAIL(&(previous->assignments), assign, assignments);
+    }
+
+    previous->num_bars = 0;
+    Barconfig *barconfig;
+    TAILQ_FOREACH(barconfig, &barconfigs, configs) {
+        previous->num_bars++;
+    }
+    previous->bar_ids = scalloc(previous->num_bars, sizeof(char *));
+    previous->bar_configs = scalloc(previous->num_bars, sizeof(char *));
+    int i = 0;
+    TAILQ_FOREACH(barconfig, &barconfigs, configs) {
+        previous->bar_ids[i] = sstrdup(barconfig->id);
+        previous->bar_configs[i] = ipc_serialize_bar_config(barconfig);
+        i++;
+    }
+}
+
+static bool color_equals(color_t a, color_t b) {
+    return (a.red == b.red &&
+            a.green == b.green &&
+            a.blue == b.blue &&
+            a.alpha == b.alpha &&
+            a.colorpixel == b.colorpixel);
+}
+
+static bool colortriple_equals(struct Colortriple *a, struct Colortriple *b) {
+    return (color_equals(a->border, b->border) &&
+            color_equals(a->background, b->background) &&
+            color_equals(a->text, b->text) &&
+            color_equals(a->indicator, b->indicator) &&
+            color_equals(a->child_border, b->child_border));
+}
 
-    /* First ungrab the keys */
-    ungrab_all_keys(conn);
+/*
+ * Returns true if any of the options which influence how decorations and
+ * borders are drawn differs between the previous and the current config.
+ *
+ */
+static bool decoration_config_changed(struct previous_config *previous) {
+    Config *old = &(previous->config);
+    if (previous->font_pattern == NULL || config.font.pattern == NULL) {
+        if (previous->font_pattern != config.font.pattern)
+            return true;
+    } else if (strcmp(previous->font_pattern, config.font.pattern) != 0) {
+        return true;
+    }
+
+    return (!color_equals(old->client.background, config.client.background) ||
+            !colortriple_equals(&(old->client.focused), &(config.client.focused)) ||
+            !colortriple_equals(&(old->client.focused_inactive), &(config.client.focused_inactive)) ||
+            !colortriple_equals(&(old->client.unfocused), &(config.client.unfocused)) ||
+            !colortriple_equals(&(old->client.urgent), &(config.client.urgent)) ||
+            !colortriple_equals(&(old->client.placeholder), &(config.client.placeholder)) ||
+            old->show_marks != config.show_marks ||
+            old->title_align != config.title_align ||
+            old->hide_edge_borders != config.hide_edge_borders ||
+            old->smart_borders != config.smart_borders ||
+            old->smart_gaps != config.smart_gaps);
+}
+
+/*
+ * Applies the differences between the previous and the freshly loaded
+ * configuration: Only the key grabs which changed are updated, buttons are
+ * only regrabbed if the set of buttons changed, windows keep track of the
+ * unchanged assignments they already ran, decorations are only redrawn if
+ * their appearance changed and barconfig_update events are only sent for bars
+ * whose configuration changed.
+ *
+ */
+static void apply_config_changes(struct previous_config *previous) {
+    translate_keysyms();
+    update_key_grabs(conn);
+
+    int *buttons = bindings_get_buttons_to_grab();
+    int c = 0;
+    while (buttons[c] != 0 && buttons[c] == previous->buttons[c])
+        c++;
+    if (buttons[c] != previous->buttons[c]) {
+        regrab_all_buttons(conn);
+    }
+    FREE(buttons);
+    FREE(previous->buttons);
+
+    assignments_reloaded();
+    free_assignments(&(previous->assignments));
+
+    if (decoration_config_changed(previous)) {
+        DLOG("Decoration settings changed, redrawing all decorations\n");
+        Con *con;
+        TAILQ_FOREACH(con, &all_cons, all_cons) {
+            /* Invalidate pixmap caches since font or colors changed. */
+            con->deco_render_params_valid = false;
+        }
+
+        /* Redraw the currently visible decorations, so that the new drawing
+         * parameters are used. */
+        x_deco_recurse(croot);
+        xcb_flush(conn);
+    }
+    FREE(previous->font_pattern);
+
+    Barconfig *barconfig;
+    TAILQ_FOREACH(barconfig, &barconfigs, configs) {
+        int i;
+        for (i = 0; i < previous->num_bars; i++) {
+            if (strcmp(previous->bar_ids[i], barconfig->id) == 0)
+                break;
+        }
+
+        char *serialized = ipc_serialize_bar_config(barconfig);
+        if (i == previous->num_bars || strcmp(previous->bar_configs[i], serialized) != 0) {
+            ipc_send_barconfig_update_event(barconfig);
+        } else {
+            DLOG("Configuration of bar %s did not change\n", barconfig->id);
+        }
+        free(serialized);
+    }
+    for (int i = 0; i < previous->num_bars; i++) {
+        FREE(previous->bar_ids[i]);
+        FREE(previous->bar_configs[i]);
+    }
+    FREE(previous->bar_ids);
+    FREE(previous->bar_configs);
+}
+
+static void free_configuration(void) {
+    assert(conn != NULL);
 
     struct Mode *mode;
     while (!SLIST_EMPTY(&modes)) {
@@ -67,19 +237,6 @@ static void free_configuration(void) {
         FREE(mode);
     }
 
-    while (!TAILQ_EMPTY(&assignments)) {
-        struct Assignment *assign = TAILQ_FIRST(&assignments);
-        if (assign->type == A_TO_WORKSPACE || assign->type == A_TO_WORKSPACE_NUMBER)
-            FREE(assign->dest.workspace);
-        else if (assign->type == A_COMMAND)
-            FREE(assign->dest.command);
-        else if (assign->type == A_TO_OUTPUT)
-            FREE(assign->dest.output);
-        match_free(&(assign->match));
-        TAILQ_REMOVE(&assignments, assign, assignments);
-        FREE(assign);
-    }
-
     while (!TAILQ_EMPTY(&ws_assignments)) {
         struct Workspace_Assignment *assign = TAILQ_FIRST(&ws_assignments);
         FREE(assign->name);
@@ -140,17 +297,6 @@ static void free_configuration(void) {
         FREE(barconfig);
     }
 
-    Con *con;
-    TAILQ_FOREACH(con, &all_cons, all_cons) {
-        /* Assignments changed, previously ran assignments are invalid. */
-        if (con->window) {
-            con->window->nr_assignments = 0;
-            FREE(con->window->ran_assignments);
-        }
-        /* Invalidate pixmap caches in case font or colors changed. */
-        FREE(con->deco_render_params);
-    }
-
     /* Get rid of the current font */
     free_font();
 
@@ -168,11 +314,25 @@ static void free_configuration(void) {
  * load_type specifies the type of loading: C_VALIDATE is used to only verify
  * the correctness of the config file (used with the flag -C). C_LOAD will load
  * the config for normal use and display errors in the nagbar. C_RELOAD will
- * also clear the previous config.
+ * also clear the previous config and only apply what changed compared to it
+ * (key grabs, button grabs, assignments, decorations and bar configs).
  *
  */
 bool load_configuration(const char *override_configpath, config_load_t load_type) {
+    struct previous_config previous;
     if (load_type == C_RELOAD) {
+        /* If we are currently in a binding mode, we first revert to the
+         * default since we have no guarantee that the current mode will even
+         * still exist after parsing the config again. See #2228. */
+        struct Mode *mode;
+        SLIST_FOREACH(mode, &modes, modes) {
+            if (mode->bindings == bindings && strcmp(mode->name, DEFAULT_BINDING_MODE) != 0) {
+                switch_mode(DEFAULT_BINDING_MODE);
+                break;
+            }
+        }
+
+        save_previous_config(&previous);
         free_configuration();
     }
 
@@ -251,14 +411,7 @@ bool load_configuration(const char *override_configpath, config_load_t load_type
     }
 
     if (load_type == C_RELOAD) {
-        translate_keysyms();
-        grab_all_keys(conn);
-        regrab_all_buttons(conn);
-
-        /* Redraw the currently visible decorations on reload, so that the
-         * possibly new drawing parameters changed. */
-        x_deco_recurse(croot);
-        xcb_flush(conn);
+        apply_config_changes(&previous);
     }
 
     return result;
@@ -645,6 +645,10 @@ CFGFUN(ipc_kill_timeout, const long timeout_ms) {
     ipc_set_kill_timeout(timeout_ms / 1000.0);
 }
 
+CFGFUN(ipc_max_pending, const long bytes) {
+    ipc_set_max_pending(bytes > 0 ? (size_t)bytes : 0);
+}
+
 /*******************************************************************************
  * Bar configuration (i3bar)
  ******************************************************************************/
@@ -25,6 +25,7 @@
  */
 #include "all.h"
 
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -35,6 +36,8 @@
 #include <sys/wait.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <inttypes.h>
+#include <sys/mman.h>
 #include <xcb/xcb_xrm.h>
 
 // Macros to make the YAJL API a bit easier to use.
@@ -61,6 +64,9 @@ static struct context *context;
 typedef struct token {
     char *name;
     char *identifier;
+    cmdp_token_kind kind;
+    /* For literals: the length of the literal (without the leading quote). */
+    uint16_t literal_len;
     /* This might be __CALL */
     cmdp_state next_state;
     union {
@@ -68,9 +74,20 @@ typedef struct token {
     } extra;
 } cmdp_token;
 
+/* A node of the per-state trie of (lowercased) literals. Index 0 is the root,
+ * and 0 is used as "no node" for child and sibling. */
+typedef struct trie_node {
+    char c;
+    uint16_t child;
+    uint16_t sibling;
+    /* Index of the first token whose literal ends at this node, or -1. */
+    int16_t token;
+} cmdp_trie_node;
+
 typedef struct tokenptr {
     cmdp_token *array;
     int n;
+    const cmdp_trie_node *trie;
 } cmdp_token_ptr;
 
 #include "GENERATED_config_tokens.h"
@@ -179,6 +196,31 @@ static void clear_stack(void) {
     }
 }
 
+/*
+ * Returns the index of the first token in the current state whose literal
+ * matches the beginning of walk (case-insensitively), or -1 if no literal
+ * matches. The trie is walked once, so the cost only depends on the length
+ * of the longest matching literal, not on the number of literals.
+ *
+ */
+static int find_literal(const cmdp_token_ptr *ptr, const char *walk) {
+    const cmdp_trie_node *trie = ptr->trie;
+    int result = -1;
+    uint16_t node = trie[0].child;
+    while (node != 0 && *walk != '\0') {
+        const char c = (*walk >= 'A' && *walk <= 'Z' ? *walk - 'A' + 'a' : *walk);
+        while (node != 0 && trie[node].c != c)
+            node = trie[node].sibling;
+        if (node == 0)
+            break;
+        if (trie[node].token != -1 && (result == -1 || trie[node].token < result))
+            result = trie[node].token;
+        node = trie[node].child;
+        walk++;
+    }
+    return result;
+}
+
 /*******************************************************************************
  * The parser itself.
  ******************************************************************************/
@@ -199,12 +241,97 @@ static int statelist_idx = 1;
 
 #include "GENERATED_config_call.h"
 
+#ifndef TEST_PARSER
+/*******************************************************************************
+ * Recording of the config cache (see parse_file()). While parsing, every call
+ * of a configuration directive is recorded together with its arguments, so
+ * that it can be replayed without parsing the file again.
+ ******************************************************************************/
+
+/* Record tag for the re-initialization of the criteria at the beginning of
+ * every line (all other tags are call identifiers of GENERATED_call()). */
+#define CACHE_CRITERIA_INIT UINT32_MAX
+
+struct cache_buffer {
+    char *data;
+    size_t len;
+    size_t size;
+};
+
+/* The recording of the config which is currently parsed, or NULL. */
+static struct cache_recording {
+    struct cache_buffer resources;
+    uint32_t num_resources;
+    struct cache_buffer records;
+    uint32_t num_records;
+    bool last_was_criteria_init;
+} *recording;
+
+static void cache_append(struct cache_buffer *buffer, const void *data, size_t len) {
+    if (buffer->len + len > buffer->size) {
+        buffer->size = (buffer->size == 0 ? 4096 : buffer->size);
+        while (buffer->len + len > buffer->size)
+            buffer->size *= 2;
+        buffer->data = srealloc(buffer->data, buffer->size);
+    }
+    memcpy(buffer->data + buffer->len, data, len);
+    buffer->len += len;
+}
+
+static void cache_append_u32(struct cache_buffer *buffer, uint32_t value) {
+    cache_append(buffer, &value, sizeof(value));
+}
+
+/* Strings are stored with their length and the terminating 0-byte, so that
+ * they can be used directly from the mapped cache file. */
+static void cache_append_string(struct cache_buffer *buffer, const char *str) {
+    const uint32_t len = strlen(str);
+    cache_append_u32(buffer, len);
+    cache_append(buffer, str, len + 1);
+}
+
+/*
+ * Records a call of GENERATED_call() with the current contents of the stack.
+ *
+ */
+static void cache_record_call(uint32_t tag) {
+    if (recording == NULL)
+        return;
+
+    /* Consecutive criteria initializations have the same effect as one. */
+    if (tag == CACHE_CRITERIA_INIT && recording->last_was_criteria_init)
+        return;
+    recording->last_was_criteria_init = (tag == CACHE_CRITERIA_INIT);
+
+    uint32_t num_entries = 0;
+    while (tag != CACHE_CRITERIA_INIT && num_entries < 10 && stack[num_entries].identifier != NULL)
+        num_entries++;
+
+    cache_append_u32(&(recording->records), tag);
+    cache_append_u32(&(recording->records), num_entries);
+    for (uint32_t c = 0; c < num_entries; c++) {
+        cache_append_u32(&(recording->records), stack[c].type);
+        cache_append_string(&(recording->records), stack[c].identifier);
+        if (stack[c].type == STACK_STR) {
+            cache_append_string(&(recording->records), stack[c].val.str);
+        } else {
+            const int64_t num = stack[c].val.num;
+            cache_append(&(recording->records), &num, sizeof(num));
+        }
+    }
+    recording->num_records++;
+}
+#endif
+
 static void next_state(const cmdp_token *token) {
     cmdp_state _next_state = token->next_state;
 
     //printf("token = name %s identifier %s\n", token->name, token->identifier);
     //printf("next_state = %d\n", token->next_state);
     if (token->next_state == __CALL) {
+#ifndef TEST_PARSER
+        cache_record_call(token->extra.call_identifier);
+#endif
         subcommand_output.json_gen = command_output.json_gen;
         GENERATED_call(token->extra.call_identifier, &subcommand_output);
         _next_state = subcommand_output.next_state;
@@ -289,6 +416,7 @@ struct ConfigResultIR *parse_config(const char *input, struct context *context)
 
 // TODO: make this testable
 #ifndef TEST_PARSER
+    cache_record_call(CACHE_CRITERIA_INIT);
     cfg_criteria_init(&current_match, &subcommand_output, INITIAL);
 #endif
 
@@ -303,16 +431,17 @@ struct ConfigResultIR *parse_config(const char *input, struct context *context)
         //printf("remaining input: %s\n", walk);
 
         cmdp_token_ptr *ptr = &(tokens[state]);
+        const int literal = find_literal(ptr, walk);
         token_handled = false;
         for (c = 0; c < ptr->n; c++) {
             token = &(ptr->array[c]);
 
             /* A literal. */
-            if (token->name[0] == '\'') {
-                if (strncasecmp(walk, token->name + 1, strlen(token->name) - 1) == 0) {
+            if (token->kind == TOKEN_LITERAL) {
+                if (c == literal) {
                     if (token->identifier != NULL)
                         push_string(token->identifier, token->name + 1);
-                    walk += strlen(token->name) - 1;
+                    walk += token->literal_len;
                     next_state(token);
                     token_handled = true;
                     break;
@@ -320,7 +449,7 @@ struct ConfigResultIR *parse_config(const char *input, struct context *context)
                 continue;
             }
 
-            if (strcmp(token->name, "number") == 0) {
+            if (token->kind == TOKEN_NUMBER) {
                 /* Handle numbers. We only accept decimal numbers for now. */
                 char *end = NULL;
                 errno = 0;
@@ -343,8 +472,7 @@ struct ConfigResultIR *parse_config(const char *input, struct context *context)
                 break;
             }
 
-            if (strcmp(token->name, "string") == 0 ||
-                strcmp(token->name, "word") == 0) {
+            if (token->kind == TOKEN_STRING || token->kind == TOKEN_WORD) {
                 const char *beginning = walk;
                 /* Handle quoted strings (or words). */
                 if (*walk == '"') {
@@ -353,7 +481,7 @@ struct ConfigResultIR *parse_config(const char *input, struct context *context)
                     while (*walk != '\0' && (*walk != '"' || *(walk - 1) == '\\'))
                         walk++;
                 } else {
-                    if (token->name[0] == 's') {
+                    if (token->kind == TOKEN_STRING) {
                         while (*walk != '\0' && *walk != '\r' && *walk != '\n')
                             walk++;
                     } else {
@@ -394,7 +522,7 @@ struct ConfigResultIR *parse_config(const char *input, struct context *context)
                 }
             }
 
-            if (strcmp(token->name, "line") == 0) {
+            if (token->kind == TOKEN_LINE) {
                 while (*walk != '\0' && *walk != '\n' && *walk != '\r')
                     walk++;
                 next_state(token);
@@ -404,7 +532,7 @@ struct ConfigResultIR *parse_config(const char *input, struct context *context)
                 break;
             }
 
-            if (strcmp(token->name, "end") == 0) {
+            if (token->kind == TOKEN_END) {
                 //printf("checking for end: *%s*\n", walk);
                 if (*walk == '\0' || *walk == '\n' || *walk == '\r') {
                     next_state(token);
@@ -415,6 +543,7 @@ struct ConfigResultIR *parse_config(const char *input, struct context *context)
                      * every command. */
 // TODO: make this testable
 #ifndef TEST_PARSER
+                    cache_record_call(CACHE_CRITERIA_INIT);
                     cfg_criteria_init(&current_match, &subcommand_output, INITIAL);
 #endif
                     linecnt++;
@@ -439,7 +568,7 @@ struct ConfigResultIR *parse_config(const char *input, struct context *context)
             char *tokenwalk = possible_tokens;
             for (c = 0; c < ptr->n; c++) {
                 token = &(ptr->array[c]);
-                if (token->name[0] == '\'') {
+                if (token->kind == TOKEN_LITERAL) {
                     /* A literal is copied to the error message enclosed with
                      * single quotes. */
                     *tokenwalk++ = '\'';
@@ -449,7 +578,7 @@ struct ConfigResultIR *parse_config(const char *input, struct context *context)
                 } else {
                     /* Skip error tokens in error messages, they are used
                      * internally only and might confuse users. */
-                    if (strcmp(token->name, "error") == 0)
+                    if (token->kind == TOKEN_ERROR)
                         continue;
                     /* Any other token is copied to the error message enclosed
                      * with angle brackets. */
@@ -546,7 +675,7 @@ struct ConfigResultIR *parse_config(const char *input, struct context *context)
             for (int i = statelist_idx - 1; (i >= 0) && !error_token_found; i--) {
                 cmdp_token_ptr *errptr = &(tokens[statelist[i]]);
                 for (int j = 0; j < errptr->n; j++) {
-                    if (strcmp(errptr->array[j].name, "error") != 0)
+                    if (errptr->array[j].kind != TOKEN_ERROR)
                         continue;
                     next_state(&(errptr->array[j]));
                     error_token_found = true;
@@ -563,6 +692,189 @@ struct ConfigResultIR *parse_config(const char *input, struct context *context)
     return &command_output;
 }
 
+/*******************************************************************************
+ * Variable expansion. Variables are collected by parse_file() and replaced in
+ * a single pass over the whole file afterwards.
+ ******************************************************************************/
+
+#if !defined(TEST_PARSER) || defined(BENCH_PARSER)
+
+/*
+ * Inserts or updates a variable assignment depending on whether it already exists.
+ *
+ */
+static void upsert_variable(struct variables_head *variables, char *key, char *value) {
+    struct Variable *current;
+    SLIST_FOREACH(current, variables, variables) {
+        if (strcmp(current->key, key) != 0) {
+            continue;
+        }
+
+        DLOG("Updated variable: %s = %s -> %s\n", key, current->value, value);
+        FREE(current->value);
+        current->value = sstrdup(value);
+        return;
+    }
+
+    DLOG("Defined new variable: %s = %s\n", key, value);
+    struct Variable *new = scalloc(1, sizeof(struct Variable));
+    new->key = sstrdup(key);
+    new->value = sstrdup(value);
+    /* The most recently defined variable takes precedence over older ones
+     * which only differ in case, see build_variable_trie(). */
+    SLIST_INSERT_HEAD(variables, new, variables);
+}
+
+/*
+ * Frees all variables of the given list.
+ *
+ */
+static void free_variables(struct variables_head *variables) {
+    while (!SLIST_EMPTY(variables)) {
+        struct Variable *current = SLIST_FIRST(variables);
+        FREE(current->key);
+        FREE(current->value);
+        SLIST_REMOVE_HEAD(variables, variables);
+        FREE(current);
+    }
+}
+
+/*
+ * A node of the trie of lowercased variable names. Children are kept in a
+ * singly-linked list since variable names rarely share more than their first
+ * few characters.
+ *
+ */
+struct variable_trie {
+    unsigned char c;
+    /* The variable whose (lowercased) name ends at this node, if any. */
+    struct Variable *variable;
+    struct variable_trie *children;
+    struct variable_trie *next;
+};
+
+/*
+ * Builds a trie of the lowercased names of all given variables. Variables are
+ * matched case-insensitively, so if two names only differ in case, the one
+ * closer to the head of the list (the one defined last) wins.
+ *
+ */
+static struct variable_trie *build_variable_trie(struct variables_head *variables) {
+    struct variable_trie *root = scalloc(1, sizeof(struct variable_trie));
+    struct Variable *current;
+    SLIST_FOREACH(current, variables, variables) {
+        struct variable_trie *node = root;
+        for (const char *walk = current->key; *walk != '\0'; walk++) {
+            const unsigned char c = tolower((unsigned char)*walk);
+            struct variable_trie *child = node->children;
+            while (child != NULL && child->c != c) {
+                child = child->next;
+            }
+            if (child == NULL) {
+                child = scalloc(1, sizeof(struct variable_trie));
+                child->c = c;
+                child->next = node->children;
+                node->children = child;
+            }
+            node = child;
+        }
+        if (node->variable == NULL) {
+            node->variable = current;
+        }
+    }
+    return root;
+}
+
+static void free_variable_trie(struct variable_trie *node) {
+    while (node != NULL) {
+        struct variable_trie *next = node->next;
+        free_variable_trie(node->children);
+        free(node);
+        node = next;
+    }
+}
+
+/*
+ * Returns the variable with the longest name which (case-insensitively)
+ * matches at the beginning of walk, or NULL if there is none.
+ *
+ */
+static struct Variable *match_variable(const struct variable_trie *root, const char *walk, const char *end) {
+    struct Variable *longest = NULL;
+    const struct variable_trie *node = root;
+    while (walk < end) {
+        const unsigned char c = tolower((unsigned char)*walk);
+        const struct variable_trie *child = node->children;
+        while (child != NULL && child->c != c) {
+            child = child->next;
+        }
+        if (child == NULL) {
+            break;
+        }
+        node = child;
+        if (node->variable != NULL) {
+            longest = node->variable;
+        }
+        walk++;
+    }
+    return longest;
+}
+
+/*
+ * Returns a newly allocated copy of the first len bytes of input in which
+ * every occurrence of a variable has been replaced by its value. At each
+ * position, the longest matching variable name is replaced.
+ *
+ * The input is only walked once: since all variable names start with '$', we
+ * skip to the next '$' and look up the name at that position in a trie, so
+ * this takes time linear in the size of the input, independent of the number
+ * of variables.
+ *
+ */
+static char *expand_variables(const char *input, size_t len, struct variables_head *variables) {
+    struct variable_trie *trie = build_variable_trie(variables);
+    const char *walk = input;
+    const char *end = input + len;
+    size_t size = len + 1;
+    size_t used = 0;
+    char *result = smalloc(size);
+
+    while (walk < end) {
+        const char *dollar = memchr(walk, '$', end - walk);
+        const char *next = (dollar != NULL ? dollar : end);
+        struct Variable *variable = NULL;
+        if (dollar != NULL) {
+            variable = match_variable(trie, dollar, end);
+            /* Not a variable, copy the '$' verbatim. */
+            if (variable == NULL)
+                next++;
+        }
+
+        /* Copy everything up to the variable, then its value. */
+        const size_t plain_len = next - walk;
+        const size_t value_len = (variable != NULL ? strlen(variable->value) : 0);
+        if (used + plain_len + value_len + 1 > size) {
+            while (used + plain_len + value_len + 1 > size)
+                size *= 2;
+            result = srealloc(result, size);
+        }
+        memcpy(result + used, walk, plain_len);
+        used += plain_len;
+        walk = next;
+        if (variable != NULL) {
+            memcpy(result + used, variable->value, value_len);
+            used += value_len;
+            walk += strlen(variable->key);
+        }
+    }
+    result[used] = '\0';
+
+    free_variable_trie(trie);
+    return result;
+}
+
+#endif
+
 /*******************************************************************************
  * Code for building the stand-alone binary test.commands_parser which is used
  * by t/187-commands-parser.t.
@@ -606,6 +918,7 @@ void cfg_criteria_pop_state(I3_CFG) {
     result->next_state = criteria_next_state;
 }
 
+#ifndef BENCH_PARSER
 int main(int argc, char *argv[]) {
     if (argc < 2) {
         fprintf(stderr, "Syntax: %s <command>\n", argv[0]);
@@ -615,6 +928,99 @@ int main(int argc, char *argv[]) {
     context.filename = "<stdin>";
     parse_config(argv[1], &context);
 }
+#else
+/*
+ * Appends the formatted string to the buffer at *buf (of *size bytes, *len of
+ * which are used), growing it as necessary.
+ *
+ */
+__attribute__((format(printf, 4, 5))) static void bench_append(char **buf, size_t *len, size_t *size, const char *fmt, ...) {
+    va_list args;
+    while (true) {
+        va_start(args, fmt);
+        const int written = vsnprintf(*buf + *len, *size - *len, fmt, args);
+        va_end(args);
+        if (*len + written < *size) {
+            *len += written;
+            return;
+        }
+        *size *= 2;
+        *buf = srealloc(*buf, *size);
+    }
+}
+
+/*
+ * Stand-alone microbenchmark bench.config_parser: generates a synthetic
+ * configuration file with the given number of variables and lines (each line
+ * referring to a few variables) and prints the average time it takes to expand
+ * the variables and to parse the result. The debug output of the parser is
+ * sent to /dev/null so that only the parser itself is measured.
+ *
+ */
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        fprintf(stderr, "Syntax: %s <iterations> <variables> <lines>\n", argv[0]);
+        return 1;
+    }
+    const long iterations = strtol(argv[1], NULL, 10);
+    const long num_variables = strtol(argv[2], NULL, 10);
+    const long num_lines = strtol(argv[3], NULL, 10);
+    if (num_variables < 1) {
+        fprintf(stderr, "At least one variable is required\n");
+        return 1;
+    }
+
+    struct variables_head variables = SLIST_HEAD_INITIALIZER(&variables);
+    size_t size = 4096, len = 0;
+    char *config = smalloc(size);
+    config[0] = '\0';
+    for (long i = 0; i < num_variables; i++) {
+        char key[32], value[64];
+        snprintf(key, sizeof(key), "$var%ld", i);
+        snprintf(value, sizeof(value), "value-of-variable-%ld", i);
+        bench_append(&config, &len, &size, "set %s %s\n", key, value);
+        upsert_variable(&variables, key, value);
+    }
+    for (long i = 0; i < num_lines; i++) {
+        bench_append(&config, &len, &size, "bindsym Mod1+$var%ld exec --no-startup-id $var%ld --title $var%ld\n",
+                     i % num_variables, (i * 7) % num_variables, (i * 13) % num_variables);
+    }
+
+    if (freopen("/dev/null", "w", stderr) == NULL) {
+        perror("freopen");
+        return 1;
+    }
+    FILE *out = fdopen(dup(STDOUT_FILENO), "w");
+    if (out == NULL || freopen("/dev/null", "w", stdout) == NULL) {
+        perror("freopen");
+        return 1;
+    }
+
+    struct context context = {.filename = "<bench>"};
+    double expand_ns = 0, parse_ns = 0;
+    for (long i = 0; i < iterations; i++) {
+        struct timespec start, middle, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        char *expanded = expand_variables(config, len, &variables);
+        clock_gettime(CLOCK_MONOTONIC, &middle);
+        struct ConfigResultIR *result = parse_config(expanded, &context);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        yajl_gen_free(result->json_gen);
+        free(expanded);
+
+        expand_ns += (middle.tv_sec - start.tv_sec) * 1e9 + (middle.tv_nsec - start.tv_nsec);
+        parse_ns += (end.tv_sec - middle.tv_sec) * 1e9 + (end.tv_nsec - middle.tv_nsec);
+    }
+
+    fprintf(out, "%zu bytes, %ld variables, %ld lines\n", len, num_variables, num_lines);
+    fprintf(out, "%10.3f ms  expand variables\n", (iterations > 0 ? expand_ns / iterations / 1e6 : 0));
+    fprintf(out, "%10.3f ms  parse\n", (iterations > 0 ? parse_ns / iterations / 1e6 : 0));
+    fclose(out);
+    free(config);
+    free_variables(&variables);
+    return 0;
+}
+#endif
 
 #else
 
@@ -814,43 +1220,6 @@ void start_config_error_nagbar(const char *configpath, bool has_errors) {
     free(pageraction);
 }
 
-/*
- * Inserts or updates a variable assignment depending on whether it already exists.
- *
- */
-static void upsert_variable(struct variables_head *variables, char *key, char *value) {
-    struct Variable *current;
-    SLIST_FOREACH(current, variables, variables) {
-        if (strcmp(current->key, key) != 0) {
-            continue;
-        }
-
-        DLOG("Updated variable: %s = %s -> %s\n", key, current->value, value);
-        FREE(current->value);
-        current->value = sstrdup(value);
-        return;
-    }
-
-    DLOG("Defined new variable: %s = %s\n", key, value);
-    struct Variable *new = scalloc(1, sizeof(struct Variable));
-    struct Variable *test = NULL, *loc = NULL;
-    new->key = sstrdup(key);
-    new->value = sstrdup(value);
-    /* ensure that the correct variable is matched in case of one being
-     * the prefix of another */
-    SLIST_FOREACH(test, variables, variables) {
-        if (strlen(new->key) >= strlen(test->key))
-            break;
-        loc = test;
-    }
-
-    if (loc == NULL) {
-        SLIST_INSERT_HEAD(variables, new, variables);
-    } else {
-        SLIST_INSERT_AFTER(loc, new, variables);
-    }
-}
-
 static char *get_resource(char *name) {
     if (conn == NULL) {
         return NULL;
@@ -876,6 +1245,287 @@ static char *get_resource(char *name) {
     return resource;
 }
 
+/*******************************************************************************
+ * The config cache (enabled with --config-cache). After a config was parsed
+ * without errors, the recorded directives are stored in the runtime directory,
+ * keyed by a hash of the i3 version, the parser tables, the path and the
+ * contents of the config file. The next time the same config is loaded, the
+ * directives are replayed from the mapped cache file instead of expanding the
+ * variables and parsing the config. The values of the X resources used by the
+ * config are stored as well and checked before using the cache.
+ ******************************************************************************/
+
+#define CACHE_MAGIC "i3cache1"
+
+struct config_cache_stats config_cache_stats;
+
+struct cache_header {
+    char magic[8];
+    uint64_t key;
+    uint32_t num_resources;
+    uint32_t num_records;
+};
+
+struct cache_reader {
+    const char *walk;
+    const char *end;
+    bool failed;
+};
+
+/*
+ * Returns the number of different calls the parser can make. If hash is not
+ * NULL, all token tables are hashed into it, so that the cache is not used
+ * with a different parser specification.
+ *
+ */
+static uint32_t parser_fingerprint(uint64_t *hash) {
+    uint32_t num_calls = 0;
+    for (size_t i = 0; i < sizeof(tokens) / sizeof(tokens[0]); i++) {
+        for (int c = 0; c < tokens[i].n; c++) {
+            const cmdp_token *token = &(tokens[i].array[c]);
+            if (hash != NULL) {
+                *hash = fnv1a_64(*hash, token->name, strlen(token->name) + 1);
+                *hash = fnv1a_64(*hash, token->identifier, strlen(token->identifier) + 1);
+                *hash = fnv1a_64(*hash, &(token->next_state), sizeof(token->next_state));
+            }
+            if (token->next_state != __CALL)
+                continue;
+            if (hash != NULL)
+                *hash = fnv1a_64(*hash, &(token->extra.call_identifier), sizeof(token->extra.call_identifier));
+            if (token->extra.call_identifier >= num_calls)
+                num_calls = token->extra.call_identifier + 1;
+        }
+    }
+    return num_calls;
+}
+
+static uint64_t config_cache_key(const char *path, const char *contents, size_t len) {
+    uint64_t hash = FNV1A_64_OFFSET_BASIS;
+    hash = fnv1a_64(hash, i3_version, strlen(i3_version) + 1);
+    parser_fingerprint(&hash);
+    hash = fnv1a_64(hash, path, strlen(path) + 1);
+    return fnv1a_64(hash, contents, len);
+}
+
+/*
+ * Returns the path of the cache file for the given config file, or NULL if
+ * there is no runtime directory to store it in.
+ *
+ */
+static char *config_cache_path(const char *configpath) {
+    const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+    if (runtime_dir == NULL) {
+        DLOG("XDG_RUNTIME_DIR is not set, not using the config cache\n");
+        return NULL;
+    }
+
+    char *path;
+    sasprintf(&path, "%s/i3", runtime_dir);
+    if (mkdir(path, 0700) == -1 && errno != EEXIST) {
+        ELOG("Could not create \"%s\" for the config cache: %s\n", path, strerror(errno));
+        free(path);
+        return NULL;
+    }
+    free(path);
+
+    sasprintf(&path, "%s/i3/config-cache.%016" PRIx64, runtime_dir,
+              fnv1a_64(FNV1A_64_OFFSET_BASIS, configpath, strlen(configpath)));
+    return path;
+}
+
+static const char *cache_read(struct cache_reader *reader, size_t len) {
+    if (reader->failed || (size_t)(reader->end - reader->walk) < len) {
+        reader->failed = true;
+        return NULL;
+    }
+    const char *result = reader->walk;
+    reader->walk += len;
+    return result;
+}
+
+static uint32_t cache_read_u32(struct cache_reader *reader) {
+    uint32_t value = 0;
+    const char *data = cache_read(reader, sizeof(value));
+    if (data != NULL)
+        memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static const char *cache_read_string(struct cache_reader *reader) {
+    const uint32_t len = cache_read_u32(reader);
+    const char *str = cache_read(reader, (size_t)len + 1);
+    if (str != NULL && str[len] != '\0') {
+        reader->failed = true;
+        return NULL;
+    }
+    return str;
+}
+
+/*
+ * Returns true if all X resources recorded in the cache still have the same
+ * value (or are still missing).
+ *
+ */
+static bool cache_resources_unchanged(struct cache_reader *reader, uint32_t num_resources) {
+    bool unchanged = true;
+    for (uint32_t i = 0; i < num_resources && unchanged; i++) {
+        const uint32_t found = cache_read_u32(reader);
+        const char *name = cache_read_string(reader);
+        const char *value = cache_read_string(reader);
+        if (reader->failed)
+            return false;
+
+        char *current = get_resource((char *)name);
+        unchanged = (found == (current != NULL) &&
+                     (current == NULL || strcmp(current, value) == 0));
+        free(current);
+    }
+
+    if (database != NULL) {
+        xcb_xrm_database_free(database);
+        database = NULL;
+    }
+
+    return unchanged;
+}
+
+/*
+ * Walks through the recorded directives. If apply is false, they are only
+ * checked for validity, otherwise they are replayed just like the parser
+ * would call them.
+ *
+ */
+static bool cache_replay(struct cache_reader *reader, uint32_t num_records, bool apply) {
+    const uint32_t num_calls = parser_fingerprint(NULL);
+    for (uint32_t i = 0; i < num_records; i++) {
+        const uint32_t tag = cache_read_u32(reader);
+        const uint32_t num_entries = cache_read_u32(reader);
+        if (reader->failed || num_entries > 10 ||
+            (tag == CACHE_CRITERIA_INIT ? num_entries != 0 : tag >= num_calls))
+            return false;
+
+        for (uint32_t c = 0; c < num_entries; c++) {
+            const uint32_t type = cache_read_u32(reader);
+            const char *identifier = cache_read_string(reader);
+            if (type == STACK_STR) {
+                const char *str = cache_read_string(reader);
+                if (apply && !reader->failed)
+                    push_string(identifier, str);
+            } else if (type == STACK_LONG) {
+                int64_t num = 0;
+                const char *data = cache_read(reader, sizeof(num));
+                if (data != NULL)
+                    memcpy(&num, data, sizeof(num));
+                if (apply && !reader->failed)
+                    push_long(identifier, num);
+            } else {
+                return false;
+            }
+        }
+        if (reader->failed)
+            return false;
+
+        if (!apply)
+            continue;
+
+        if (tag == CACHE_CRITERIA_INIT) {
+            cfg_criteria_init(&current_match, &subcommand_output, INITIAL);
+        } else {
+            subcommand_output.json_gen = NULL;
+            GENERATED_call(tag, &subcommand_output);
+            clear_stack();
+        }
+    }
+    return (reader->walk == reader->end);
+}
+
+/*
+ * Applies the cached config at the given path if it was stored for the given
+ * key and the X resources it uses did not change. Returns false (without
+ * changing anything) if the config needs to be parsed.
+ *
+ */
+static bool config_cache_apply(const char *path, uint64_t key) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        DLOG("No config cache at %s\n", path);
+        return false;
+    }
+
+    struct stat stbuf;
+    if (fstat(fd, &stbuf) == -1 || (size_t)stbuf.st_size < sizeof(struct cache_header)) {
+        close(fd);
+        return false;
+    }
+
+    const char *data = mmap(NULL, stbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        ELOG("Could not mmap config cache %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    struct cache_header header;
+    memcpy(&header, data, sizeof(header));
+    struct cache_reader reader = {data + sizeof(header), data + stbuf.st_size, false};
+    bool result = false;
+    if (memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0 || header.key != key) {
+        DLOG("Config cache %s was stored for a different config\n", path);
+    } else if (!cache_resources_unchanged(&reader, header.num_resources)) {
+        DLOG("X resources used by the config changed, not using the config cache\n");
+    } else {
+        /* Check all records before replaying any of them, so that a damaged
+         * cache file cannot lead to a partially applied config. */
+        struct cache_reader records = reader;
+        if (cache_replay(&records, header.num_records, false)) {
+            cache_replay(&reader, header.num_records, true);
+            result = true;
+        } else {
+            ELOG("Config cache %s is damaged, ignoring it\n", path);
+        }
+    }
+
+    munmap((void *)data, stbuf.st_size);
+    return result;
+}
+
+/*
+ * Stores the recorded directives of the config which was just parsed in the
+ * cache file at the given path.
+ *
+ */
+static void config_cache_save(const char *path, uint64_t key) {
+    struct cache_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.key = key;
+    header.num_resources = recording->num_resources;
+    header.num_records = recording->num_records;
+
+    /* Write to a temporary file first, so that other i3 instances never see
+     * a partially written cache file. */
+    char *tmppath;
+    sasprintf(&tmppath, "%s.%d", path, getpid());
+    FILE *fp = fopen(tmppath, "w");
+    if (fp == NULL) {
+        ELOG("Could not create config cache %s: %s\n", tmppath, strerror(errno));
+        free(tmppath);
+        return;
+    }
+
+    const bool written = (fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                          fwrite(recording->resources.data, 1, recording->resources.len, fp) == recording->resources.len &&
+                          fwrite(recording->records.data, 1, recording->records.len, fp) == recording->records.len);
+    if (fclose(fp) != 0 || !written || rename(tmppath, path) != 0) {
+        ELOG("Could not write config cache %s: %s\n", path, strerror(errno));
+        unlink(tmppath);
+    } else {
+        DLOG("Stored %u directives in config cache %s\n", header.num_records, path);
+        config_cache_stats.stores++;
+    }
+    free(tmppath);
+}
+
 /*
  * Parses the given file by first replacing the variables, then calling
  * parse_config and possibly launching i3-nagbar.
@@ -888,6 +1538,10 @@ bool parse_file(const char *f, bool use_nagbar) {
     char *buf;
     FILE *fstr;
     char buffer[4096], key[512], value[4096], *continuation = NULL;
+    size_t buf_len = 0;
+    char *new = NULL;
+    int version = 4;
+    bool invalid_sets = false;
 
     if ((fd = open(f, O_RDONLY)) == -1)
         die("Could not open configuration file: %s\n", strerror(errno));
@@ -907,7 +1561,23 @@ bool parse_file(const char *f, bool use_nagbar) {
     }
     rewind(fstr);
 
-    bool invalid_sets = false;
+    context = scalloc(1, sizeof(struct context));
+    context->filename = f;
+
+    /* Validating the config (-C) always parses it. */
+    char *cache_path = NULL;
+    uint64_t cache_key = 0;
+    if (use_config_cache && use_nagbar && (cache_path = config_cache_path(f)) != NULL) {
+        cache_key = config_cache_key(f, current_config, stbuf.st_size);
+        if (config_cache_apply(cache_path, cache_key)) {
+            LOG("Applied the cached configuration %s\n", cache_path);
+            config_cache_stats.hits++;
+            fclose(fstr);
+            goto parsed;
+        }
+        config_cache_stats.misses++;
+        recording = scalloc(1, sizeof(struct cache_recording));
+    }
 
     while (!feof(fstr)) {
         if (!continuation)
@@ -936,7 +1606,11 @@ bool parse_file(const char *f, bool use_nagbar) {
             continuation = NULL;
         }
 
-        strncpy(buf + strlen(buf), buffer, strlen(buffer) + 1);
+        /* Keep track of the length so that appending does not need to walk
+         * the whole buffer for every line. */
+        const size_t line_len = strlen(buffer);
+        memcpy(buf + buf_len, buffer, line_len + 1);
+        buf_len += line_len;
 
         /* Skip comments and empty lines. */
         if (skip_line || comment) {
@@ -987,6 +1661,12 @@ bool parse_file(const char *f, bool use_nagbar) {
             }
 
             char *res_value = get_resource(res_name);
+            if (recording != NULL) {
+                cache_append_u32(&(recording->resources), res_value != NULL);
+                cache_append_string(&(recording->resources), res_name);
+                cache_append_string(&(recording->resources), (res_value != NULL ? res_value : ""));
+                recording->num_resources++;
+            }
             if (res_value == NULL) {
                 DLOG("Could not get resource '%s', using fallback '%s'.\n", res_name, fallback);
                 res_value = sstrdup(fallback);
@@ -1005,64 +1685,12 @@ bool parse_file(const char *f, bool use_nagbar) {
         database = NULL;
     }
 
-    /* For every custom variable, see how often it occurs in the file and
-     * how much extra bytes it requires when replaced. */
-    struct Variable *current, *nearest;
-    int extra_bytes = 0;
-    /* We need to copy the buffer because we need to invalidate the
-     * variables (otherwise we will count them twice, which is bad when
-     * 'extra' is negative) */
-    char *bufcopy = sstrdup(buf);
-    SLIST_FOREACH(current, &variables, variables) {
-        int extra = (strlen(current->value) - strlen(current->key));
-        char *next;
-        for (next = bufcopy;
-             next < (bufcopy + stbuf.st_size) &&
-             (next = strcasestr(next, current->key)) != NULL;
-             next += strlen(current->key)) {
-            *next = '_';
-            extra_bytes += extra;
-        }
-    }
-    FREE(bufcopy);
-
-    /* Then, allocate a new buffer and copy the file over to the new one,
-     * but replace occurrences of our variables */
-    char *walk = buf, *destwalk;
-    char *new = scalloc(stbuf.st_size + extra_bytes + 1, 1);
-    destwalk = new;
-    while (walk < (buf + stbuf.st_size)) {
-        /* Find the next variable */
-        SLIST_FOREACH(current, &variables, variables)
-        current->next_match = strcasestr(walk, current->key);
-        nearest = NULL;
-        int distance = stbuf.st_size;
-        SLIST_FOREACH(current, &variables, variables) {
-            if (current->next_match == NULL)
-                continue;
-            if ((current->next_match - walk) < distance) {
-                distance = (current->next_match - walk);
-                nearest = current;
-            }
-        }
-        if (nearest == NULL) {
-            /* If there are no more variables, we just copy the rest */
-            strncpy(destwalk, walk, (buf + stbuf.st_size) - walk);
-            destwalk += (buf + stbuf.st_size) - walk;
-            *destwalk = '\0';
-            break;
-        } else {
-            /* Copy until the next variable, then copy its value */
-            strncpy(destwalk, walk, distance);
-            strncpy(destwalk + distance, nearest->value, strlen(nearest->value));
-            walk += distance + strlen(nearest->key);
-            destwalk += distance + strlen(nearest->value);
-        }
-    }
+    /* Replace all occurrences of our variables in a single pass. */
+    new = expand_variables(buf, buf_len, &variables);
 
     /* analyze the string to find out whether this is an old config file (3.x)
      * or a new config file (4.x). If it’s old, we run the converter script. */
-    int version = detect_version(buf);
+    version = detect_version(buf);
     if (version == 3) {
         /* We need to convert this v3 configuration */
         char *converted = migrate_config(new, strlen(new));
@@ -1088,16 +1716,25 @@ bool parse_file(const char *f, bool use_nagbar) {
         }
     }
 
-    context = scalloc(1, sizeof(struct context));
-    context->filename = f;
-
     struct ConfigResultIR *config_output = parse_config(new, context);
     yajl_gen_free(config_output->json_gen);
 
+parsed:
     extract_workspace_names_from_bindings();
     check_for_duplicate_bindings(context);
     reorder_bindings();
 
+    if (recording != NULL) {
+        /* Only configs without errors or warnings are cached, so that these
+         * are reported on every start. */
+        if (!context->has_errors && !context->has_warnings && !invalid_sets && version == 4)
+            config_cache_save(cache_path, cache_key);
+        FREE(recording->resources.data);
+        FREE(recording->records.data);
+        FREE(recording);
+    }
+    FREE(cache_path);
+
     if (use_nagbar && (context->has_errors || context->has_warnings || invalid_sets)) {
         ELOG("FYI: You are using i3 version %s\n", i3_version);
         if (version == 3)
@@ -1112,14 +1749,7 @@ bool parse_file(const char *f, bool use_nagbar) {
     free(context);
     free(new);
     free(buf);
-
-    while (!SLIST_EMPTY(&variables)) {
-        current = SLIST_FIRST(&variables);
-        FREE(current->key);
-        FREE(current->value);
-        SLIST_REMOVE_HEAD(&variables, variables);
-        FREE(current);
-    }
+    free_variables(&variables);
 
     return !has_errors;
 }
@@ -42,6 +42,11 @@ void ewmh_update_number_of_desktops(void) {
         }
     }
 
+    static uint32_t last_idx = NET_WM_DESKTOP_NONE;
+    if (idx == last_idx)
+        return;
+    last_idx = idx;
+
     xcb_change_property(conn, XCB_PROP_MODE_REPLACE, root,
                         A__NET_NUMBER_OF_DESKTOPS, XCB_ATOM_CARDINAL, 32, 1, &idx);
 }
@@ -80,6 +85,17 @@ void ewmh_update_desktop_names(void) {
         }
     }
 
+    /* Workspaces are renamed much less often than this is called. */
+    static char *last_desktop_names = NULL;
+    static int last_msg_length = -1;
+    if (msg_length == last_msg_length &&
+        memcmp(desktop_names, last_desktop_names, msg_length) == 0)
+        return;
+    last_msg_length = msg_length;
+    free(last_desktop_names);
+    last_desktop_names = smalloc(msg_length + 1);
+    memcpy(last_desktop_names, desktop_names, msg_length);
+
     xcb_change_property(conn, XCB_PROP_MODE_REPLACE, root,
                         A__NET_DESKTOP_NAMES, A_UTF8_STRING, 8, msg_length, desktop_names);
 }
@@ -117,6 +133,16 @@ void ewmh_update_desktop_viewport(void) {
         }
     }
 
+    static uint32_t *last_viewports = NULL;
+    static int last_position = -1;
+    if (current_position == last_position &&
+        memcmp(viewports, last_viewports, current_position * sizeof(uint32_t)) == 0)
+        return;
+    last_position = current_position;
+    free(last_viewports);
+    last_viewports = smalloc((current_position + 1) * sizeof(uint32_t));
+    memcpy(last_viewports, viewports, current_position * sizeof(uint32_t));
+
     xcb_change_property(conn, XCB_PROP_MODE_REPLACE, root,
                         A__NET_DESKTOP_VIEWPORT, XCB_ATOM_CARDINAL, 32, current_position, &viewports);
 }
@@ -175,7 +201,10 @@ static void ewmh_update_wm_desktop_recursively(Con *con, const uint32_t desktop)
 }
 
 /*
- * Updates _NET_WM_DESKTOP for all windows.
+ * Updates _NET_WM_DESKTOP for all windows on workspaces whose EWMH desktop
+ * index changed (because workspaces were created, closed, renamed or moved)
+ * since the last call. Windows which move between workspaces have to be
+ * updated using ewmh_update_wm_desktop_con().
  * A request will only be made if the cached value differs from the calculated value.
  *
  */
@@ -186,15 +215,35 @@ void ewmh_update_wm_desktop(void) {
     TAILQ_FOREACH(output, &(croot->nodes_head), nodes) {
         Con *workspace;
         TAILQ_FOREACH(workspace, &(output_get_content(output)->nodes_head), nodes) {
-            ewmh_update_wm_desktop_recursively(workspace, desktop);
+            const bool internal = con_is_internal(workspace);
+            const uint32_t index = (internal ? NET_WM_DESKTOP_ALL : desktop);
+            if (workspace->ewmh_desktop != index) {
+                DLOG("EWMH desktop index of workspace \"%s\" changed to %d\n", workspace->name, index);
+                workspace->ewmh_desktop = index;
+                ewmh_update_wm_desktop_recursively(workspace, desktop);
+            }
 
-            if (!con_is_internal(workspace)) {
+            if (!internal) {
                 ++desktop;
             }
         }
     }
 }
 
+/*
+ * Updates _NET_WM_DESKTOP for all windows in the given container (including
+ * the container itself), e.g. after it was moved to a different workspace or
+ * its sticky state changed.
+ * A request will only be made if the cached value differs from the calculated value.
+ *
+ */
+void ewmh_update_wm_desktop_con(Con *con) {
+    if (con_get_workspace(con) == NULL)
+        return;
+
+    ewmh_update_wm_desktop_recursively(con, ewmh_get_workspace_index(con));
+}
+
 /*
  * Updates _NET_ACTIVE_WINDOW with the currently focused window.
  *
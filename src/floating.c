@@ -674,8 +674,12 @@ DRAGGING_CB(resize_window_callback) {
     con->rect.x = dest_x;
     con->rect.y = dest_y;
 
+    /* Like drag_window_callback(), only the resized container is pushed
+     * while resizing. floating_resize_window() renders the whole tree once
+     * the resize is done. */
     render_con(con, true);
-    x_push_changes(croot);
+    x_push_node(con);
+    xcb_flush(conn);
 }
 
 /*
@@ -725,6 +729,8 @@ void floating_resize_window(Con *con, const bool proportional,
     /* If this is a scratchpad window, don't auto center it from now on. */
     if (con->scratchpad_state == SCRATCHPAD_FRESH)
         con->scratchpad_state = SCRATCHPAD_CHANGED;
+
+    tree_render();
 }
 
 /* Custom data structure used to track dragging-related events. */
@@ -746,8 +752,61 @@ struct drag_x11_cb {
 
     /* User data pointer for callback. */
     const void *extra;
+
+    /* Motion is coalesced to one callback per frame of the output on which
+     * the drag started: the latest MotionNotify is kept in pending_motion
+     * until frame_timer fires. */
+    ev_timer frame_timer;
+    ev_tstamp frame_interval;
+    ev_tstamp last_frame;
+    xcb_motion_notify_event_t *pending_motion;
 };
 
+/*
+ * Invokes the drag callback for the pending MotionNotify event, if any.
+ *
+ */
+static void drag_run_callback(struct drag_x11_cb *dragloop) {
+    xcb_motion_notify_event_t *motion = dragloop->pending_motion;
+    if (motion == NULL)
+        return;
+    dragloop->pending_motion = NULL;
+    dragloop->last_frame = ev_now(main_loop);
+
+    /* Ensure that we are either dragging the resize handle (con is NULL) or that the
+     * container still exists. The latter might not be true, e.g., if the window closed
+     * for any reason while the user was dragging it. */
+    if (!dragloop->con || con_exists(dragloop->con)) {
+        dragloop->callback(
+            dragloop->con,
+            &(dragloop->old_rect),
+            motion->root_x,
+            motion->root_y,
+            dragloop->extra);
+    }
+    free(motion);
+
+    xcb_flush(conn);
+}
+
+static void drag_frame_cb(EV_P_ ev_timer *w, int revents) {
+    drag_run_callback((struct drag_x11_cb *)w->data);
+}
+
+/*
+ * Returns the interval between two frames of the output containing the given
+ * position, falling back to 60 Hz if the refresh rate is unknown.
+ *
+ */
+static ev_tstamp drag_frame_interval(int x, int y) {
+    Output *output = get_output_containing(x, y);
+    uint32_t refresh_rate = (output != NULL ? output->refresh_rate : 0);
+    if (refresh_rate == 0)
+        refresh_rate = 60000;
+    DLOG("Pacing drag to %u.%03u Hz\n", refresh_rate / 1000, refresh_rate % 1000);
+    return 1000.0 / refresh_rate;
+}
+
 static bool drain_drag_events(EV_P, struct drag_x11_cb *dragloop) {
     xcb_motion_notify_event_t *last_motion_notify = NULL;
     xcb_generic_event_t *event;
@@ -811,6 +870,11 @@ static bool drain_drag_events(EV_P, struct drag_x11_cb *dragloop) {
             ev_break(EV_A_ EVBREAK_ONE);
             if (dragloop->result == DRAG_SUCCESS) {
                 /* Ensure motion notify events are handled. */
+                if (last_motion_notify == NULL) {
+                    /* Apply a motion which is still waiting for its frame. */
+                    ev_timer_stop(main_loop, &(dragloop->frame_timer));
+                    drag_run_callback(dragloop);
+                }
                 break;
             } else {
                 free(last_motion_notify);
@@ -823,28 +887,32 @@ static bool drain_drag_events(EV_P, struct drag_x11_cb *dragloop) {
         return true;
     }
 
-    /* Ensure that we are either dragging the resize handle (con is NULL) or that the
-     * container still exists. The latter might not be true, e.g., if the window closed
-     * for any reason while the user was dragging it. */
-    if (!dragloop->con || con_exists(dragloop->con)) {
-        dragloop->callback(
-            dragloop->con,
-            &(dragloop->old_rect),
-            last_motion_notify->root_x,
-            last_motion_notify->root_y,
-            dragloop->extra);
+    free(dragloop->pending_motion);
+    dragloop->pending_motion = last_motion_notify;
+
+    /* The final position is applied right away. Otherwise, wait for the next
+     * frame unless one frame interval has already passed since the last
+     * callback. */
+    const ev_tstamp next_frame = dragloop->last_frame + dragloop->frame_interval;
+    if (dragloop->result != DRAGGING || ev_now(main_loop) >= next_frame) {
+        ev_timer_stop(main_loop, &(dragloop->frame_timer));
+        drag_run_callback(dragloop);
+    } else if (!ev_is_active(&(dragloop->frame_timer))) {
+        ev_timer_set(&(dragloop->frame_timer), next_frame - ev_now(main_loop), 0.);
+        ev_timer_start(main_loop, &(dragloop->frame_timer));
     }
-    FREE(last_motion_notify);
 
-    xcb_flush(conn);
     return dragloop->result != DRAGGING;
 }
 
 static void xcb_drag_prepare_cb(EV_P_ ev_prepare *w, int revents) {
     struct drag_x11_cb *dragloop = (struct drag_x11_cb *)w->data;
-    while (!drain_drag_events(EV_A, dragloop)) {
-        /* repeatedly drain events: draining might produce additional ones */
-    }
+    do {
+        while (!drain_drag_events(EV_A, dragloop)) {
+            /* repeatedly drain events: draining might produce additional ones */
+        }
+    } while (flush_property_notifies() || manage_process_pending());
+    flush_log_wakeups();
 }
 
 /*
@@ -854,6 +922,10 @@ static void xcb_drag_prepare_cb(EV_P_ ev_prepare *w, int revents) {
  * specified (client, border on which the click originally was), the original
  * rect of the client, the event and the new coordinates (x, y).
  *
+ * Pointer motion is coalesced to at most one callback per frame of the output
+ * on which the drag started (see Output.refresh_rate); the final position is
+ * always passed to the callback before the drag ends.
+ *
  */
 drag_result_t drag_pointer(Con *con, const xcb_button_press_event_t *event, xcb_window_t confine_to,
                            border_t border, int cursor, callback_t callback, const void *extra) {
@@ -915,12 +987,17 @@ drag_result_t drag_pointer(Con *con, const xcb_button_press_event_t *event, xcb_
         loop.old_rect = con->rect;
     ev_prepare_init(prepare, xcb_drag_prepare_cb);
     prepare->data = &loop;
+    loop.frame_interval = drag_frame_interval(event->root_x, event->root_y);
+    ev_timer_init(&(loop.frame_timer), drag_frame_cb, 0., 0.);
+    loop.frame_timer.data = &loop;
     main_set_x11_cb(false);
     ev_prepare_start(main_loop, prepare);
 
     ev_loop(main_loop, 0);
 
     ev_prepare_stop(main_loop, prepare);
+    ev_timer_stop(main_loop, &(loop.frame_timer));
+    FREE(loop.pending_motion);
     main_set_x11_cb(true);
 
     xcb_ungrab_keyboard(conn, XCB_CURRENT_TIME);
@@ -25,7 +25,40 @@ int shape_base = -1;
 /* After mapping/unmapping windows, a notify event is generated. However, we don’t want it,
    since it’d trigger an infinite loop of switching between the different windows when
    changing workspaces */
-static SLIST_HEAD(ignore_head, Ignore_Event) ignore_events;
+
+/* Ignored sequence numbers are garbage collected after this many seconds. */
+#define IGNORE_EVENT_TIMEOUT 5.0
+
+/* Number of hash buckets (a power of two). Sequence numbers are consecutive,
+ * so their low bits are a perfect hash. */
+#define IGNORE_EVENT_BUCKETS 256
+
+static LIST_HEAD(ignore_head, Ignore_Event) ignore_buckets[IGNORE_EVENT_BUCKETS];
+static TAILQ_HEAD(ignore_expiry_head, Ignore_Event) ignore_expiry = TAILQ_HEAD_INITIALIZER(ignore_expiry);
+static struct ev_timer *ignore_timer;
+
+/*
+ * Garbage collects all ignored sequence numbers which expired and re-arms the
+ * timer for the oldest remaining one. Since events are added in order, the
+ * expired ones are always at the head of the list.
+ *
+ */
+static void ignore_events_expire(EV_P_ ev_timer *w, int revents) {
+    const double now = ev_now(main_loop);
+    struct Ignore_Event *event;
+
+    while ((event = TAILQ_FIRST(&ignore_expiry)) != NULL &&
+           (now - event->added) >= IGNORE_EVENT_TIMEOUT) {
+        TAILQ_REMOVE(&ignore_expiry, event, expiry);
+        LIST_REMOVE(event, ignore_events);
+        free(event);
+    }
+
+    if (event != NULL) {
+        ev_timer_set(ignore_timer, event->added + IGNORE_EVENT_TIMEOUT - now, 0.);
+        ev_timer_start(main_loop, ignore_timer);
+    }
+}
 
 /*
  * Adds the given sequence to the list of events which are ignored.
@@ -40,9 +73,21 @@ void add_ignore_event(const int sequence, const int response_type) {
 
     event->sequence = sequence;
     event->response_type = response_type;
-    event->added = time(NULL);
+    /* Not ev_now(): this is also called before the event loop runs (e.g.
+     * while adopting the existing windows), when the loop time is stale. */
+    event->added = ev_time();
 
-    SLIST_INSERT_HEAD(&ignore_events, event, ignore_events);
+    LIST_INSERT_HEAD(&ignore_buckets[sequence & (IGNORE_EVENT_BUCKETS - 1)], event, ignore_events);
+    TAILQ_INSERT_TAIL(&ignore_expiry, event, expiry);
+
+    if (ignore_timer == NULL) {
+        ignore_timer = scalloc(1, sizeof(struct ev_timer));
+        ev_timer_init(ignore_timer, ignore_events_expire, IGNORE_EVENT_TIMEOUT, 0.);
+    }
+    if (!ev_is_active(ignore_timer)) {
+        ev_timer_set(ignore_timer, IGNORE_EVENT_TIMEOUT, 0.);
+        ev_timer_start(main_loop, ignore_timer);
+    }
 }
 
 /*
@@ -51,18 +96,7 @@ void add_ignore_event(const int sequence, const int response_type) {
  */
 bool event_is_ignored(const int sequence, const int response_type) {
     struct Ignore_Event *event;
-    time_t now = time(NULL);
-    for (event = SLIST_FIRST(&ignore_events); event != SLIST_END(&ignore_events);) {
-        if ((now - event->added) > 5) {
-            struct Ignore_Event *save = event;
-            event = SLIST_NEXT(event, ignore_events);
-            SLIST_REMOVE(&ignore_events, save, Ignore_Event, ignore_events);
-            free(save);
-        } else
-            event = SLIST_NEXT(event, ignore_events);
-    }
-
-    SLIST_FOREACH(event, &ignore_events, ignore_events) {
+    LIST_FOREACH(event, &ignore_buckets[sequence & (IGNORE_EVENT_BUCKETS - 1)], ignore_events) {
         if (event->sequence != sequence)
             continue;
 
@@ -73,8 +107,6 @@ bool event_is_ignored(const int sequence, const int response_type) {
         /* instead of removing a sequence number we better wait until it gets
          * garbage collected. it may generate multiple events (there are multiple
          * enter_notifies for one configure_request, for example). */
-        //SLIST_REMOVE(&ignore_events, event, Ignore_Event, ignore_events);
-        //free(event);
         return true;
     }
 
@@ -279,6 +311,11 @@ static void handle_configure_request(xcb_configure_request_event_t *event) {
     DLOG("window 0x%08x wants to be at %dx%d with %dx%d\n",
          event->window, event->x, event->y, event->width, event->height);
 
+    /* A window which is being managed has to be put into the tree first, so
+     * that the request is handled like for any other managed window. */
+    if (manage_window_is_pending(event->window))
+        manage_finish_pending();
+
     /* For unmanaged windows, we just execute the configure request. As soon as
      * it gets mapped, we will take over anyways. */
     if ((con = con_by_window_id(event->window)) == NULL) {
@@ -452,7 +489,7 @@ static void handle_screen_change(xcb_generic_event_t *e) {
 
     scratchpad_fix_resolution();
 
-    ipc_send_event("output", I3_IPC_EVENT_OUTPUT, "{\"change\":\"unspecified\"}");
+    ipc_send_event(I3_IPC_EVENT_OUTPUT, "{\"change\":\"unspecified\"}");
 }
 
 /*
@@ -463,6 +500,9 @@ static void handle_screen_change(xcb_generic_event_t *e) {
 static void handle_unmap_notify_event(xcb_unmap_notify_event_t *event) {
     DLOG("UnmapNotify for 0x%08x (received from 0x%08x), serial %d\n", event->window, event->event, event->sequence);
     xcb_get_input_focus_cookie_t cookie;
+    if (manage_window_cancel(event->window))
+        return;
+
     Con *con = con_by_window_id(event->window);
     if (con == NULL) {
         /* This could also be an UnmapNotify for the frame. We need to
@@ -713,7 +753,7 @@ static void handle_client_message(xcb_client_message_event_t *event) {
             DLOG("New sticky status for con = %p is %i.\n", con, con->sticky);
             ewmh_update_sticky(con->window->id, con->sticky);
             output_push_sticky_windows(focused);
-            ewmh_update_wm_desktop();
+            ewmh_update_wm_desktop_con(con);
         }
 
         tree_render();
@@ -866,7 +906,7 @@ static void handle_client_message(xcb_client_message_event_t *event) {
         }
 
         tree_render();
-        ewmh_update_wm_desktop();
+        ewmh_update_wm_desktop_con(con);
     } else if (event->type == A__NET_CLOSE_WINDOW) {
         /*
          * Pagers wanting to close a window MUST send a _NET_CLOSE_WINDOW
@@ -1320,9 +1360,36 @@ void property_handlers_init(void) {
     property_handlers[10].atom = A__MOTIF_WM_HINTS;
 }
 
+/* A PropertyNotify event whose handler did not run yet, see property_notify(). */
+struct pending_property {
+    xcb_window_t window;
+    xcb_atom_t atom;
+    uint8_t state;
+    struct property_handler_t *handler;
+    xcb_get_property_cookie_t cookie;
+    /* The window is not managed yet (see manage_window_is_pending()), the
+     * event is queued again until it is. */
+    bool deferred;
+};
+
+static struct pending_property *pending_properties;
+static size_t pending_properties_count;
+static size_t pending_properties_size;
+/* Number of queued PropertyNotify events which were merged into an earlier one
+ * for the same window and property. */
+static size_t pending_properties_coalesced;
+
+struct event_stats event_stats;
+
+/*
+ * Queues a PropertyNotify event. Its handler runs in
+ * flush_property_notifies(), so that multiple changes of the same property of
+ * the same window (e.g. a terminal updating its title hundreds of times per
+ * second) only need a single request and handler call.
+ *
+ */
 static void property_notify(uint8_t state, xcb_window_t window, xcb_atom_t atom) {
     struct property_handler_t *handler = NULL;
-    xcb_get_property_reply_t *propr = NULL;
 
     for (size_t c = 0; c < NUM_HANDLERS; c++) {
         if (property_handlers[c].atom != atom)
@@ -1337,14 +1404,85 @@ static void property_notify(uint8_t state, xcb_window_t window, xcb_atom_t atom)
         return;
     }
 
-    if (state != XCB_PROPERTY_DELETE) {
-        xcb_get_property_cookie_t cookie = xcb_get_property(conn, 0, window, atom, XCB_GET_PROPERTY_TYPE_ANY, 0, handler->long_len);
-        propr = xcb_get_property_reply(conn, cookie, 0);
+    for (size_t i = 0; i < pending_properties_count; i++) {
+        struct pending_property *pending = &pending_properties[i];
+        if (pending->window == window && pending->atom == atom) {
+            /* Only the latest state matters: the property is fetched when
+             * the handler runs. */
+            pending->state = state;
+            pending_properties_coalesced++;
+            event_stats.coalesced_property_notifies++;
+            return;
+        }
     }
 
-    /* the handler will free() the reply unless it returns false */
-    if (!handler->cb(NULL, conn, state, window, atom, propr))
-        FREE(propr);
+    if (pending_properties_count == pending_properties_size) {
+        pending_properties_size = (pending_properties_size == 0 ? 16 : pending_properties_size * 2);
+        pending_properties = srealloc(pending_properties, pending_properties_size * sizeof(struct pending_property));
+    }
+    pending_properties[pending_properties_count++] = (struct pending_property){
+        .window = window,
+        .atom = atom,
+        .state = state,
+        .handler = handler};
+}
+
+/*
+ * Runs the handlers of all queued PropertyNotify events. All GetProperty
+ * requests are sent before waiting for the first reply, so that there is only
+ * a single round trip to the X server. Returns true if any handlers ran (they
+ * might have caused new events to be read from X11).
+ *
+ */
+bool flush_property_notifies(void) {
+    if (pending_properties_count == 0)
+        return false;
+
+    /* Handlers may queue new events, which will be handled by the next call. */
+    struct pending_property *pending = pending_properties;
+    const size_t count = pending_properties_count;
+    const size_t coalesced = pending_properties_coalesced;
+    pending_properties = NULL;
+    pending_properties_count = pending_properties_size = 0;
+    pending_properties_coalesced = 0;
+
+    size_t handled = 0;
+    for (size_t i = 0; i < count; i++) {
+        pending[i].deferred = manage_window_is_pending(pending[i].window);
+        if (pending[i].deferred)
+            continue;
+        handled++;
+        if (pending[i].state != XCB_PROPERTY_DELETE)
+            pending[i].cookie = xcb_get_property(conn, 0, pending[i].window, pending[i].atom,
+                                                 XCB_GET_PROPERTY_TYPE_ANY, 0, pending[i].handler->long_len);
+    }
+
+    /* Changed properties can trigger assignments (for_window). Run them as a
+     * batch so that the tree is rendered at most once. */
+    command_batch_begin();
+    for (size_t i = 0; i < count; i++) {
+        if (pending[i].deferred) {
+            property_notify(pending[i].state, pending[i].window, pending[i].atom);
+            continue;
+        }
+
+        xcb_get_property_reply_t *propr = NULL;
+        if (pending[i].state != XCB_PROPERTY_DELETE)
+            propr = xcb_get_property_reply(conn, pending[i].cookie, 0);
+
+        /* the handler will free() the reply unless it returns false */
+        if (!pending[i].handler->cb(NULL, conn, pending[i].state, pending[i].window, pending[i].atom, propr))
+            FREE(propr);
+    }
+    if (command_batch_end())
+        tree_render();
+
+    if (coalesced > 0)
+        DLOG("Handled %zu property changes, coalesced %zu PropertyNotify events (%" PRIu64 " in total)\n",
+             count, coalesced, event_stats.coalesced_property_notifies);
+
+    free(pending);
+    return (handled > 0);
 }
 
 /*
@@ -1464,6 +1602,11 @@ void handle_event(int type, xcb_generic_event_t *event) {
          * client message for us is _NET_WM_STATE, we honour
          * _NET_WM_STATE_FULLSCREEN and _NET_WM_STATE_DEMANDS_ATTENTION */
         case XCB_CLIENT_MESSAGE:
+            /* Client messages (e.g. I3_SYNC or _NET_ACTIVE_WINDOW) might
+             * depend on windows which were mapped and property changes which
+             * were sent before them. */
+            manage_finish_pending();
+            flush_property_notifies();
             handle_client_message((xcb_client_message_event_t *)event);
             break;
 
@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <fcntl.h>
 #include <libgen.h>
@@ -47,23 +48,125 @@ void ipc_set_kill_timeout(ev_tstamp new) {
     kill_timeout = new;
 }
 
+static size_t max_pending = 64 * 1024 * 1024;
+
+void ipc_set_max_pending(size_t new) {
+    max_pending = new;
+}
+
+/* The maximum number of queued messages passed to a single writev() call. */
+#define IPC_WRITEV_MAX 64
+
 /*
- * Try to write the contents of the pending buffer to the client's subscription
+ * Names of the events which clients can subscribe to, indexed by the event type
+ * without I3_IPC_EVENT_MASK.
+ *
+ */
+static const char *event_names[] = {
+    [I3_IPC_EVENT_WORKSPACE & ~I3_IPC_EVENT_MASK] = "workspace",
+    [I3_IPC_EVENT_OUTPUT & ~I3_IPC_EVENT_MASK] = "output",
+    [I3_IPC_EVENT_MODE & ~I3_IPC_EVENT_MASK] = "mode",
+    [I3_IPC_EVENT_WINDOW & ~I3_IPC_EVENT_MASK] = "window",
+    [I3_IPC_EVENT_BARCONFIG_UPDATE & ~I3_IPC_EVENT_MASK] = "barconfig_update",
+    [I3_IPC_EVENT_BINDING & ~I3_IPC_EVENT_MASK] = "binding",
+    [I3_IPC_EVENT_SHUTDOWN & ~I3_IPC_EVENT_MASK] = "shutdown",
+    [I3_IPC_EVENT_TICK & ~I3_IPC_EVENT_MASK] = "tick",
+};
+
+/*
+ * Creates a new ipc_message with a reference count of 1 from the given message
+ * type and payload.
+ *
+ */
+static ipc_message *ipc_message_new(size_t size, const uint32_t message_type, const uint8_t *payload) {
+    const i3_ipc_header_t header = {
+        .magic = {'i', '3', '-', 'i', 'p', 'c'},
+        .size = size,
+        .type = message_type};
+    const size_t header_size = sizeof(i3_ipc_header_t);
+
+    ipc_message *message = smalloc(sizeof(ipc_message) + header_size + size);
+    message->refcount = 1;
+    message->size = header_size + size;
+    memcpy(message->data, ((void *)&header), header_size);
+    memcpy(message->data + header_size, payload, size);
+    return message;
+}
+
+static void ipc_message_unref(ipc_message *message) {
+    assert(message->refcount > 0);
+    if (--(message->refcount) == 0) {
+        free(message);
+    }
+}
+
+/*
+ * Returns the n-th message in the client's output queue.
+ *
+ */
+static ipc_message *ipc_pending_nth(ipc_client *client, uint32_t n) {
+    return client->pending[(client->pending_first + n) % client->pending_capacity];
+}
+
+/*
+ * Removes the given number of written bytes from the front of the client's
+ * output queue, dropping the references to all messages which were written
+ * completely.
+ *
+ */
+static void ipc_pending_consume(ipc_client *client, size_t n) {
+    client->pending_bytes -= n;
+    while (n > 0) {
+        ipc_message *message = ipc_pending_nth(client, 0);
+        const size_t remaining = message->size - client->pending_offset;
+        if (n < remaining) {
+            client->pending_offset += n;
+            return;
+        }
+
+        n -= remaining;
+        ipc_message_unref(message);
+        client->pending_first = (client->pending_first + 1) % client->pending_capacity;
+        client->pending_count--;
+        client->pending_offset = 0;
+    }
+}
+
+/*
+ * Try to write the contents of the output queue to the client's subscription
  * socket. Will set, reset or clear the timeout and io write callbacks depending
  * on the result of the write operation.
  *
  */
 static void ipc_push_pending(ipc_client *client) {
-    const ssize_t result = writeall_nonblock(client->fd, client->buffer, client->buffer_size);
-    if (result < 0) {
-        return;
+    size_t written = 0;
+    while (client->pending_count > 0) {
+        struct iovec iov[IPC_WRITEV_MAX];
+        const uint32_t iovcnt = (client->pending_count < IPC_WRITEV_MAX ? client->pending_count : IPC_WRITEV_MAX);
+        for (uint32_t i = 0; i < iovcnt; i++) {
+            ipc_message *message = ipc_pending_nth(client, i);
+            const size_t offset = (i == 0 ? client->pending_offset : 0);
+            iov[i].iov_base = message->data + offset;
+            iov[i].iov_len = message->size - offset;
+        }
+
+        const ssize_t n = writev(client->fd, iov, iovcnt);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return;
+        }
+
+        written += (size_t)n;
+        ipc_pending_consume(client, (size_t)n);
     }
 
-    if ((size_t)result == client->buffer_size) {
+    if (client->pending_count == 0) {
         /* Everything was written successfully: clear the timer and stop the io
          * callback. */
-        FREE(client->buffer);
-        client->buffer_size = 0;
         if (client->timeout) {
             ev_timer_stop(main_loop, client->timeout);
             FREE(client->timeout);
@@ -83,48 +186,62 @@ static void ipc_push_pending(ipc_client *client) {
         client->timeout = timeout;
         ev_set_priority(timeout, EV_MINPRI);
         ev_timer_start(main_loop, client->timeout);
-    } else if (result > 0) {
+    } else if (written > 0) {
         /* Keep the old timeout when nothing is written. Otherwise, we would
          * keep a dead connection by continuously renewing its timeouts. */
         ev_timer_stop(main_loop, client->timeout);
         ev_timer_set(client->timeout, kill_timeout, 0.0);
         ev_timer_start(main_loop, client->timeout);
     }
-    if (result == 0) {
-        return;
-    }
-
-    /* Shift the buffer to the left and reduce the allocated space. */
-    client->buffer_size -= (size_t)result;
-    memmove(client->buffer, client->buffer + result, client->buffer_size);
-    client->buffer = srealloc(client->buffer, client->buffer_size);
 }
 
 /*
- * Given a message and a message type, create the corresponding header, merge it
- * with the message and append it to the given client's output buffer. Also,
- * send the message if the client's buffer was empty.
+ * Appends the given message to the client's output queue, taking a reference
+ * to it. Also, send the message if the client's queue was empty.
  *
  */
-static void ipc_send_client_message(ipc_client *client, size_t size, const uint32_t message_type, const uint8_t *payload) {
-    const i3_ipc_header_t header = {
-        .magic = {'i', '3', '-', 'i', 'p', 'c'},
-        .size = size,
-        .type = message_type};
-    const size_t header_size = sizeof(i3_ipc_header_t);
-    const size_t message_size = header_size + size;
+static void ipc_queue_message(ipc_client *client, ipc_message *message) {
+    if (client->doomed) {
+        return;
+    }
 
-    const bool push_now = (client->buffer_size == 0);
-    client->buffer = srealloc(client->buffer, client->buffer_size + message_size);
-    memcpy(client->buffer + client->buffer_size, ((void *)&header), header_size);
-    memcpy(client->buffer + client->buffer_size + header_size, payload, size);
-    client->buffer_size += message_size;
+    const bool push_now = (client->pending_count == 0);
+
+    if (client->pending_count == client->pending_capacity) {
+        /* Grow the ring buffer, moving the queued messages to the front. */
+        const uint32_t capacity = (client->pending_capacity == 0 ? 16 : client->pending_capacity * 2);
+        ipc_message **pending = smalloc(capacity * sizeof(ipc_message *));
+        for (uint32_t i = 0; i < client->pending_count; i++) {
+            pending[i] = ipc_pending_nth(client, i);
+        }
+        free(client->pending);
+        client->pending = pending;
+        client->pending_capacity = capacity;
+        client->pending_first = 0;
+    }
+
+    message->refcount++;
+    client->pending[(client->pending_first + client->pending_count) % client->pending_capacity] = message;
+    client->pending_count++;
+    client->pending_bytes += message->size;
 
     if (push_now) {
         ipc_push_pending(client);
     }
 }
 
+/*
+ * Given a message and a message type, create the corresponding header, merge it
+ * with the message and append it to the given client's output queue. Also,
+ * send the message if the client's queue was empty.
+ *
+ */
+static void ipc_send_client_message(ipc_client *client, size_t size, const uint32_t message_type, const uint8_t *payload) {
+    ipc_message *message = ipc_message_new(size, message_type, payload);
+    ipc_queue_message(client, message);
+    ipc_message_unref(message);
+}
+
 static void free_ipc_client(ipc_client *client) {
     DLOG("Disconnecting client on fd %d\n", client->fd);
     close(client->fd);
@@ -138,30 +255,81 @@ static void free_ipc_client(ipc_client *client) {
         FREE(client->timeout);
     }
 
-    free(client->buffer);
-
-    for (int i = 0; i < client->num_events; i++) {
-        free(client->events[i]);
+    for (uint32_t i = 0; i < client->pending_count; i++) {
+        ipc_message_unref(ipc_pending_nth(client, i));
     }
-    free(client->events);
+    free(client->pending);
+
     TAILQ_REMOVE(&all_clients, client, clients);
     free(client);
 }
 
+static void ipc_client_doomed(EV_P_ ev_timer *w, int revents) {
+    free_ipc_client((ipc_client *)w->data);
+}
+
+/*
+ * Stops reading from and writing to the given client and disconnects it from
+ * the main loop. The client cannot be freed right away because it might be
+ * the one whose request is being handled.
+ *
+ */
+static void doom_ipc_client(ipc_client *client) {
+    client->doomed = true;
+    ev_io_stop(main_loop, client->read_callback);
+    ev_io_stop(main_loop, client->write_callback);
+
+    if (client->timeout) {
+        ev_timer_stop(main_loop, client->timeout);
+    } else {
+        client->timeout = scalloc(1, sizeof(struct ev_timer));
+    }
+    ev_timer_init(client->timeout, ipc_client_doomed, 0., 0.);
+    client->timeout->data = client;
+    ev_timer_start(main_loop, client->timeout);
+}
+
+/*
+ * Returns true if at least one connected IPC client is subscribed to the
+ * given event type. Used to avoid serializing events nobody listens to.
+ *
+ */
+bool ipc_has_event_subscribers(uint32_t message_type) {
+    ipc_client *current;
+    TAILQ_FOREACH(current, &all_clients, clients) {
+        if (!current->doomed && (current->events & IPC_EVENT_BIT(message_type))) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /*
  * Sends the specified event to all IPC clients which are currently connected
- * and subscribed to this kind of event.
+ * and subscribed to this kind of event. The message is serialized once and
+ * shared between all subscribers.
  *
  */
-void ipc_send_event(const char *event, uint32_t message_type, const char *payload) {
+void ipc_send_event(uint32_t message_type, const char *payload) {
+    ipc_message *message = NULL;
     ipc_client *current;
     TAILQ_FOREACH(current, &all_clients, clients) {
-        for (int i = 0; i < current->num_events; i++) {
-            if (strcasecmp(current->events[i], event) == 0) {
-                ipc_send_client_message(current, strlen(payload), message_type, (uint8_t *)payload);
-                break;
-            }
+        if (current->doomed || !(current->events & IPC_EVENT_BIT(message_type))) {
+            continue;
+        }
+        if (message == NULL) {
+            message = ipc_message_new(strlen(payload), message_type, (const uint8_t *)payload);
         }
+        if (max_pending > 0 && current->pending_bytes + message->size > max_pending) {
+            ELOG("client %p on fd %d has more than %zu bytes of unread events, killing\n",
+                 current, current->fd, max_pending);
+            doom_ipc_client(current);
+            continue;
+        }
+        ipc_queue_message(current, message);
+    }
+    if (message != NULL) {
+        ipc_message_unref(message);
     }
 }
 
@@ -186,7 +354,7 @@ static void ipc_send_shutdown_event(shutdown_reason_t reason) {
     ylength length;
 
     y(get_buf, &payload, &length);
-    ipc_send_event("shutdown", I3_IPC_EVENT_SHUTDOWN, (const char *)payload);
+    ipc_send_event(I3_IPC_EVENT_SHUTDOWN, (const char *)payload);
 
     y(free);
 }
@@ -237,40 +405,104 @@ IPC_HANDLER(run_command) {
     yajl_gen_free(gen);
 }
 
-static void dump_rect(yajl_gen gen, const char *name, Rect r) {
-    ystr(name);
-    y(map_open);
-    ystr("x");
-    y(integer, r.x);
-    ystr("y");
-    y(integer, r.y);
-    ystr("width");
-    y(integer, r.width);
-    ystr("height");
-    y(integer, r.height);
-    y(map_close);
+/* The list of commands of a RUN_COMMANDS message, while it is being parsed. */
+struct run_commands_list {
+    char **commands;
+    int num_commands;
+    int depth;
+};
+
+static int run_commands_string_cb(void *ctx, const unsigned char *val, size_t len) {
+    struct run_commands_list *list = ctx;
+    if (list->depth != 1)
+        return 0;
+
+    list->commands = srealloc(list->commands, sizeof(char *) * (list->num_commands + 1));
+    list->commands[list->num_commands++] = sstrndup((const char *)val, len);
+    return 1;
 }
 
-static void dump_gaps(yajl_gen gen, const char *name, gaps_t gaps) {
-    ystr(name);
-    y(map_open);
-    ystr("inner");
-    y(integer, gaps.inner);
+static int run_commands_start_array_cb(void *ctx) {
+    struct run_commands_list *list = ctx;
+    return (++list->depth == 1);
+}
 
-    // TODO: the i3ipc Python modules recognize gaps, but only inner/outer
-    // This is currently here to preserve compatibility with that
-    ystr("outer");
-    y(integer, gaps.top);
+static int run_commands_end_array_cb(void *ctx) {
+    struct run_commands_list *list = ctx;
+    list->depth--;
+    return 1;
+}
 
-    ystr("top");
-    y(integer, gaps.top);
-    ystr("right");
-    y(integer, gaps.right);
-    ystr("bottom");
-    y(integer, gaps.bottom);
-    ystr("left");
-    y(integer, gaps.left);
-    y(map_close);
+/* Anything but strings in a single array is invalid. */
+static int run_commands_invalid_cb(void *ctx) {
+    return 0;
+}
+
+static int run_commands_invalid_boolean_cb(void *ctx, int val) {
+    return 0;
+}
+
+static int run_commands_invalid_number_cb(void *ctx, const char *val, size_t len) {
+    return 0;
+}
+
+/*
+ * Executes a JSON array of commands as a single batch: every command is parsed
+ * and executed just like a RUN_COMMAND message, but the tree is rendered (and
+ * the changes are pushed to X11) only once, after the last command. The reply
+ * contains the COMMAND reply of every command, in order.
+ *
+ */
+IPC_HANDLER(run_commands) {
+    static yajl_callbacks callbacks = {
+        .yajl_null = run_commands_invalid_cb,
+        .yajl_boolean = run_commands_invalid_boolean_cb,
+        .yajl_number = run_commands_invalid_number_cb,
+        .yajl_string = run_commands_string_cb,
+        .yajl_start_map = run_commands_invalid_cb,
+        .yajl_start_array = run_commands_start_array_cb,
+        .yajl_end_array = run_commands_end_array_cb,
+    };
+    struct run_commands_list list = {NULL, 0, 0};
+
+    yajl_handle p = yalloc(&callbacks, (void *)&list);
+    yajl_status stat = yajl_parse(p, (const unsigned char *)message, message_size);
+    if (stat == yajl_status_ok)
+        stat = yajl_complete_parse(p);
+    yajl_free(p);
+
+    yajl_gen gen = ygenalloc();
+    if (stat != yajl_status_ok) {
+        ELOG("IPC: RUN_COMMANDS payload is not a JSON array of strings\n");
+        y(map_open);
+        ystr("success");
+        y(bool, false);
+        ystr("error");
+        ystr("The payload must be a JSON array of strings");
+        y(map_close);
+    } else {
+        LOG("IPC: received a batch of %d commands\n", list.num_commands);
+        y(array_open);
+        command_batch_begin();
+        for (int i = 0; i < list.num_commands; i++)
+            command_result_free(command_batch_run(list.commands[i], gen, NULL));
+        if (command_batch_end())
+            tree_render();
+        y(array_close);
+    }
+
+    for (int i = 0; i < list.num_commands; i++)
+        free(list.commands[i]);
+    free(list.commands);
+
+    const unsigned char *reply;
+    ylength length;
+    y(get_buf, &reply, &length);
+
+    ipc_send_client_message(client, length, I3_IPC_REPLY_TYPE_COMMANDS,
+                            (const uint8_t *)reply);
+
+    y(free);
 }
 
 static void dump_event_state_mask(yajl_gen gen, Binding *bind) {
@@ -363,7 +595,131 @@ static void dump_binding(yajl_gen gen, Binding *bind) {
     y(map_close);
 }
 
-void dump_node(yajl_gen gen, struct Con *con, bool inplace_restart) {
+/*
+ * dump_node() writes either JSON (using yajl) or a binary snapshot. The
+ * node_gen_* functions forward to the respective generator, and within the
+ * tree dumping functions below, y() and ystr() refer to them.
+ *
+ */
+typedef struct node_gen {
+    yajl_gen json;
+    snapshot_gen *snapshot;
+} node_gen;
+
+static void node_gen_map_open(node_gen *gen) {
+    if (gen->snapshot != NULL) {
+        snapshot_gen_map_open(gen->snapshot);
+    } else {
+        yajl_gen_map_open(gen->json);
+    }
+}
+
+static void node_gen_map_close(node_gen *gen) {
+    if (gen->snapshot != NULL) {
+        snapshot_gen_map_close(gen->snapshot);
+    } else {
+        yajl_gen_map_close(gen->json);
+    }
+}
+
+static void node_gen_array_open(node_gen *gen) {
+    if (gen->snapshot != NULL) {
+        snapshot_gen_array_open(gen->snapshot);
+    } else {
+        yajl_gen_array_open(gen->json);
+    }
+}
+
+static void node_gen_array_close(node_gen *gen) {
+    if (gen->snapshot != NULL) {
+        snapshot_gen_array_close(gen->snapshot);
+    } else {
+        yajl_gen_array_close(gen->json);
+    }
+}
+
+static void node_gen_integer(node_gen *gen, long long number) {
+    if (gen->snapshot != NULL) {
+        snapshot_gen_integer(gen->snapshot, number);
+    } else {
+        yajl_gen_integer(gen->json, number);
+    }
+}
+
+static void node_gen_double(node_gen *gen, double number) {
+    if (gen->snapshot != NULL) {
+        snapshot_gen_double(gen->snapshot, number);
+    } else {
+        yajl_gen_double(gen->json, number);
+    }
+}
+
+static void node_gen_bool(node_gen *gen, int boolean) {
+    if (gen->snapshot != NULL) {
+        snapshot_gen_bool(gen->snapshot, boolean);
+    } else {
+        yajl_gen_bool(gen->json, boolean);
+    }
+}
+
+static void node_gen_null(node_gen *gen) {
+    if (gen->snapshot != NULL) {
+        snapshot_gen_null(gen->snapshot);
+    } else {
+        yajl_gen_null(gen->json);
+    }
+}
+
+static void node_gen_string(node_gen *gen, const unsigned char *str, size_t len) {
+    if (gen->snapshot != NULL) {
+        snapshot_gen_string(gen->snapshot, str, len);
+    } else {
+        yajl_gen_string(gen->json, str, len);
+    }
+}
+
+#undef y
+#undef ystr
+#define y(x, ...) node_gen_##x(gen, ##__VA_ARGS__)
+#define ystr(str) node_gen_string(gen, (const unsigned char *)str, strlen(str))
+
+static void dump_rect(node_gen *gen, const char *name, Rect r) {
+    ystr(name);
+    y(map_open);
+    ystr("x");
+    y(integer, r.x);
+    ystr("y");
+    y(integer, r.y);
+    ystr("width");
+    y(integer, r.width);
+    ystr("height");
+    y(integer, r.height);
+    y(map_close);
+}
+
+static void dump_gaps(node_gen *gen, const char *name, gaps_t gaps) {
+    ystr(name);
+    y(map_open);
+    ystr("inner");
+    y(integer, gaps.inner);
+
+    // TODO: the i3ipc Python modules recognize gaps, but only inner/outer
+    // This is currently here to preserve compatibility with that
+    ystr("outer");
+    y(integer, gaps.top);
+
+    ystr("top");
+    y(integer, gaps.top);
+    ystr("right");
+    y(integer, gaps.right);
+    ystr("bottom");
+    y(integer, gaps.bottom);
+    ystr("left");
+    y(integer, gaps.left);
+    y(map_close);
+}
+
+static void dump_node_gen(node_gen *gen, Con *con, bool inplace_restart) {
     y(map_open);
     ystr("id");
     y(integer, (uintptr_t)con);
@@ -581,7 +937,7 @@ void dump_node(yajl_gen gen, struct Con *con, bool inplace_restart) {
     Con *node;
     if (con->type != CT_DOCKAREA || !inplace_restart) {
         TAILQ_FOREACH(node, &(con->nodes_head), nodes) {
-            dump_node(gen, node, inplace_restart);
+            dump_node_gen(gen, node, inplace_restart);
         }
     }
     y(array_close);
@@ -589,7 +945,7 @@ void dump_node(yajl_gen gen, struct Con *con, bool inplace_restart) {
     ystr("floating_nodes");
     y(array_open);
     TAILQ_FOREACH(node, &(con->floating_head), floating_windows) {
-        dump_node(gen, node, inplace_restart);
+        dump_node_gen(gen, node, inplace_restart);
     }
     y(array_close);
 
@@ -680,6 +1036,26 @@ void dump_node(yajl_gen gen, struct Con *con, bool inplace_restart) {
     y(map_close);
 }
 
+#undef y
+#undef ystr
+#define y(x, ...) yajl_gen_##x(gen, ##__VA_ARGS__)
+#define ystr(str) yajl_gen_string(gen, (unsigned char *)str, strlen(str))
+
+void dump_node(yajl_gen gen, Con *con, bool inplace_restart) {
+    node_gen json_gen = {.json = gen};
+    dump_node_gen(&json_gen, con, inplace_restart);
+}
+
+/*
+ * Like dump_node(), but writes a binary snapshot (see snapshot.h) instead of
+ * JSON.
+ *
+ */
+void dump_node_snapshot(snapshot_gen *gen, Con *con, bool inplace_restart) {
+    node_gen snapshot_gen = {.snapshot = gen};
+    dump_node_gen(&snapshot_gen, con, inplace_restart);
+}
+
 static void dump_bar_bindings(yajl_gen gen, Barconfig *config) {
     if (TAILQ_EMPTY(&(config->bar_bindings)))
         return;
@@ -1144,21 +1520,16 @@ static int add_subscription(void *extra, const unsigned char *s,
     ipc_client *client = extra;
 
     DLOG("should add subscription to extra %p, sub %.*s\n", client, (int)len, s);
-    int event = client->num_events;
-
-    client->num_events++;
-    client->events = srealloc(client->events, client->num_events * sizeof(char *));
-    /* We copy the string because it is not null-terminated and strndup()
-     * is missing on some BSD systems */
-    client->events[event] = scalloc(len + 1, 1);
-    memcpy(client->events[event], s, len);
-
-    DLOG("client is now subscribed to:\n");
-    for (int i = 0; i < client->num_events; i++) {
-        DLOG("event %s\n", client->events[i]);
+    for (size_t i = 0; i < sizeof(event_names) / sizeof(event_names[0]); i++) {
+        if (strlen(event_names[i]) == len &&
+            strncasecmp(event_names[i], (const char *)s, len) == 0) {
+            client->events |= (1U << i);
+            DLOG("client is now subscribed to event mask 0x%08x\n", client->events);
+            return 1;
+        }
     }
-    DLOG("(done)\n");
 
+    DLOG("Ignoring subscription to unknown event \"%.*s\"\n", (int)len, s);
     return 1;
 }
 
@@ -1198,14 +1569,7 @@ IPC_HANDLER(subscribe) {
         return;
     }
 
-    bool is_tick = false;
-    for (int i = 0; i < client->num_events; i++) {
-        if (strcmp(client->events[i], "tick") == 0) {
-            is_tick = true;
-            break;
-        }
-    }
-    if (!is_tick) {
+    if (!(client->events & IPC_EVENT_BIT(I3_IPC_EVENT_TICK))) {
         return;
     }
 
@@ -1256,7 +1620,7 @@ IPC_HANDLER(send_tick) {
     ylength length;
     y(get_buf, &payload, &length);
 
-    ipc_send_event("tick", I3_IPC_EVENT_TICK, (const char *)payload);
+    ipc_send_event(I3_IPC_EVENT_TICK, (const char *)payload);
     y(free);
 
     const char *reply = "{\"success\":true}";
@@ -1323,9 +1687,129 @@ IPC_HANDLER(sync) {
     ipc_send_client_message(client, strlen(reply), I3_IPC_REPLY_TYPE_SYNC, (const uint8_t *)reply);
 }
 
+/*
+ * Returns the connected IPC clients along with their subscriptions and the
+ * size of their output queues.
+ *
+ */
+IPC_HANDLER(get_clients) {
+    yajl_gen gen = ygenalloc();
+
+    y(array_open);
+    ipc_client *current;
+    TAILQ_FOREACH(current, &all_clients, clients) {
+        y(map_open);
+
+        ystr("fd");
+        y(integer, current->fd);
+
+        ystr("current");
+        y(bool, current == client);
+
+        ystr("events");
+        y(array_open);
+        for (size_t i = 0; i < sizeof(event_names) / sizeof(event_names[0]); i++) {
+            if (current->events & (1U << i)) {
+                ystr(event_names[i]);
+            }
+        }
+        y(array_close);
+
+        ystr("pending_messages");
+        y(integer, current->pending_count);
+
+        ystr("pending_bytes");
+        y(integer, current->pending_bytes);
+
+        y(map_close);
+    }
+    y(array_close);
+
+    const unsigned char *payload;
+    ylength length;
+    y(get_buf, &payload, &length);
+
+    ipc_send_client_message(client, length, I3_IPC_REPLY_TYPE_CLIENTS, payload);
+    y(free);
+}
+
+/*
+ * Returns internal counters, which are useful to see whether caches work.
+ *
+ */
+IPC_HANDLER(get_stats) {
+    yajl_gen gen = ygenalloc();
+
+    y(map_open);
+
+    ystr("regex");
+    y(map_open);
+    ystr("compiled");
+    y(integer, regex_stats.compiled);
+    ystr("jit_compiled");
+    y(integer, regex_stats.jit_compiled);
+    ystr("evaluations");
+    y(integer, regex_stats.evaluations);
+    ystr("cache_hits");
+    y(integer, regex_stats.cache_hits);
+    y(map_close);
+
+    ystr("render");
+    y(map_open);
+    ystr("renders");
+    y(integer, render_stats.renders);
+    ystr("last_stack_requests");
+    y(integer, render_stats.last_stack_requests);
+    ystr("stack_requests");
+    y(integer, render_stats.stack_requests);
+    y(map_close);
+
+    ystr("events");
+    y(map_open);
+    ystr("coalesced_property_notifies");
+    y(integer, event_stats.coalesced_property_notifies);
+    y(map_close);
+
+    ystr("config_cache");
+    y(map_open);
+    ystr("hits");
+    y(integer, config_cache_stats.hits);
+    ystr("misses");
+    y(integer, config_cache_stats.misses);
+    ystr("stores");
+    y(integer, config_cache_stats.stores);
+    y(map_close);
+
+    y(map_close);
+
+    const unsigned char *payload;
+    ylength length;
+    y(get_buf, &payload, &length);
+
+    ipc_send_client_message(client, length, I3_IPC_REPLY_TYPE_STATS, payload);
+    y(free);
+}
+
+/*
+ * Returns the layout tree as a binary snapshot, containing the same data as
+ * the GET_TREE reply.
+ *
+ */
+IPC_HANDLER(tree_snapshot) {
+    snapshot_gen *gen = snapshot_gen_alloc();
+    dump_node_snapshot(gen, croot, false);
+
+    const unsigned char *payload;
+    size_t length;
+    snapshot_gen_get_buf(gen, &payload, &length);
+
+    ipc_send_client_message(client, length, I3_IPC_REPLY_TYPE_TREE_SNAPSHOT, payload);
+    snapshot_gen_free(gen);
+}
+
 /* The index of each callback function corresponds to the numeric
  * value of the message type (see include/i3/ipc.h) */
-handler_t handlers[12] = {
+handler_t handlers[16] = {
     handle_run_command,
     handle_get_workspaces,
     handle_subscribe,
@@ -1338,6 +1822,10 @@ handler_t handlers[12] = {
     handle_get_config,
     handle_send_tick,
     handle_sync,
+    handle_get_clients,
+    handle_tree_snapshot,
+    handle_run_commands,
+    handle_get_stats,
 };
 
 /*
@@ -1567,13 +2055,17 @@ yajl_gen ipc_marshal_workspace_event(const char *change, Con *current, Con *old)
  * previously focused workspace in "old".
  */
 void ipc_send_workspace_event(const char *change, Con *current, Con *old) {
+    if (!ipc_has_event_subscribers(I3_IPC_EVENT_WORKSPACE)) {
+        return;
+    }
+
     yajl_gen gen = ipc_marshal_workspace_event(change, current, old);
 
     const unsigned char *payload;
     ylength length;
     y(get_buf, &payload, &length);
 
-    ipc_send_event("workspace", I3_IPC_EVENT_WORKSPACE, (const char *)payload);
+    ipc_send_event(I3_IPC_EVENT_WORKSPACE, (const char *)payload);
 
     y(free);
 }
@@ -1583,6 +2075,10 @@ void ipc_send_workspace_event(const char *change, Con *current, Con *old) {
  * also the window container, in "container".
  */
 void ipc_send_window_event(const char *property, Con *con) {
+    if (!ipc_has_event_subscribers(I3_IPC_EVENT_WINDOW)) {
+        return;
+    }
+
     DLOG("Issue IPC window %s event (con = %p, window = 0x%08x)\n",
          property, con, (con->window ? con->window->id : XCB_WINDOW_NONE));
 
@@ -1603,16 +2099,18 @@ void ipc_send_window_event(const char *property, Con *con) {
     ylength length;
     y(get_buf, &payload, &length);
 
-    ipc_send_event("window", I3_IPC_EVENT_WINDOW, (const char *)payload);
+    ipc_send_event(I3_IPC_EVENT_WINDOW, (const char *)payload);
     y(free);
     setlocale(LC_NUMERIC, "");
 }
 
 /*
- * For the barconfig update events, we send the serialized barconfig.
+ * Returns the given bar configuration serialized as in the reply to
+ * GET_BAR_CONFIG and in barconfig_update events. The caller has to free the
+ * returned string.
+ *
  */
-void ipc_send_barconfig_update_event(Barconfig *barconfig) {
-    DLOG("Issue barconfig_update event for id = %s\n", barconfig->id);
+char *ipc_serialize_bar_config(Barconfig *barconfig) {
     setlocale(LC_NUMERIC, "C");
     yajl_gen gen = ygenalloc();
 
@@ -1622,15 +2120,36 @@ void ipc_send_barconfig_update_event(Barconfig *barconfig) {
     ylength length;
     y(get_buf, &payload, &length);
 
-    ipc_send_event("barconfig_update", I3_IPC_EVENT_BARCONFIG_UPDATE, (const char *)payload);
+    char *result = smalloc(length + 1);
+    memcpy(result, payload, length);
+    result[length] = '\0';
     y(free);
     setlocale(LC_NUMERIC, "");
+    return result;
+}
+
+/*
+ * For the barconfig update events, we send the serialized barconfig.
+ */
+void ipc_send_barconfig_update_event(Barconfig *barconfig) {
+    if (!ipc_has_event_subscribers(I3_IPC_EVENT_BARCONFIG_UPDATE)) {
+        return;
+    }
+
+    DLOG("Issue barconfig_update event for id = %s\n", barconfig->id);
+    char *payload = ipc_serialize_bar_config(barconfig);
+    ipc_send_event(I3_IPC_EVENT_BARCONFIG_UPDATE, payload);
+    free(payload);
 }
 
 /*
  * For the binding events, we send the serialized binding struct.
  */
 void ipc_send_binding_event(const char *event_type, Binding *bind) {
+    if (!ipc_has_event_subscribers(I3_IPC_EVENT_BINDING)) {
+        return;
+    }
+
     DLOG("Issue IPC binding %s event (sym = %s, code = %d)\n", event_type, bind->symbol, bind->keycode);
 
     setlocale(LC_NUMERIC, "C");
@@ -1651,7 +2170,7 @@ void ipc_send_binding_event(const char *event_type, Binding *bind) {
     ylength length;
     y(get_buf, &payload, &length);
 
-    ipc_send_event("binding", I3_IPC_EVENT_BINDING, (const char *)payload);
+    ipc_send_event(I3_IPC_EVENT_BINDING, (const char *)payload);
 
     y(free);
     setlocale(LC_NUMERIC, "");
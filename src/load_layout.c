@@ -625,33 +625,22 @@ json_content_t json_determine_content(const char *buf, const size_t len) {
     return content_result;
 }
 
-void tree_append_json(Con *con, const char *buf, const size_t len, char **errormsg) {
-    static yajl_callbacks callbacks = {
-        .yajl_boolean = json_bool,
-        .yajl_integer = json_int,
-        .yajl_double = json_double,
-        .yajl_string = json_string,
-        .yajl_start_map = json_start_map,
-        .yajl_map_key = json_key,
-        .yajl_end_map = json_end_map,
-        .yajl_end_array = json_end_array,
-    };
-    yajl_handle hand = yajl_alloc(&callbacks, NULL, NULL);
-    /* Allowing comments allows for more user-friendly layout files. */
-    yajl_config(hand, yajl_allow_comments, true);
-    /* Allow multiple values, i.e. multiple nodes to attach */
-    yajl_config(hand, yajl_allow_multiple_values, true);
-    /* We don't need to validate that the input is valid UTF8 here.
-     * tree_append_json is called in two cases:
-     * 1. With the append_layout command. json_validate is called first and will
-     *    fail on invalid UTF8 characters so we don't need to recheck.
-     * 2. With an in-place restart. The rest of the codebase should be
-     *    responsible for producing valid UTF8 JSON output. If not,
-     *    tree_append_json will just preserve invalid UTF8 strings in the tree
-     *    instead of failing to parse the layout file which could lead to
-     *    problems like in #3156.
-     * Either way, disabling UTF8 validation slightly speeds up yajl. */
-    yajl_config(hand, yajl_dont_validate_strings, true);
+static yajl_callbacks tree_callbacks = {
+    .yajl_boolean = json_bool,
+    .yajl_integer = json_int,
+    .yajl_double = json_double,
+    .yajl_string = json_string,
+    .yajl_start_map = json_start_map,
+    .yajl_map_key = json_key,
+    .yajl_end_map = json_end_map,
+    .yajl_end_array = json_end_array,
+};
+
+/*
+ * Resets the parser state before appending containers to con.
+ *
+ */
+static void tree_append_begin(Con *con) {
     json_node = con;
     to_focus = NULL;
     parsing_gaps = false;
@@ -663,14 +652,15 @@ void tree_append_json(Con *con, const char *buf, const size_t len, char **errorm
     parsing_geometry = false;
     parsing_focus = false;
     parsing_marks = false;
-    setlocale(LC_NUMERIC, "C");
-    const yajl_status stat = yajl_parse(hand, (const unsigned char *)buf, len);
-    if (stat != yajl_status_ok) {
-        unsigned char *str = yajl_get_error(hand, 1, (const unsigned char *)buf, len);
-        ELOG("JSON parsing error: %s\n", str);
-        if (errormsg != NULL)
-            *errormsg = sstrdup((const char *)str);
-        yajl_free_error(hand, str);
+}
+
+/*
+ * Frees the containers which were not parsed completely (if parsing failed)
+ * and fixes up the percentages of con's children.
+ *
+ */
+static void tree_append_end(Con *con, bool failed) {
+    if (failed) {
         while (incomplete-- > 0) {
             Con *parent = json_node->parent;
             DLOG("freeing incomplete container %p\n", json_node);
@@ -686,6 +676,37 @@ void tree_append_json(Con *con, const char *buf, const size_t len, char **errorm
      * percentages, otherwise i3 will crash immediately when rendering the
      * next time. */
     con_fix_percent(con);
+}
+
+void tree_append_json(Con *con, const char *buf, const size_t len, char **errormsg) {
+    yajl_handle hand = yajl_alloc(&tree_callbacks, NULL, NULL);
+    /* Allowing comments allows for more user-friendly layout files. */
+    yajl_config(hand, yajl_allow_comments, true);
+    /* Allow multiple values, i.e. multiple nodes to attach */
+    yajl_config(hand, yajl_allow_multiple_values, true);
+    /* We don't need to validate that the input is valid UTF8 here.
+     * tree_append_json is called in two cases:
+     * 1. With the append_layout command. json_validate is called first and will
+     *    fail on invalid UTF8 characters so we don't need to recheck.
+     * 2. With an in-place restart. The rest of the codebase should be
+     *    responsible for producing valid UTF8 JSON output. If not,
+     *    tree_append_json will just preserve invalid UTF8 strings in the tree
+     *    instead of failing to parse the layout file which could lead to
+     *    problems like in #3156.
+     * Either way, disabling UTF8 validation slightly speeds up yajl. */
+    yajl_config(hand, yajl_dont_validate_strings, true);
+    tree_append_begin(con);
+    setlocale(LC_NUMERIC, "C");
+    const yajl_status stat = yajl_parse(hand, (const unsigned char *)buf, len);
+    if (stat != yajl_status_ok) {
+        unsigned char *str = yajl_get_error(hand, 1, (const unsigned char *)buf, len);
+        ELOG("JSON parsing error: %s\n", str);
+        if (errormsg != NULL)
+            *errormsg = sstrdup((const char *)str);
+        yajl_free_error(hand, str);
+    }
+
+    tree_append_end(con, stat != yajl_status_ok);
 
     setlocale(LC_NUMERIC, "");
     yajl_complete_parse(hand);
@@ -695,3 +716,19 @@ void tree_append_json(Con *con, const char *buf, const size_t len, char **errorm
         con_activate(to_focus);
     }
 }
+
+/*
+ * Like tree_append_json(), but for a binary snapshot as generated by
+ * dump_node_snapshot(). The snapshot is read in place, feeding the same
+ * callbacks which are used for JSON.
+ *
+ */
+void tree_append_snapshot(Con *con, const char *buf, const size_t len, char **errormsg) {
+    tree_append_begin(con);
+    const bool ok = snapshot_parse(buf, len, &tree_callbacks, NULL, errormsg);
+    tree_append_end(con, !ok);
+
+    if (to_focus) {
+        con_activate(to_focus);
+    }
+}
@@ -10,11 +10,13 @@
 #include <config.h>
 
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/mman.h>
@@ -47,6 +49,9 @@ char *shmlogname = "";
 /* Size limit for the SHM log, by default 25 MiB. Can be overwritten using the
  * flag --shmlog-size. */
 int shmlog_size = 0;
+/* Format of the SHM log (SHMLOG_FORMAT_BINARY by default). Can be overwritten
+ * using the flag --shmlog-format. */
+int shmlog_format = SHMLOG_FORMAT_BINARY;
 /* If enabled, logbuffer will point to a memory mapping of the i3 SHM log. */
 static char *logbuffer;
 /* A pointer (within logbuffer) where data will be written to next. */
@@ -56,6 +61,11 @@ static i3_shmlog_header *header;
 /* A pointer to the byte where we last wrapped. Necessary to not print the
  * left-overs at the end of the ringbuffer. */
 static char *loglastwrap;
+/* Binary format only: a pointer to the oldest record which was not overwritten
+ * since the last wrap (see i3_shmlog_header). */
+static char *logoldest;
+/* Whether messages were logged since the last flush_log_wakeups(). */
+static bool wakeup_pending;
 /* Size (in bytes) of the i3 SHM log. */
 static int logbuffer_size;
 /* File descriptor for shm_open. */
@@ -72,6 +82,7 @@ static long long physical_mem_bytes;
 static void store_log_markers(void) {
     header->offset_next_write = (logwalk - logbuffer);
     header->offset_last_wrap = (loglastwrap - logbuffer);
+    header->offset_oldest = (logoldest - logbuffer);
     header->size = logbuffer_size;
 }
 
@@ -163,6 +174,14 @@ void open_logbuffer(void) {
     memset(logbuffer, '\0', logbuffer_size);
 
     header = (i3_shmlog_header *)logbuffer;
+    header->format = shmlog_format;
+    if (shmlog_format == SHMLOG_FORMAT_BINARY) {
+        struct timespec realtime, monotonic;
+        clock_gettime(CLOCK_REALTIME, &realtime);
+        clock_gettime(CLOCK_MONOTONIC, &monotonic);
+        header->realtime_offset = (realtime.tv_sec - monotonic.tv_sec) * (int64_t)1000000000 +
+                                  (realtime.tv_nsec - monotonic.tv_nsec);
+    }
 
 #if !defined(__OpenBSD__)
     pthread_condattr_t cond_attr;
@@ -174,6 +193,7 @@ void open_logbuffer(void) {
 
     logwalk = logbuffer + sizeof(i3_shmlog_header);
     loglastwrap = logbuffer + logbuffer_size;
+    logoldest = loglastwrap;
     store_log_markers();
 }
 
@@ -215,6 +235,236 @@ void set_debug_logging(const bool _debug_logging) {
     debug_logging = _debug_logging;
 }
 
+/*
+ * Appends size bytes at *pos, unless that would go beyond end.
+ *
+ */
+static bool pack(char **pos, const char *end, const void *data, size_t size) {
+    if (size > (size_t)(end - *pos))
+        return false;
+    memcpy(*pos, data, size);
+    *pos += size;
+    return true;
+}
+
+/*
+ * Stores the format string, finishes the record header and returns the size
+ * of the record.
+ *
+ */
+static size_t finish_record(char *record, const char *fmt, size_t format_length, char *args_end) {
+    i3_shmlog_record *r = (i3_shmlog_record *)record;
+    struct timespec ts;
+
+    memcpy(record + sizeof(i3_shmlog_record), fmt, format_length + 1);
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    r->timestamp = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    r->format_length = format_length;
+    r->size = ((args_end - record) + 7) & ~7;
+    return r->size;
+}
+
+/*
+ * Packs the format string and its arguments into a record at the given
+ * position, without formatting the message (that is left to i3-dump-log).
+ * Returns the size of the record, or 0 if the message contains conversions
+ * which cannot be packed or does not fit into SHMLOG_RECORD_MAX_SIZE bytes.
+ *
+ */
+static size_t pack_record(char *record, const char *fmt, va_list args) {
+    const size_t format_length = strlen(fmt);
+    const char *end = record + SHMLOG_RECORD_MAX_SIZE;
+    char *pos = record + sizeof(i3_shmlog_record) + format_length + 1;
+    if (pos > end)
+        return 0;
+
+    for (const char *walk = fmt; (walk = strchr(walk, '%')) != NULL;) {
+        printf_conversion conv;
+        if ((walk = parse_printf_conversion(walk, &conv)) == NULL)
+            return 0;
+
+        int precision = conv.precision;
+        if (conv.star_width) {
+            int width = va_arg(args, int);
+            if (!pack(&pos, end, &width, sizeof(int)))
+                return 0;
+        }
+        if (conv.star_precision) {
+            precision = va_arg(args, int);
+            if (!pack(&pos, end, &precision, sizeof(int)))
+                return 0;
+        }
+
+        bool fits = true;
+        switch (conv.type) {
+            case PRINTF_ARG_NONE:
+                break;
+            case PRINTF_ARG_INT: {
+                int64_t value;
+                switch (conv.length) {
+                    case 'H':
+                        value = (signed char)va_arg(args, int);
+                        break;
+                    case 'h':
+                        value = (short)va_arg(args, int);
+                        break;
+                    case 'l':
+                        value = va_arg(args, long);
+                        break;
+                    case 'L':
+                        value = va_arg(args, long long);
+                        break;
+                    case 'j':
+                        value = va_arg(args, intmax_t);
+                        break;
+                    case 'z':
+                        value = va_arg(args, ssize_t);
+                        break;
+                    case 't':
+                        value = va_arg(args, ptrdiff_t);
+                        break;
+                    default:
+                        value = va_arg(args, int);
+                        break;
+                }
+                fits = pack(&pos, end, &value, sizeof(int64_t));
+                break;
+            }
+            case PRINTF_ARG_UINT: {
+                uint64_t value;
+                switch (conv.length) {
+                    case 'H':
+                        value = (unsigned char)va_arg(args, unsigned int);
+                        break;
+                    case 'h':
+                        value = (unsigned short)va_arg(args, unsigned int);
+                        break;
+                    case 'l':
+                        value = va_arg(args, unsigned long);
+                        break;
+                    case 'L':
+                        value = va_arg(args, unsigned long long);
+                        break;
+                    case 'j':
+                        value = va_arg(args, uintmax_t);
+                        break;
+                    case 'z':
+                        value = va_arg(args, size_t);
+                        break;
+                    case 't':
+                        value = va_arg(args, ptrdiff_t);
+                        break;
+                    default:
+                        value = va_arg(args, unsigned int);
+                        break;
+                }
+                fits = pack(&pos, end, &value, sizeof(uint64_t));
+                break;
+            }
+            case PRINTF_ARG_DOUBLE: {
+                double value = va_arg(args, double);
+                fits = pack(&pos, end, &value, sizeof(double));
+                break;
+            }
+            case PRINTF_ARG_LONG_DOUBLE: {
+                long double value = va_arg(args, long double);
+                fits = pack(&pos, end, &value, sizeof(long double));
+                break;
+            }
+            case PRINTF_ARG_POINTER: {
+                uint64_t value = (uintptr_t)va_arg(args, void *);
+                fits = pack(&pos, end, &value, sizeof(uint64_t));
+                break;
+            }
+            case PRINTF_ARG_STRING: {
+                const char *value = va_arg(args, const char *);
+                if (value == NULL)
+                    value = "(null)";
+                const size_t len = (precision >= 0 ? strnlen(value, precision) : strlen(value));
+                fits = pack(&pos, end, value, len) && pack(&pos, end, "", 1);
+                break;
+            }
+            case PRINTF_ARG_UNSUPPORTED:
+                return 0;
+        }
+        if (!fits)
+            return 0;
+    }
+
+    return finish_record(record, fmt, format_length, pos);
+}
+
+/*
+ * Stores an already formatted message as a record with format string "%s",
+ * truncating it if necessary.
+ *
+ */
+static size_t pack_text_record(char *record, const char *text, size_t len) {
+    char *pos = record + sizeof(i3_shmlog_record) + strlen("%s") + 1;
+    const size_t max_len = SHMLOG_RECORD_MAX_SIZE - (pos - record) - 1;
+    memcpy(pos, text, min(len, max_len));
+    if (len > max_len) {
+        fprintf(stderr, "BUG: single log message > 4k\n");
+        len = max_len;
+        /* Punch in a newline so the next log message is not dangling at the
+         * end of the truncated message. */
+        pos[len - 1] = '\n';
+    }
+    pos[len] = '\0';
+    return finish_record(record, "%s", strlen("%s"), pos + len + 1);
+}
+
+/*
+ * Returns the position for the next record in the binary SHM log, wrapping
+ * around if there is not enough space left for a record of maximum size, and
+ * skipping the old records which the new one might overwrite.
+ *
+ */
+static char *reserve_record(void) {
+    if (SHMLOG_RECORD_MAX_SIZE > logbuffer_size - (logwalk - logbuffer)) {
+        loglastwrap = logwalk;
+        logwalk = logbuffer + sizeof(i3_shmlog_header);
+        logoldest = logwalk;
+        header->wrap_count++;
+    }
+
+    const char *end = logwalk + SHMLOG_RECORD_MAX_SIZE;
+    while (logoldest < loglastwrap && logoldest < end) {
+        const uint32_t size = ((i3_shmlog_record *)logoldest)->size;
+        logoldest = (size == 0 ? loglastwrap : logoldest + size);
+    }
+    return logwalk;
+}
+
+/*
+ * Makes the record at logwalk visible to readers of the SHM log.
+ *
+ */
+static void commit_record(size_t size) {
+    logwalk += size;
+    /* The record needs to be completely written before readers can see the
+     * new offsets. */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    store_log_markers();
+    wakeup_pending = true;
+}
+
+/*
+ * Wakes up all processes (i3-dump-log -f) waiting for new messages in the SHM
+ * log, but only if something was logged since the last call. This is called
+ * once per event loop iteration instead of once per message.
+ *
+ */
+void flush_log_wakeups(void) {
+    if (!wakeup_pending)
+        return;
+    wakeup_pending = false;
+#if !defined(__OpenBSD__)
+    if (logbuffer)
+        pthread_cond_broadcast(&(header->condvar));
+#endif
+}
+
 /*
  * Logs the given message to stdout (if print is true) while prefixing the
  * current time to it. Additionally, the message will be saved in the i3 SHM
@@ -230,13 +480,31 @@ static void vlog(const bool print, const char *fmt, va_list args) {
     static time_t t;
     static struct tm *tmp;
     static size_t len;
+    static size_t prefix_len;
+
+    /* In the binary format, messages which are not printed do not need to be
+     * formatted at all: i3-dump-log will do that. */
+    if (logbuffer && !print && header->format == SHMLOG_FORMAT_BINARY) {
+        char *record = reserve_record();
+        va_list args_copy;
+        va_copy(args_copy, args);
+        size_t size = pack_record(record, fmt, args_copy);
+        va_end(args_copy);
+        if (size == 0) {
+            int formatted_len = vsnprintf(message, sizeof(message), fmt, args);
+            formatted_len = max(0, min(formatted_len, (int)sizeof(message) - 1));
+            size = pack_text_record(record, message, formatted_len);
+        }
+        commit_record(size);
+        return;
+    }
 
     /* Get current time */
     t = time(NULL);
     /* Convert time to local time (determined by the locale) */
     tmp = localtime_r(&t, &result);
     /* Generate time prefix */
-    len = strftime(message, sizeof(message), "%x %X - ", tmp);
+    len = prefix_len = strftime(message, sizeof(message), "%x %X - ", tmp);
 
     /*
      * logbuffer  print
@@ -270,26 +538,28 @@ static void vlog(const bool print, const char *fmt, va_list args) {
             message[len - 2] = '\n';
         }
 
-        /* If there is no space for the current message in the ringbuffer, we
-         * need to wrap and write to the beginning again. */
-        if (len >= (size_t)(logbuffer_size - (logwalk - logbuffer))) {
-            loglastwrap = logwalk;
-            logwalk = logbuffer + sizeof(i3_shmlog_header);
-            store_log_markers();
-            header->wrap_count++;
-        }
-
-        /* Copy the buffer, move the write pointer to the byte after our
-         * current message. */
-        strncpy(logwalk, message, len);
-        logwalk += len;
+        if (header->format == SHMLOG_FORMAT_BINARY) {
+            /* The message was formatted for stdout anyway, so store it
+             * as-is. i3-dump-log adds the time prefix. */
+            commit_record(pack_text_record(reserve_record(), message + prefix_len, len - prefix_len));
+        } else {
+            /* If there is no space for the current message in the ringbuffer, we
+             * need to wrap and write to the beginning again. */
+            if (len >= (size_t)(logbuffer_size - (logwalk - logbuffer))) {
+                loglastwrap = logwalk;
+                logwalk = logbuffer + sizeof(i3_shmlog_header);
+                store_log_markers();
+                header->wrap_count++;
+            }
 
-        store_log_markers();
+            /* Copy the buffer, move the write pointer to the byte after our
+             * current message. */
+            strncpy(logwalk, message, len);
+            logwalk += len;
 
-#if !defined(__OpenBSD__)
-        /* Wake up all (i3-dump-log) processes waiting for condvar. */
-        pthread_cond_broadcast(&(header->condvar));
-#endif
+            store_log_markers();
+            wakeup_pending = true;
+        }
 
         if (print)
             fwrite(message, len, 1, stdout);
@@ -93,6 +93,9 @@ bool shape_supported = true;
 
 bool force_xinerama = false;
 
+/* Whether parsed configs are cached in the runtime directory, see parse_file(). */
+bool use_config_cache = false;
+
 /*
  * This callback is only a dummy, see xcb_prepare_cb.
  * See also man libev(3): "ev_prepare" and "ev_check" - customise your event loop
@@ -113,29 +116,40 @@ static void xcb_prepare_cb(EV_P_ ev_prepare *w, int revents) {
        sleeps. */
     xcb_generic_event_t *event;
 
-    while ((event = xcb_poll_for_event(conn)) != NULL) {
-        if (event->response_type == 0) {
-            if (event_is_ignored(event->sequence, 0))
-                DLOG("Expected X11 Error received for sequence %x\n", event->sequence);
-            else {
-                xcb_generic_error_t *error = (xcb_generic_error_t *)event;
-                DLOG("X11 Error received (probably harmless)! sequence 0x%x, error_code = %d\n",
-                     error->sequence, error->error_code);
+    /* PropertyNotify events are coalesced while draining the queue and handled
+     * afterwards (see flush_property_notifies()), new windows are managed
+     * once their replies arrived (see manage_process_pending()). Both might
+     * read new events from X11, so repeat until there is nothing left to
+     * do. */
+    do {
+        while ((event = xcb_poll_for_event(conn)) != NULL) {
+            if (event->response_type == 0) {
+                if (event_is_ignored(event->sequence, 0))
+                    DLOG("Expected X11 Error received for sequence %x\n", event->sequence);
+                else {
+                    xcb_generic_error_t *error = (xcb_generic_error_t *)event;
+                    DLOG("X11 Error received (probably harmless)! sequence 0x%x, error_code = %d\n",
+                         error->sequence, error->error_code);
+                }
+                free(event);
+                continue;
             }
-            free(event);
-            continue;
-        }
 
-        /* Strip off the highest bit (set if the event is generated) */
-        int type = (event->response_type & 0x7F);
+            /* Strip off the highest bit (set if the event is generated) */
+            int type = (event->response_type & 0x7F);
 
-        handle_event(type, event);
+            handle_event(type, event);
 
-        free(event);
-    }
+            free(event);
+        }
+    } while (flush_property_notifies() || manage_process_pending());
 
     /* Flush all queued events to X11. */
     xcb_flush(conn);
+
+    /* Notify i3-dump-log -f about everything that was logged while handling
+     * the events. */
+    flush_log_wakeups();
 }
 
 /*
@@ -263,8 +277,11 @@ int main(int argc, char *argv[]) {
         {"disable-randr15", no_argument, 0, 0},
         {"disable_randr15", no_argument, 0, 0},
         {"disable-signalhandler", no_argument, 0, 0},
+        {"config-cache", no_argument, 0, 0},
         {"shmlog-size", required_argument, 0, 0},
         {"shmlog_size", required_argument, 0, 0},
+        {"shmlog-format", required_argument, 0, 0},
+        {"shmlog_format", required_argument, 0, 0},
         {"get-socketpath", no_argument, 0, 0},
         {"get_socketpath", no_argument, 0, 0},
         {"fake_outputs", required_argument, 0, 0},
@@ -349,6 +366,9 @@ int main(int argc, char *argv[]) {
                 } else if (strcmp(long_options[option_index].name, "disable-signalhandler") == 0) {
                     disable_signalhandler = true;
                     break;
+                } else if (strcmp(long_options[option_index].name, "config-cache") == 0) {
+                    use_config_cache = true;
+                    break;
                 } else if (strcmp(long_options[option_index].name, "get-socketpath") == 0 ||
                            strcmp(long_options[option_index].name, "get_socketpath") == 0) {
                     char *socket_path = root_atom_contents("I3_SOCKET_PATH", NULL, 0);
@@ -366,6 +386,25 @@ int main(int argc, char *argv[]) {
                     init_logging();
                     LOG("Limiting SHM log size to %d bytes\n", shmlog_size);
                     break;
+                } else if (strcmp(long_options[option_index].name, "shmlog-format") == 0 ||
+                           strcmp(long_options[option_index].name, "shmlog_format") == 0) {
+                    if (strcmp(optarg, "text") == 0) {
+                        shmlog_format = SHMLOG_FORMAT_TEXT;
+                    } else if (strcmp(optarg, "binary") == 0) {
+                        shmlog_format = SHMLOG_FORMAT_BINARY;
+                    } else {
+                        fprintf(stderr, "Invalid SHM log format \"%s\", expected \"text\" or \"binary\"\n", optarg);
+                        exit(EXIT_FAILURE);
+                    }
+                    /* Re-open the SHM log if --shmlog-size already opened it. */
+                    if (shmlog_size > 0) {
+                        const int size = shmlog_size;
+                        shmlog_size = 0;
+                        init_logging();
+                        shmlog_size = size;
+                        init_logging();
+                    }
+                    break;
                 } else if (strcmp(long_options[option_index].name, "restart") == 0) {
                     FREE(layout_path);
                     layout_path = sstrdup(optarg);
@@ -398,6 +437,10 @@ int main(int argc, char *argv[]) {
                                 "\told nVidia closed source driver (older than 302.17), which does\n"
                                 "\tnot support RandR.\n");
                 fprintf(stderr, "\n");
+                fprintf(stderr, "\t--config-cache\n"
+                                "\tCache the parsed configuration in $XDG_RUNTIME_DIR/i3 to speed\n"
+                                "\tup starting, restarting and reloading with an unchanged config.\n");
+                fprintf(stderr, "\n");
                 fprintf(stderr, "\t--get-socketpath\n"
                                 "\tRetrieve the i3 IPC socket path from X11, print it, then exit.\n");
                 fprintf(stderr, "\n");
@@ -407,6 +450,11 @@ int main(int argc, char *argv[]) {
                                 "\tThe default is %d bytes.\n",
                         shmlog_size);
                 fprintf(stderr, "\n");
+                fprintf(stderr, "\t--shmlog-format <text|binary>\n"
+                                "\tStore log messages in the i3 SHM log as formatted text or as\n"
+                                "\tbinary records which are only formatted by i3-dump-log.\n"
+                                "\tThe default is binary.\n");
+                fprintf(stderr, "\n");
                 fprintf(stderr, "If you pass plain text arguments, i3 will interpret them as a command\n"
                                 "to send to a currently running i3 (like i3-msg). This allows you to\n"
                                 "use nice and logical commands, such as:\n"
@@ -9,40 +9,12 @@
  */
 #include "all.h"
 
+#include <xcb/xcbext.h>
+
 #include "yajl_utils.h"
 
 #include <yajl/yajl_gen.h>
 
-/*
- * Go through all existing windows (if the window manager is restarted) and manage them
- *
- */
-void manage_existing_windows(xcb_window_t root) {
-    xcb_query_tree_reply_t *reply;
-    int i, len;
-    xcb_window_t *children;
-    xcb_get_window_attributes_cookie_t *cookies;
-
-    /* Get the tree of windows whose parent is the root window (= all) */
-    if ((reply = xcb_query_tree_reply(conn, xcb_query_tree(conn, root), 0)) == NULL)
-        return;
-
-    len = xcb_query_tree_children_length(reply);
-    cookies = smalloc(len * sizeof(*cookies));
-
-    /* Request the window attributes for every window */
-    children = xcb_query_tree_children(reply);
-    for (i = 0; i < len; ++i)
-        cookies[i] = xcb_get_window_attributes(conn, children[i]);
-
-    /* Call manage_window with the attributes for every window */
-    for (i = 0; i < len; ++i)
-        manage_window(children[i], cookies[i], true);
-
-    free(reply);
-    free(cookies);
-}
-
 /*
  * Restores the geometry of each window by reparenting it to the root window
  * at the position of its frame.
@@ -54,6 +26,10 @@ void manage_existing_windows(xcb_window_t root) {
 void restore_geometry(void) {
     DLOG("Restoring geometry\n");
 
+    /* Windows whose MapRequest was not handled completely would stay unmapped
+     * (and therefore not be managed after restarting). */
+    manage_finish_pending();
+
     Con *con;
     TAILQ_FOREACH(con, &all_cons, all_cons)
     if (con->window) {
@@ -75,56 +51,227 @@ void restore_geometry(void) {
 }
 
 /*
- * Do some sanity checks and then reparent the window.
+ * The replies which are needed to manage a window. They are requested in
+ * three steps: the attributes and geometry (to decide whether the window
+ * should be managed at all), then everything else, and finally a check whether
+ * the reparenting succeeded.
+ *
+ */
+typedef enum {
+    MANAGE_REPLY_ATTRIBUTES = 0,
+    MANAGE_REPLY_GEOMETRY,
+
+    MANAGE_REPLY_WM_TYPE,
+    MANAGE_REPLY_STRUT,
+    MANAGE_REPLY_STATE,
+    MANAGE_REPLY_UTF8_TITLE,
+    MANAGE_REPLY_LEADER,
+    MANAGE_REPLY_TRANSIENT,
+    MANAGE_REPLY_TITLE,
+    MANAGE_REPLY_CLASS,
+    MANAGE_REPLY_ROLE,
+    MANAGE_REPLY_STARTUP_ID,
+    MANAGE_REPLY_WM_HINTS,
+    MANAGE_REPLY_WM_NORMAL_HINTS,
+    MANAGE_REPLY_MOTIF_WM_HINTS,
+    MANAGE_REPLY_WM_USER_TIME,
+    MANAGE_REPLY_WM_DESKTOP,
+    MANAGE_REPLY_WM_PROTOCOLS,
+    MANAGE_REPLY_SHAPE_EXTENTS,
+    /* The event mask change is requested before the properties, but it only
+     * is known to be complete once a later reply arrived, so it is checked
+     * last. */
+    MANAGE_REPLY_EVENT_MASK,
+
+    MANAGE_REPLY_SYNC,
+    MANAGE_REPLY_REPARENT,
+
+    MANAGE_REPLY_COUNT
+} manage_reply_t;
+
+typedef enum {
+    /* Waiting for MANAGE_REPLY_ATTRIBUTES and MANAGE_REPLY_GEOMETRY. */
+    MANAGE_ATTRIBUTES,
+    /* Waiting for MANAGE_REPLY_WM_TYPE up to MANAGE_REPLY_EVENT_MASK. */
+    MANAGE_PROPERTIES,
+    /* The window is managed, waiting for MANAGE_REPLY_SYNC and
+     * MANAGE_REPLY_REPARENT. */
+    MANAGE_REPARENT,
+} manage_stage_t;
+
+/*
+ * A window which is being managed. Windows are managed by a state machine
+ * which is driven by the main loop (see manage_process_pending()), so that
+ * the replies for many new windows (e.g. when an application restores its
+ * session) are collected together and other events are handled meanwhile.
+ *
+ */
+typedef struct pending_window {
+    xcb_window_t window;
+    bool needs_to_be_mapped;
+    manage_stage_t stage;
+
+    unsigned int sequence[MANAGE_REPLY_COUNT];
+    /* Whether the reply was received (or not requested at all). */
+    bool received[MANAGE_REPLY_COUNT];
+    /* Whether the request failed. */
+    bool failed[MANAGE_REPLY_COUNT];
+    void *reply[MANAGE_REPLY_COUNT];
+
+    TAILQ_ENTRY(pending_window)
+    pending_windows;
+} pending_window;
+
+/* The windows which are being managed, in the order of their MapRequests. */
+static TAILQ_HEAD(pending_windows_head, pending_window) pending_windows =
+    TAILQ_HEAD_INITIALIZER(pending_windows);
+
+/* Set while manage_existing_windows() adopts the windows which exist when i3
+ * starts. The tree is then rendered once after all windows were placed
+ * instead of once per window. */
+static bool adopting = false;
+static int adopted_windows = 0;
+/* The adopted window which gets focused once all windows were placed. Its
+ * container is not mapped before the tree was rendered, so it cannot be
+ * activated right away. */
+static Con *adopted_focus = NULL;
+
+static void manage_request(pending_window *pw, manage_reply_t index, unsigned int sequence) {
+    pw->sequence[index] = sequence;
+    pw->received[index] = false;
+}
+
+static bool manage_is_void_request(manage_reply_t index) {
+    return (index == MANAGE_REPLY_EVENT_MASK || index == MANAGE_REPLY_REPARENT);
+}
+
+/*
+ * Collects the replies from first to last (inclusive). Returns true if all of
+ * them were received. If block is true, waits for them. Sets *progress (if not
+ * NULL) when a reply was collected.
+ *
+ */
+static bool manage_poll(pending_window *pw, manage_reply_t first, manage_reply_t last, bool block, bool *progress) {
+    bool complete = true;
+    for (manage_reply_t index = first; index <= last; index++) {
+        if (pw->received[index])
+            continue;
+
+        void *reply = NULL;
+        xcb_generic_error_t *error = NULL;
+        if (block && manage_is_void_request(index)) {
+            error = xcb_request_check(conn, (xcb_void_cookie_t){pw->sequence[index]});
+        } else if (block) {
+            reply = xcb_wait_for_reply(conn, pw->sequence[index], &error);
+        } else if (xcb_poll_for_reply(conn, pw->sequence[index], &reply, &error) == 0) {
+            complete = false;
+            continue;
+        }
+
+        pw->received[index] = true;
+        pw->reply[index] = reply;
+        pw->failed[index] = (error != NULL);
+        free(error);
+        if (progress != NULL)
+            *progress = true;
+    }
+    return complete;
+}
+
+/*
+ * Returns the given reply and removes it from pw. The caller has to free it.
+ *
+ */
+static void *manage_take_reply(pending_window *pw, manage_reply_t index) {
+    void *reply = pw->reply[index];
+    pw->reply[index] = NULL;
+    return reply;
+}
+
+static void manage_free(pending_window *pw) {
+    for (manage_reply_t index = 0; index < MANAGE_REPLY_COUNT; index++) {
+        if (!pw->received[index])
+            xcb_discard_reply(conn, pw->sequence[index]);
+        free(pw->reply[index]);
+    }
+    TAILQ_REMOVE(&pending_windows, pw, pending_windows);
+    free(pw);
+}
+
+static pending_window *manage_pending_for(xcb_window_t window) {
+    pending_window *pw;
+    TAILQ_FOREACH(pw, &pending_windows, pending_windows) {
+        if (pw->window == window && pw->stage != MANAGE_REPARENT)
+            return pw;
+    }
+    return NULL;
+}
+
+/*
+ * Starts managing the given window: the window attributes (for which the
+ * caller already sent the request) and geometry are collected by
+ * manage_process_pending(), which will then decide whether to manage the
+ * window.
  *
  */
 void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cookie,
                    bool needs_to_be_mapped) {
     DLOG("window 0x%08x\n", window);
 
-    xcb_drawable_t d = {window};
-    xcb_get_geometry_cookie_t geomc;
-    xcb_get_geometry_reply_t *geom;
-    xcb_get_window_attributes_reply_t *attr = NULL;
+    if (manage_pending_for(window) != NULL) {
+        DLOG("already being managed\n");
+        xcb_discard_reply(conn, cookie.sequence);
+        return;
+    }
 
-    xcb_get_property_cookie_t wm_type_cookie, strut_cookie, state_cookie,
-        utf8_title_cookie, title_cookie,
-        class_cookie, leader_cookie, transient_cookie,
-        role_cookie, startup_id_cookie, wm_hints_cookie,
-        wm_normal_hints_cookie, motif_wm_hints_cookie, wm_user_time_cookie, wm_desktop_cookie;
+    pending_window *pw = scalloc(1, sizeof(pending_window));
+    pw->window = window;
+    pw->needs_to_be_mapped = needs_to_be_mapped;
+    pw->stage = MANAGE_ATTRIBUTES;
+    for (manage_reply_t index = 0; index < MANAGE_REPLY_COUNT; index++)
+        pw->received[index] = true;
 
-    geomc = xcb_get_geometry(conn, d);
+    manage_request(pw, MANAGE_REPLY_ATTRIBUTES, cookie.sequence);
+    manage_request(pw, MANAGE_REPLY_GEOMETRY, xcb_get_geometry(conn, window).sequence);
+    TAILQ_INSERT_TAIL(&pending_windows, pw, pending_windows);
+    xcb_flush(conn);
+}
+
+/*
+ * Does some sanity checks once the attributes and geometry of the window
+ * arrived. If the window should be managed, its event mask is changed and all
+ * properties are requested. Returns false if the window should not be
+ * managed.
+ *
+ */
+static bool manage_request_properties(pending_window *pw) {
+    xcb_window_t window = pw->window;
+    xcb_get_window_attributes_reply_t *attr = pw->reply[MANAGE_REPLY_ATTRIBUTES];
 
     /* Check if the window is mapped (it could be not mapped when intializing and
        calling manage_window() for every window) */
-    if ((attr = xcb_get_window_attributes_reply(conn, cookie, 0)) == NULL) {
+    if (attr == NULL) {
         DLOG("Could not get attributes\n");
-        xcb_discard_reply(conn, geomc.sequence);
-        return;
+        return false;
     }
 
-    if (needs_to_be_mapped && attr->map_state != XCB_MAP_STATE_VIEWABLE) {
-        xcb_discard_reply(conn, geomc.sequence);
-        goto out;
-    }
+    if (pw->needs_to_be_mapped && attr->map_state != XCB_MAP_STATE_VIEWABLE)
+        return false;
 
     /* Don’t manage clients with the override_redirect flag */
-    if (attr->override_redirect) {
-        xcb_discard_reply(conn, geomc.sequence);
-        goto out;
-    }
+    if (attr->override_redirect)
+        return false;
 
     /* Check if the window is already managed */
     if (con_by_window_id(window) != NULL) {
         DLOG("already managed (by con %p)\n", con_by_window_id(window));
-        xcb_discard_reply(conn, geomc.sequence);
-        goto out;
+        return false;
     }
 
     /* Get the initial geometry (position, size, …) */
-    if ((geom = xcb_get_geometry_reply(conn, geomc, 0)) == NULL) {
+    if (pw->reply[MANAGE_REPLY_GEOMETRY] == NULL) {
         DLOG("could not get geometry\n");
-        goto out;
+        return false;
     }
 
     uint32_t values[1];
@@ -140,30 +287,78 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
      * window between the MapRequest and our event mask change. */
     values[0] = XCB_EVENT_MASK_PROPERTY_CHANGE |
                 XCB_EVENT_MASK_STRUCTURE_NOTIFY;
-    xcb_void_cookie_t event_mask_cookie =
-        xcb_change_window_attributes_checked(conn, window, XCB_CW_EVENT_MASK, values);
-    if (xcb_request_check(conn, event_mask_cookie) != NULL) {
-        LOG("Could not change event mask, the window probably already disappeared.\n");
-        goto out;
-    }
-
-#define GET_PROPERTY(atom, len) xcb_get_property(conn, false, window, atom, XCB_GET_PROPERTY_TYPE_ANY, 0, len)
-
-    wm_type_cookie = GET_PROPERTY(A__NET_WM_WINDOW_TYPE, UINT32_MAX);
-    strut_cookie = GET_PROPERTY(A__NET_WM_STRUT_PARTIAL, UINT32_MAX);
-    state_cookie = GET_PROPERTY(A__NET_WM_STATE, UINT32_MAX);
-    utf8_title_cookie = GET_PROPERTY(A__NET_WM_NAME, 128);
-    leader_cookie = GET_PROPERTY(A_WM_CLIENT_LEADER, UINT32_MAX);
-    transient_cookie = GET_PROPERTY(XCB_ATOM_WM_TRANSIENT_FOR, UINT32_MAX);
-    title_cookie = GET_PROPERTY(XCB_ATOM_WM_NAME, 128);
-    class_cookie = GET_PROPERTY(XCB_ATOM_WM_CLASS, 128);
-    role_cookie = GET_PROPERTY(A_WM_WINDOW_ROLE, 128);
-    startup_id_cookie = GET_PROPERTY(A__NET_STARTUP_ID, 512);
-    wm_hints_cookie = xcb_icccm_get_wm_hints(conn, window);
-    wm_normal_hints_cookie = xcb_icccm_get_wm_normal_hints(conn, window);
-    motif_wm_hints_cookie = GET_PROPERTY(A__MOTIF_WM_HINTS, 5 * sizeof(uint64_t));
-    wm_user_time_cookie = GET_PROPERTY(A__NET_WM_USER_TIME, UINT32_MAX);
-    wm_desktop_cookie = GET_PROPERTY(A__NET_WM_DESKTOP, UINT32_MAX);
+    manage_request(pw, MANAGE_REPLY_EVENT_MASK,
+                   xcb_change_window_attributes_checked(conn, window, XCB_CW_EVENT_MASK, values).sequence);
+
+#define GET_PROPERTY(index, atom, len) \
+    manage_request(pw, index, xcb_get_property(conn, false, window, atom, XCB_GET_PROPERTY_TYPE_ANY, 0, len).sequence)
+
+    GET_PROPERTY(MANAGE_REPLY_WM_TYPE, A__NET_WM_WINDOW_TYPE, UINT32_MAX);
+    GET_PROPERTY(MANAGE_REPLY_STRUT, A__NET_WM_STRUT_PARTIAL, UINT32_MAX);
+    GET_PROPERTY(MANAGE_REPLY_STATE, A__NET_WM_STATE, UINT32_MAX);
+    GET_PROPERTY(MANAGE_REPLY_UTF8_TITLE, A__NET_WM_NAME, 128);
+    GET_PROPERTY(MANAGE_REPLY_LEADER, A_WM_CLIENT_LEADER, UINT32_MAX);
+    GET_PROPERTY(MANAGE_REPLY_TRANSIENT, XCB_ATOM_WM_TRANSIENT_FOR, UINT32_MAX);
+    GET_PROPERTY(MANAGE_REPLY_TITLE, XCB_ATOM_WM_NAME, 128);
+    GET_PROPERTY(MANAGE_REPLY_CLASS, XCB_ATOM_WM_CLASS, 128);
+    GET_PROPERTY(MANAGE_REPLY_ROLE, A_WM_WINDOW_ROLE, 128);
+    GET_PROPERTY(MANAGE_REPLY_STARTUP_ID, A__NET_STARTUP_ID, 512);
+    manage_request(pw, MANAGE_REPLY_WM_HINTS, xcb_icccm_get_wm_hints(conn, window).sequence);
+    manage_request(pw, MANAGE_REPLY_WM_NORMAL_HINTS, xcb_icccm_get_wm_normal_hints(conn, window).sequence);
+    GET_PROPERTY(MANAGE_REPLY_MOTIF_WM_HINTS, A__MOTIF_WM_HINTS, 5 * sizeof(uint64_t));
+    GET_PROPERTY(MANAGE_REPLY_WM_USER_TIME, A__NET_WM_USER_TIME, UINT32_MAX);
+    GET_PROPERTY(MANAGE_REPLY_WM_DESKTOP, A__NET_WM_DESKTOP, UINT32_MAX);
+    manage_request(pw, MANAGE_REPLY_WM_PROTOCOLS, xcb_icccm_get_wm_protocols(conn, window, A_WM_PROTOCOLS).sequence);
+
+#undef GET_PROPERTY
+
+    if (shape_supported) {
+        /* Receive ShapeNotify events whenever the client altered its window
+         * shape. */
+        xcb_shape_select_input(conn, window, true);
+
+        /* Check if the window is shaped. Sadly, we can check only for the
+         * bounding shape, not for the input shape. */
+        manage_request(pw, MANAGE_REPLY_SHAPE_EXTENTS, xcb_shape_query_extents(conn, window).sequence);
+    }
+
+    pw->stage = MANAGE_PROPERTIES;
+    return true;
+}
+
+/*
+ * Returns true if the client supports the given protocol atom, according to
+ * the WM_PROTOCOLS reply of the window.
+ *
+ */
+static bool manage_supports_protocol(pending_window *pw, xcb_atom_t atom) {
+    xcb_get_property_reply_t *reply = pw->reply[MANAGE_REPLY_WM_PROTOCOLS];
+    xcb_icccm_get_wm_protocols_reply_t protocols;
+    bool result = false;
+
+    if (reply == NULL || !xcb_icccm_get_wm_protocols_from_reply(reply, &protocols))
+        return false;
+
+    for (uint32_t i = 0; i < protocols.atoms_len; i++)
+        if (protocols.atoms[i] == atom)
+            result = true;
+
+    return result;
+}
+
+/*
+ * Puts the window into the tree and reparents it, once all of its properties
+ * arrived.
+ *
+ */
+static void manage_place(pending_window *pw) {
+    xcb_window_t window = pw->window;
+    xcb_get_window_attributes_reply_t *attr = pw->reply[MANAGE_REPLY_ATTRIBUTES];
+    xcb_get_geometry_reply_t *geom = pw->reply[MANAGE_REPLY_GEOMETRY];
+    uint32_t values[1];
+
+    if (adopting)
+        adopted_windows++;
 
     i3Window *cwindow = scalloc(1, sizeof(i3Window));
     cwindow->id = window;
@@ -174,38 +369,34 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
     FREE(buttons);
 
     /* update as much information as possible so far (some replies may be NULL) */
-    window_update_class(cwindow, xcb_get_property_reply(conn, class_cookie, NULL), true);
-    window_update_name_legacy(cwindow, xcb_get_property_reply(conn, title_cookie, NULL), true);
-    window_update_name(cwindow, xcb_get_property_reply(conn, utf8_title_cookie, NULL), true);
-    window_update_leader(cwindow, xcb_get_property_reply(conn, leader_cookie, NULL));
-    window_update_transient_for(cwindow, xcb_get_property_reply(conn, transient_cookie, NULL));
-    window_update_strut_partial(cwindow, xcb_get_property_reply(conn, strut_cookie, NULL));
-    window_update_role(cwindow, xcb_get_property_reply(conn, role_cookie, NULL), true);
+    window_update_class(cwindow, manage_take_reply(pw, MANAGE_REPLY_CLASS), true);
+    window_update_name_legacy(cwindow, manage_take_reply(pw, MANAGE_REPLY_TITLE), true);
+    window_update_name(cwindow, manage_take_reply(pw, MANAGE_REPLY_UTF8_TITLE), true);
+    window_update_leader(cwindow, manage_take_reply(pw, MANAGE_REPLY_LEADER));
+    window_update_transient_for(cwindow, manage_take_reply(pw, MANAGE_REPLY_TRANSIENT));
+    window_update_strut_partial(cwindow, manage_take_reply(pw, MANAGE_REPLY_STRUT));
+    window_update_role(cwindow, manage_take_reply(pw, MANAGE_REPLY_ROLE), true);
     bool urgency_hint;
-    window_update_hints(cwindow, xcb_get_property_reply(conn, wm_hints_cookie, NULL), &urgency_hint);
+    window_update_hints(cwindow, manage_take_reply(pw, MANAGE_REPLY_WM_HINTS), &urgency_hint);
     border_style_t motif_border_style = BS_NORMAL;
-    window_update_motif_hints(cwindow, xcb_get_property_reply(conn, motif_wm_hints_cookie, NULL), &motif_border_style);
-    window_update_normal_hints(cwindow, xcb_get_property_reply(conn, wm_normal_hints_cookie, NULL), geom);
-    xcb_get_property_reply_t *type_reply = xcb_get_property_reply(conn, wm_type_cookie, NULL);
-    xcb_get_property_reply_t *state_reply = xcb_get_property_reply(conn, state_cookie, NULL);
-
-    xcb_get_property_reply_t *startup_id_reply;
-    startup_id_reply = xcb_get_property_reply(conn, startup_id_cookie, NULL);
-    char *startup_ws = startup_workspace_for_window(cwindow, startup_id_reply);
+    window_update_motif_hints(cwindow, manage_take_reply(pw, MANAGE_REPLY_MOTIF_WM_HINTS), &motif_border_style);
+    window_update_normal_hints(cwindow, manage_take_reply(pw, MANAGE_REPLY_WM_NORMAL_HINTS), geom);
+    xcb_get_property_reply_t *type_reply = manage_take_reply(pw, MANAGE_REPLY_WM_TYPE);
+    xcb_get_property_reply_t *state_reply = manage_take_reply(pw, MANAGE_REPLY_STATE);
+
+    char *startup_ws = startup_workspace_for_window(cwindow, manage_take_reply(pw, MANAGE_REPLY_STARTUP_ID));
     DLOG("startup workspace = %s\n", startup_ws);
 
     /* Get _NET_WM_DESKTOP if it was set. */
-    xcb_get_property_reply_t *wm_desktop_reply;
-    wm_desktop_reply = xcb_get_property_reply(conn, wm_desktop_cookie, NULL);
+    xcb_get_property_reply_t *wm_desktop_reply = pw->reply[MANAGE_REPLY_WM_DESKTOP];
     cwindow->wm_desktop = NET_WM_DESKTOP_NONE;
     if (wm_desktop_reply != NULL && xcb_get_property_value_length(wm_desktop_reply) != 0) {
         uint32_t *wm_desktops = xcb_get_property_value(wm_desktop_reply);
         cwindow->wm_desktop = (int32_t)wm_desktops[0];
     }
-    FREE(wm_desktop_reply);
 
     /* check if the window needs WM_TAKE_FOCUS */
-    cwindow->needs_take_focus = window_supports_protocol(cwindow->id, A_WM_TAKE_FOCUS);
+    cwindow->needs_take_focus = manage_supports_protocol(pw, A_WM_TAKE_FOCUS);
 
     /* read the preferred _NET_WM_WINDOW_TYPE atom */
     cwindow->window_type = xcb_get_preferred_window_type(type_reply);
@@ -351,6 +542,7 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
     }
     xcb_window_t old_frame = XCB_NONE;
     if (nc->window != cwindow && nc->window != NULL) {
+        con_unindex_window(nc);
         window_free(nc->window);
         /* Match frame and window depth. This is needed because X will refuse to reparent a
          * window whose background is ParentRelative under a window with a different depth. */
@@ -361,6 +553,7 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
         }
     }
     nc->window = cwindow;
+    con_index_window(nc);
     x_reinit(nc);
 
     nc->border_width = geom->border_width;
@@ -532,11 +725,13 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
     values[0] = XCB_NONE;
     xcb_change_window_attributes(conn, window, XCB_CW_EVENT_MASK, values);
 
-    xcb_void_cookie_t rcookie = xcb_reparent_window_checked(conn, window, nc->frame.id, 0, 0);
-    if (xcb_request_check(conn, rcookie) != NULL) {
-        LOG("Could not reparent the window, aborting\n");
-        goto geom_out;
-    }
+    /* Whether this worked is checked in manage_process_pending() without
+     * waiting for it here. The GetInputFocus request ensures that the result
+     * of the ReparentWindow request is known once its reply arrives. */
+    manage_request(pw, MANAGE_REPLY_REPARENT,
+                   xcb_reparent_window_checked(conn, window, nc->frame.id, 0, 0).sequence);
+    manage_request(pw, MANAGE_REPLY_SYNC, xcb_get_input_focus(conn).sequence);
+    pw->stage = MANAGE_REPARENT;
 
     values[0] = CHILD_EVENT_MASK & ~XCB_EVENT_MASK_ENTER_WINDOW;
     xcb_change_window_attributes(conn, window, XCB_CW_EVENT_MASK, values);
@@ -548,24 +743,14 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
      * cleanup) */
     xcb_change_save_set(conn, XCB_SET_MODE_INSERT, window);
 
-    if (shape_supported) {
-        /* Receive ShapeNotify events whenever the client altered its window
-         * shape. */
-        xcb_shape_select_input(conn, window, true);
-
-        /* Check if the window is shaped. Sadly, we can check only for the
-         * bounding shape, not for the input shape. */
-        xcb_shape_query_extents_cookie_t cookie =
-            xcb_shape_query_extents(conn, window);
-        xcb_shape_query_extents_reply_t *reply =
-            xcb_shape_query_extents_reply(conn, cookie, NULL);
-        if (reply != NULL && reply->bounding_shaped) {
-            cwindow->shaped = true;
-        }
-        FREE(reply);
+    xcb_shape_query_extents_reply_t *shape_reply = pw->reply[MANAGE_REPLY_SHAPE_EXTENTS];
+    if (shape_reply != NULL && shape_reply->bounding_shaped) {
+        cwindow->shaped = true;
     }
 
-    /* Check if any assignments match */
+    /* Check if any assignments match. The commands are run as a batch, so
+     * that the tree is only rendered once, at the end of this function. */
+    command_batch_begin();
     run_assignments(cwindow);
 
     /* 'ws' may be invalid because of the assignments, e.g. when the user uses
@@ -592,7 +777,8 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
          * con_move_to_workspace). */
         set_focus = false;
     }
-    render_con(croot, false);
+    if (!adopting)
+        render_con(croot, false);
 
     /* Send an event about window creation */
     ipc_send_window_event("new", nc);
@@ -613,17 +799,13 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
         DLOG("Checking con = %p for _NET_WM_USER_TIME.\n", nc);
 
         uint32_t *wm_user_time;
-        xcb_get_property_reply_t *wm_user_time_reply = xcb_get_property_reply(conn, wm_user_time_cookie, NULL);
+        xcb_get_property_reply_t *wm_user_time_reply = pw->reply[MANAGE_REPLY_WM_USER_TIME];
         if (wm_user_time_reply != NULL && xcb_get_property_value_length(wm_user_time_reply) != 0 &&
             (wm_user_time = xcb_get_property_value(wm_user_time_reply)) &&
             wm_user_time[0] == 0) {
             DLOG("_NET_WM_USER_TIME set to 0, not focusing con = %p.\n", nc);
             set_focus = false;
         }
-
-        FREE(wm_user_time_reply);
-    } else {
-        xcb_discard_reply(conn, wm_user_time_cookie.sequence);
     }
 
     if (set_focus) {
@@ -639,12 +821,18 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
 
     /* Defer setting focus after the 'new' event has been sent to ensure the
      * proper window event sequence. */
-    if (set_focus && nc->mapped) {
+    if (set_focus && adopting) {
+        adopted_focus = nc;
+    } else if (set_focus && nc->mapped) {
         DLOG("Now setting focus.\n");
         con_activate(nc);
     }
 
-    tree_render();
+    /* We render unconditionally, so whether the assignments need a render is
+     * irrelevant. */
+    command_batch_end();
+    if (!adopting)
+        tree_render();
 
     /* Destroy the old frame if we had to reframe the container. This needs to be done
      * after rendering in order to prevent the background from flickering in its place. */
@@ -660,13 +848,199 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
 
     /* Update _NET_WM_DESKTOP. We invalidate the cached value first to force an update. */
     cwindow->wm_desktop = NET_WM_DESKTOP_NONE;
-    ewmh_update_wm_desktop();
+    ewmh_update_wm_desktop_con(nc);
 
     /* If a sticky window was mapped onto another workspace, make sure to pop it to the front. */
     output_push_sticky_windows(focused);
+}
+
+/*
+ * Checks whether reparenting the window worked. If it did not (because the
+ * window was destroyed in the meantime), the container is closed again.
+ *
+ */
+static void manage_check_reparent(pending_window *pw) {
+    if (!pw->failed[MANAGE_REPLY_REPARENT])
+        return;
 
-geom_out:
-    free(geom);
-out:
-    free(attr);
+    LOG("Could not reparent window 0x%08x, closing its container\n", pw->window);
+    Con *con = con_by_window_id(pw->window);
+    if (con != NULL) {
+        tree_close_internal(con, DONT_KILL_WINDOW, false);
+        tree_render();
+    }
+}
+
+/*
+ * Advances the state machine of the given window as far as possible without
+ * waiting. Windows are only placed in the order in which they were mapped
+ * (in_order is true for the first window which is not placed yet), so that
+ * the layout does not depend on the order in which the replies arrive.
+ * Sets *progress if a reply was collected or the window changed its stage.
+ * Returns false if pw was freed.
+ *
+ */
+static bool manage_step(pending_window *pw, bool in_order, bool *progress) {
+    if (pw->stage == MANAGE_ATTRIBUTES) {
+        if (!manage_poll(pw, MANAGE_REPLY_ATTRIBUTES, MANAGE_REPLY_GEOMETRY, false, progress))
+            return true;
+        *progress = true;
+        if (!manage_request_properties(pw)) {
+            manage_free(pw);
+            return false;
+        }
+    }
+
+    if (pw->stage == MANAGE_PROPERTIES) {
+        if (!in_order || !manage_poll(pw, MANAGE_REPLY_WM_TYPE, MANAGE_REPLY_EVENT_MASK, false, progress))
+            return true;
+        *progress = true;
+        if (pw->failed[MANAGE_REPLY_EVENT_MASK]) {
+            LOG("Could not change event mask, the window probably already disappeared.\n");
+            manage_free(pw);
+            return false;
+        }
+        manage_place(pw);
+        return true;
+    }
+
+    if (!manage_poll(pw, MANAGE_REPLY_SYNC, MANAGE_REPLY_REPARENT, false, progress))
+        return true;
+    *progress = true;
+    manage_check_reparent(pw);
+    manage_free(pw);
+    return false;
+}
+
+/*
+ * Handles all windows which are being managed and whose replies arrived.
+ * Called by the main loop before it waits for new events. Returns true if any
+ * reply was collected or any window advanced, since collecting replies might
+ * have read new events from X11 as well.
+ *
+ */
+bool manage_process_pending(void) {
+    bool progress = false;
+    bool in_order = true;
+    pending_window *pw, *next;
+
+    for (pw = TAILQ_FIRST(&pending_windows); pw != NULL; pw = next) {
+        next = TAILQ_NEXT(pw, pending_windows);
+        if (pw->stage == MANAGE_REPARENT) {
+            manage_step(pw, in_order, &progress);
+            continue;
+        }
+
+        if (!manage_step(pw, in_order, &progress))
+            continue;
+        if (pw->stage != MANAGE_REPARENT)
+            in_order = false;
+    }
+
+    xcb_flush(conn);
+    return progress;
+}
+
+/*
+ * Waits until all windows which are being managed are put into the tree.
+ * Used when events need to see the result, e.g. ClientMessages.
+ *
+ */
+void manage_finish_pending(void) {
+    manage_process_pending();
+
+    pending_window *pw;
+    while ((pw = TAILQ_FIRST(&pending_windows)) != NULL) {
+        while (pw != NULL && pw->stage == MANAGE_REPARENT)
+            pw = TAILQ_NEXT(pw, pending_windows);
+        if (pw == NULL)
+            break;
+
+        /* Only wait for the first window, the replies for all others are
+         * collected (and their next requests sent) by
+         * manage_process_pending() meanwhile. */
+        if (pw->stage == MANAGE_ATTRIBUTES)
+            manage_poll(pw, MANAGE_REPLY_ATTRIBUTES, MANAGE_REPLY_GEOMETRY, true, NULL);
+        else
+            manage_poll(pw, MANAGE_REPLY_WM_TYPE, MANAGE_REPLY_EVENT_MASK, true, NULL);
+        manage_process_pending();
+    }
+}
+
+/*
+ * Returns true if the given window is being managed but not yet part of the
+ * tree.
+ *
+ */
+bool manage_window_is_pending(xcb_window_t window) {
+    return (manage_pending_for(window) != NULL);
+}
+
+/*
+ * Stops managing the given window if it is not yet part of the tree, e.g.
+ * because it was unmapped or destroyed. Returns true if the window was being
+ * managed.
+ *
+ */
+bool manage_window_cancel(xcb_window_t window) {
+    pending_window *pw = manage_pending_for(window);
+    if (pw == NULL)
+        return false;
+
+    DLOG("Window 0x%08x disappeared before it was managed\n", window);
+    manage_free(pw);
+    return true;
+}
+
+/*
+ * Go through all existing windows (if the window manager is restarted) and manage them
+ *
+ * All requests for all windows are pipelined: the attributes and geometry of
+ * every window are requested first, then the properties of every window which
+ * is to be managed. The tree is rendered once, after all windows are placed.
+ *
+ */
+void manage_existing_windows(xcb_window_t root) {
+    xcb_query_tree_reply_t *reply;
+    int i, len;
+    xcb_window_t *children;
+    const ev_tstamp start = ev_time();
+
+    /* Get the tree of windows whose parent is the root window (= all) */
+    if ((reply = xcb_query_tree_reply(conn, xcb_query_tree(conn, root), 0)) == NULL)
+        return;
+
+    len = xcb_query_tree_children_length(reply);
+
+    /* Request the window attributes (and geometry) for every window */
+    children = xcb_query_tree_children(reply);
+    for (i = 0; i < len; ++i)
+        manage_window(children[i], xcb_get_window_attributes(conn, children[i]), true);
+
+    /* Replies arrive in order, so once the attributes and geometry of the
+     * last window are there, the properties of all windows can be requested
+     * at once. */
+    pending_window *last = TAILQ_LAST(&pending_windows, pending_windows_head);
+    if (last != NULL && last->stage == MANAGE_ATTRIBUTES)
+        manage_poll(last, MANAGE_REPLY_ATTRIBUTES, MANAGE_REPLY_GEOMETRY, true, NULL);
+
+    /* The rest of the startup code expects these windows to be managed. */
+    adopting = true;
+    adopted_windows = 0;
+    adopted_focus = NULL;
+    manage_finish_pending();
+    adopting = false;
+
+    if (adopted_focus != NULL && con_exists(adopted_focus)) {
+        DLOG("Now setting focus.\n");
+        con_activate(adopted_focus);
+        adopted_focus = NULL;
+    }
+
+    tree_render();
+
+    LOG("Adopted %d of %d existing windows in %.1f ms\n",
+        adopted_windows, len, (ev_time() - start) * 1000);
+
+    free(reply);
 }
@@ -81,36 +81,62 @@ void match_copy(Match *dest, Match *src) {
 }
 
 /*
- * Check if a match data structure matches the given window.
+ * Returns true if both matches specify the same criteria.
  *
  */
-bool match_matches_window(Match *match, i3Window *window) {
-    LOG("Checking window 0x%08x (class %s)\n", window->id, window->class_class);
+bool match_equals(Match *a, Match *b) {
+#define SAME_REGEX(field)                                \
+    ((a->field == NULL || b->field == NULL)              \
+         ? (a->field == b->field)                        \
+         : strcmp(a->field->pattern, b->field->pattern) == 0)
+
+    return (SAME_REGEX(title) &&
+            SAME_REGEX(mark) &&
+            SAME_REGEX(application) &&
+            SAME_REGEX(class) &&
+            SAME_REGEX(instance) &&
+            SAME_REGEX(window_role) &&
+            SAME_REGEX(workspace) &&
+            a->window_type == b->window_type &&
+            a->urgent == b->urgent &&
+            a->dock == b->dock &&
+            a->id == b->id &&
+            a->window_mode == b->window_mode &&
+            a->con_id == b->con_id &&
+            a->insert_where == b->insert_where);
+#undef SAME_REGEX
+}
 
-#define GET_FIELD_str(field) (field)
-#define GET_FIELD_i3string(field) (i3string_as_utf8(field))
-#define CHECK_WINDOW_FIELD(match_field, window_field, type)                                       \
-    do {                                                                                          \
-        if (match->match_field != NULL) {                                                         \
-            if (window->window_field == NULL) {                                                   \
-                return false;                                                                     \
-            }                                                                                     \
-                                                                                                  \
-            const char *window_field_str = GET_FIELD_##type(window->window_field);                \
-            if (strcmp(match->match_field->pattern, "__focused__") == 0 &&                        \
-                focused && focused->window && focused->window->window_field &&                    \
-                strcmp(window_field_str, GET_FIELD_##type(focused->window->window_field)) == 0) { \
-                LOG("window " #match_field " matches focused window\n");                          \
-            } else if (regex_matches(match->match_field, window_field_str)) {                     \
-                LOG("window " #match_field " matches (%s)\n", window_field_str);                  \
-            } else {                                                                              \
-                return false;                                                                     \
-            }                                                                                     \
-        }                                                                                         \
-    } while (0)
+/*
+ * Returns true if the given (urgent) window is the window which became urgent
+ * most recently (for U_LATEST) or longest ago (for U_OLDEST), or became urgent
+ * at the same time.
+ *
+ */
+static bool match_is_urgent_extreme(Match *match, i3Window *window) {
+    Con *con;
+    TAILQ_FOREACH(con, &all_cons, all_cons) {
+        if (con->window == NULL || con->window->urgent.tv_sec == 0)
+            continue;
+        /* if we find a window that is newer (older) than this one, bail */
+        if (match->urgent == U_LATEST &&
+            _i3_timercmp(con->window->urgent, window->urgent, >))
+            return false;
+        if (match->urgent == U_OLDEST &&
+            _i3_timercmp(con->window->urgent, window->urgent, <))
+            return false;
+    }
+    return true;
+}
 
-    CHECK_WINDOW_FIELD(class, class_class, str);
-    CHECK_WINDOW_FIELD(instance, class_instance, str);
+/*
+ * Checks the given window against the match. The criteria which are cheap to
+ * check come first. con is the container of the window, it is looked up only
+ * if a criterion needs it and it is NULL.
+ *
+ */
+static bool match_matches(Match *match, i3Window *window, Con *con) {
+    LOG("Checking window 0x%08x (class %s)\n", window->id, window->class_class);
 
     if (match->id != XCB_NONE) {
         if (window->id == match->id) {
@@ -121,9 +147,6 @@ bool match_matches_window(Match *match, i3Window *window) {
         }
     }
 
-    CHECK_WINDOW_FIELD(title, name, i3string);
-    CHECK_WINDOW_FIELD(window_role, role, str);
-
     if (match->window_type != UINT32_MAX) {
         if (window->window_type == match->window_type) {
             LOG("window_type matches (%i)\n", match->window_type);
@@ -132,42 +155,52 @@ bool match_matches_window(Match *match, i3Window *window) {
         }
     }
 
-    Con *con = NULL;
-    if (match->urgent == U_LATEST) {
-        /* if the window isn't urgent, no sense in searching */
-        if (window->urgent.tv_sec == 0) {
+    if (match->dock != M_DONTCHECK) {
+        if ((window->dock == W_DOCK_TOP && match->dock == M_DOCK_TOP) ||
+            (window->dock == W_DOCK_BOTTOM && match->dock == M_DOCK_BOTTOM) ||
+            ((window->dock == W_DOCK_TOP || window->dock == W_DOCK_BOTTOM) &&
+             match->dock == M_DOCK_ANY) ||
+            (window->dock == W_NODOCK && match->dock == M_NODOCK)) {
+            LOG("dock status matches\n");
+        } else {
+            LOG("dock status does not match\n");
             return false;
         }
-        /* if we find a window that is newer than this one, bail */
-        TAILQ_FOREACH(con, &all_cons, all_cons) {
-            if ((con->window != NULL) &&
-                _i3_timercmp(con->window->urgent, window->urgent, >)) {
-                return false;
-            }
-        }
-        LOG("urgent matches latest\n");
     }
 
-    if (match->urgent == U_OLDEST) {
-        /* if the window isn't urgent, no sense in searching */
-        if (window->urgent.tv_sec == 0) {
-            return false;
-        }
-        /* if we find a window that is older than this one (and not 0), bail */
-        TAILQ_FOREACH(con, &all_cons, all_cons) {
-            if ((con->window != NULL) &&
-                (con->window->urgent.tv_sec != 0) &&
-                _i3_timercmp(con->window->urgent, window->urgent, <)) {
-                return false;
-            }
-        }
-        LOG("urgent matches oldest\n");
-    }
+#define GET_FIELD_str(field) (field)
+#define GET_FIELD_i3string(field) (i3string_as_utf8(field))
+#define CHECK_WINDOW_FIELD(match_field, window_field, type, generation)                           \
+    do {                                                                                          \
+        if (match->match_field != NULL) {                                                         \
+            if (window->window_field == NULL) {                                                   \
+                return false;                                                                     \
+            }                                                                                     \
+                                                                                                  \
+            const char *window_field_str = GET_FIELD_##type(window->window_field);                \
+            if (strcmp(match->match_field->pattern, "__focused__") == 0 &&                        \
+                focused && focused->window && focused->window->window_field &&                    \
+                strcmp(window_field_str, GET_FIELD_##type(focused->window->window_field)) == 0) { \
+                LOG("window " #match_field " matches focused window\n");                          \
+            } else if (regex_matches_cached(match->match_field, window_field_str,                 \
+                                            window, window->generation)) {                        \
+                LOG("window " #match_field " matches (%s)\n", window_field_str);                  \
+            } else {                                                                              \
+                return false;                                                                     \
+            }                                                                                     \
+        }                                                                                         \
+    } while (0)
 
-    if (match->workspace != NULL) {
-        if ((con = con_by_window_id(window->id)) == NULL)
-            return false;
+    CHECK_WINDOW_FIELD(class, class_class, str, class_generation);
+    CHECK_WINDOW_FIELD(instance, class_instance, str, class_generation);
+    CHECK_WINDOW_FIELD(title, name, i3string, name_generation);
+    CHECK_WINDOW_FIELD(window_role, role, str, role_generation);
 
+    if ((match->workspace != NULL || match->mark != NULL || match->window_mode != WM_ANY) &&
+        con == NULL && (con = con_by_window_id(window->id)) == NULL)
+        return false;
+
+    if (match->workspace != NULL) {
         Con *ws = con_get_workspace(con);
         if (ws == NULL)
             return false;
@@ -182,23 +215,7 @@ bool match_matches_window(Match *match, i3Window *window) {
         }
     }
 
-    if (match->dock != M_DONTCHECK) {
-        if ((window->dock == W_DOCK_TOP && match->dock == M_DOCK_TOP) ||
-            (window->dock == W_DOCK_BOTTOM && match->dock == M_DOCK_BOTTOM) ||
-            ((window->dock == W_DOCK_TOP || window->dock == W_DOCK_BOTTOM) &&
-             match->dock == M_DOCK_ANY) ||
-            (window->dock == W_NODOCK && match->dock == M_NODOCK)) {
-            LOG("dock status matches\n");
-        } else {
-            LOG("dock status does not match\n");
-            return false;
-        }
-    }
-
     if (match->mark != NULL) {
-        if ((con = con_by_window_id(window->id)) == NULL)
-            return false;
-
         bool matched = false;
         mark_t *mark;
         TAILQ_FOREACH(mark, &(con->marks_head), marks) {
@@ -217,9 +234,6 @@ bool match_matches_window(Match *match, i3Window *window) {
     }
 
     if (match->window_mode != WM_ANY) {
-        if ((con = con_by_window_id(window->id)) == NULL)
-            return false;
-
         const bool floating = (con_inside_floating(con) != NULL);
 
         if ((match->window_mode == WM_TILING && floating) ||
@@ -231,9 +245,38 @@ bool match_matches_window(Match *match, i3Window *window) {
         LOG("window_mode matches\n");
     }
 
+    /* The urgency criteria need to look at all windows, so they come last. */
+    if (match->urgent == U_LATEST || match->urgent == U_OLDEST) {
+        /* if the window isn't urgent, no sense in searching */
+        if (window->urgent.tv_sec == 0) {
+            return false;
+        }
+        if (!match_is_urgent_extreme(match, window)) {
+            return false;
+        }
+        LOG("urgent matches %s\n", (match->urgent == U_LATEST ? "latest" : "oldest"));
+    }
+
     return true;
 }
 
+/*
+ * Check if a match data structure matches the given window.
+ *
+ */
+bool match_matches_window(Match *match, i3Window *window) {
+    return match_matches(match, window, NULL);
+}
+
+/*
+ * Like match_matches_window(), but for the window of the given container,
+ * which saves looking up the container of the window.
+ *
+ */
+bool match_matches_con(Match *match, Con *con) {
+    return match_matches(match, con->window, con);
+}
+
 /*
  * Frees the given match. It must not be used afterwards!
  *
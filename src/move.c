@@ -235,11 +235,11 @@ static void move_to_output_directed(Con *con, direction_t direction) {
     }
 
     /* force re-painting the indicators */
-    FREE(con->deco_render_params);
+    con->deco_render_params_valid = false;
 
     tree_flatten(croot);
     ipc_send_window_event("move", con);
-    ewmh_update_wm_desktop();
+    ewmh_update_wm_desktop_con(con);
 }
 
 /*
@@ -383,9 +383,10 @@ void tree_move(Con *con, int direction) {
 
 end:
     /* force re-painting the indicators */
-    FREE(con->deco_render_params);
+    con->deco_render_params_valid = false;
+    con_mark_dirty(con);
 
     tree_flatten(croot);
     ipc_send_window_event("move", con);
-    ewmh_update_wm_desktop();
+    ewmh_update_wm_desktop_con(con);
 }
@@ -542,6 +542,78 @@ static void output_change_mode(xcb_connection_t *conn, Output *output) {
     }
 }
 
+/*
+ * Returns the refresh rate (in millihertz) of the mode which the given CRTC
+ * currently uses, or 0 if it cannot be determined.
+ *
+ */
+static uint32_t crtc_refresh_rate(xcb_randr_get_crtc_info_reply_t *crtc,
+                                  xcb_randr_get_screen_resources_current_reply_t *res) {
+    if (crtc == NULL || res == NULL || crtc->mode == XCB_NONE)
+        return 0;
+
+    xcb_randr_mode_info_iterator_t iter;
+    for (iter = xcb_randr_get_screen_resources_current_modes_iterator(res);
+         iter.rem;
+         xcb_randr_mode_info_next(&iter)) {
+        const xcb_randr_mode_info_t *mode = iter.data;
+        if (mode->id != crtc->mode)
+            continue;
+
+        uint64_t lines = mode->vtotal;
+        if (mode->mode_flags & XCB_RANDR_MODE_FLAG_DOUBLE_SCAN)
+            lines *= 2;
+        if (mode->mode_flags & XCB_RANDR_MODE_FLAG_INTERLACE)
+            lines /= 2;
+        if (mode->htotal == 0 || lines == 0)
+            return 0;
+
+        return (uint32_t)(((uint64_t)mode->dot_clock * 1000) / (mode->htotal * lines));
+    }
+
+    return 0;
+}
+
+#if XCB_RANDR_MINOR_VERSION >= 5
+/*
+ * Returns the highest refresh rate (in millihertz) of the outputs which make
+ * up the given monitor, or 0 if it cannot be determined.
+ *
+ */
+static uint32_t monitor_refresh_rate(const xcb_randr_monitor_info_t *monitor_info,
+                                     xcb_randr_get_screen_resources_current_reply_t *res,
+                                     xcb_timestamp_t timestamp) {
+    uint32_t refresh_rate = 0;
+    if (res == NULL)
+        return 0;
+
+    xcb_randr_output_t *randr_outputs = xcb_randr_monitor_info_outputs(monitor_info);
+    int randr_output_len = xcb_randr_monitor_info_outputs_length(monitor_info);
+    for (int i = 0; i < randr_output_len; i++) {
+        xcb_randr_get_output_info_reply_t *output =
+            xcb_randr_get_output_info_reply(conn,
+                                            xcb_randr_get_output_info(conn, randr_outputs[i], timestamp),
+                                            NULL);
+        if (output == NULL)
+            continue;
+
+        if (output->crtc != XCB_NONE) {
+            xcb_randr_get_crtc_info_reply_t *crtc =
+                xcb_randr_get_crtc_info_reply(conn,
+                                              xcb_randr_get_crtc_info(conn, output->crtc, timestamp),
+                                              NULL);
+            const uint32_t rate = crtc_refresh_rate(crtc, res);
+            if (rate > refresh_rate)
+                refresh_rate = rate;
+            free(crtc);
+        }
+        free(output);
+    }
+
+    return refresh_rate;
+}
+#endif
+
 /*
  * randr_query_outputs_15 uses RandR ≥ 1.5 to update outputs.
  *
@@ -558,12 +630,18 @@ static bool randr_query_outputs_15(void) {
      * disabled by the user) */
     DLOG("Querying outputs using RandR 1.5\n");
     xcb_generic_error_t *err;
+    xcb_randr_get_screen_resources_current_cookie_t rcookie =
+        xcb_randr_get_screen_resources_current(conn, root);
     xcb_randr_get_monitors_reply_t *monitors =
         xcb_randr_get_monitors_reply(
             conn, xcb_randr_get_monitors(conn, root, true), &err);
+    /* Only used for the refresh rates of the monitors. */
+    xcb_randr_get_screen_resources_current_reply_t *res =
+        xcb_randr_get_screen_resources_current_reply(conn, rcookie, NULL);
     if (err != NULL) {
         ELOG("Could not get RandR monitors: X11 error code %d\n", err->error_code);
         free(err);
+        free(res);
         /* Fall back to RandR ≤ 1.4 */
         return false;
     }
@@ -658,6 +736,8 @@ static bool randr_query_outputs_15(void) {
             update_if_necessary(&(new->rect.width), monitor_info->width) |
             update_if_necessary(&(new->rect.height), monitor_info->height);
 
+        new->refresh_rate = monitor_refresh_rate(monitor_info, res, monitors->timestamp);
+
         DLOG("name %s, x %d, y %d, width %d px, height %d px, width %d mm, height %d mm, primary %d, automatic %d\n",
              name,
              monitor_info->x, monitor_info->y, monitor_info->width, monitor_info->height,
@@ -666,6 +746,7 @@ static bool randr_query_outputs_15(void) {
         free(name);
     }
     free(monitors);
+    free(res);
     return true;
 #endif
 }
@@ -734,6 +815,7 @@ static void handle_output(xcb_connection_t *conn, xcb_randr_output_t id,
                    update_if_necessary(&(new->rect.y), crtc->y) |
                    update_if_necessary(&(new->rect.width), crtc->width) |
                    update_if_necessary(&(new->rect.height), crtc->height);
+    new->refresh_rate = crtc_refresh_rate(crtc, res);
     free(crtc);
     new->active = (new->rect.width != 0 && new->rect.height != 0);
     if (!new->active) {
@@ -9,6 +9,8 @@
  */
 #include "all.h"
 
+struct regex_stats regex_stats;
+
 /*
  * Creates a new 'regex' struct containing the given pattern and a PCRE
  * compiled regular expression. Also, calls pcre_study because this regex will
@@ -41,13 +43,30 @@ struct regex *regex_new(const char *pattern) {
         regex_free(re);
         return NULL;
     }
-    re->extra = pcre_study(re->regex, 0, &error);
+    /* Patterns like ^Firefox$ are very common in criteria. We recognize them
+     * so that they can be matched without running PCRE. */
+    const size_t len = strlen(pattern);
+    if (len >= 2 && pattern[0] == '^' && pattern[len - 1] == '$' &&
+        strcspn(pattern + 1, "\\^$.[]|()?*+{}") == len - 2) {
+        re->exact = sstrndup(pattern + 1, len - 2);
+    }
+    int study_options = 0;
+#ifdef PCRE_STUDY_JIT_COMPILE
+    study_options |= PCRE_STUDY_JIT_COMPILE;
+#endif
+    re->extra = pcre_study(re->regex, study_options, &error);
     /* If an error happened, we print the error message, but continue.
      * Studying the regular expression leads to faster matching, but it’s not
      * absolutely necessary. */
     if (error) {
         ELOG("PCRE regular expression studying failed: %s\n", error);
     }
+#ifdef PCRE_STUDY_JIT_COMPILE
+    int jit = 0;
+    if (re->extra != NULL && pcre_fullinfo(re->regex, re->extra, PCRE_INFO_JIT, &jit) == 0 && jit)
+        regex_stats.jit_compiled++;
+#endif
+    regex_stats.compiled++;
     return re;
 }
 
@@ -59,8 +78,14 @@ void regex_free(struct regex *regex) {
     if (!regex)
         return;
     FREE(regex->pattern);
+    FREE(regex->exact);
     FREE(regex->regex);
+#ifdef PCRE_STUDY_JIT_COMPILE
+    if (regex->extra != NULL)
+        pcre_free_study(regex->extra);
+#else
     FREE(regex->extra);
+#endif
     FREE(regex);
 }
 
@@ -73,6 +98,22 @@ void regex_free(struct regex *regex) {
 bool regex_matches(struct regex *regex, const char *input) {
     int rc;
 
+    regex_stats.evaluations++;
+
+    if (regex->exact != NULL) {
+        /* Just like PCRE, we allow a trailing newline before the '$'. */
+        const size_t len = strlen(regex->exact);
+        if (strncmp(input, regex->exact, len) == 0 &&
+            (input[len] == '\0' || (input[len] == '\n' && input[len + 1] == '\0'))) {
+            LOG("Regular expression \"%s\" matches \"%s\"\n",
+                regex->pattern, input);
+            return true;
+        }
+        LOG("Regular expression \"%s\" does not match \"%s\"\n",
+            regex->pattern, input);
+        return false;
+    }
+
     /* We use strlen() because pcre_exec() expects the length of the input
      * string in bytes */
     if ((rc = pcre_exec(regex->regex, regex->extra, input, strlen(input), 0, 0, NULL, 0)) == 0) {
@@ -91,3 +132,24 @@ bool regex_matches(struct regex *regex, const char *input) {
          rc, regex->pattern, input);
     return false;
 }
+
+/*
+ * Like regex_matches(), but caches the result for the given key (like the
+ * window which the input belongs to). As long as the generation of the input
+ * stays the same, the cached result is returned without evaluating the
+ * regular expression again. The generation must change whenever the input
+ * changes and must never be reused for a different input of the same key.
+ *
+ */
+bool regex_matches_cached(struct regex *regex, const char *input, const void *key, uint64_t generation) {
+    struct regex_cache_entry *entry = &(regex->cache[((uintptr_t)key / sizeof(void *)) % REGEX_CACHE_SIZE]);
+    if (entry->key == key && entry->generation == generation) {
+        regex_stats.cache_hits++;
+        return entry->result;
+    }
+
+    entry->key = key;
+    entry->generation = generation;
+    entry->result = regex_matches(regex, input);
+    return entry->result;
+}
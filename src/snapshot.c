@@ -0,0 +1,401 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved dynamic tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * snapshot.c: Compact binary serialization of the layout tree, used for
+ *             in-place restarts and the GET_TREE_SNAPSHOT IPC message.
+ *
+ */
+#include "all.h"
+
+#include <stdint.h>
+
+/* What the generator expects next at each nesting level. */
+typedef enum {
+    LEVEL_ARRAY = 0,
+    LEVEL_MAP_KEY = 1,
+    LEVEL_MAP_VALUE = 2,
+} level_t;
+
+struct snapshot_gen {
+    snapshot_token *tokens;
+    uint32_t num_tokens;
+    uint32_t tokens_capacity;
+
+    snapshot_string *strings;
+    uint32_t num_strings;
+    uint32_t strings_capacity;
+
+    char *data;
+    size_t data_size;
+    size_t data_capacity;
+
+    /* Open addressing hash table (linear probing) used to deduplicate
+     * strings. Each slot contains the string index + 1, 0 marks an empty
+     * slot. */
+    uint32_t *slots;
+    uint32_t slots_capacity;
+
+    uint8_t *levels;
+    uint32_t depth;
+    uint32_t levels_capacity;
+
+    unsigned char *buf;
+};
+
+/*
+ * Allocates a new snapshot generator. Its functions mirror the yajl_gen API
+ * so that dump_node() can write either format.
+ *
+ */
+snapshot_gen *snapshot_gen_alloc(void) {
+    return scalloc(1, sizeof(snapshot_gen));
+}
+
+/*
+ * Frees the snapshot generator and its buffer.
+ *
+ */
+void snapshot_gen_free(snapshot_gen *gen) {
+    free(gen->tokens);
+    free(gen->strings);
+    free(gen->data);
+    free(gen->slots);
+    free(gen->levels);
+    free(gen->buf);
+    free(gen);
+}
+
+static snapshot_token *snapshot_gen_token(snapshot_gen *gen, snapshot_token_t type) {
+    if (gen->num_tokens == gen->tokens_capacity) {
+        gen->tokens_capacity = (gen->tokens_capacity == 0 ? 256 : gen->tokens_capacity * 2);
+        gen->tokens = srealloc(gen->tokens, gen->tokens_capacity * sizeof(snapshot_token));
+    }
+    snapshot_token *token = &(gen->tokens[gen->num_tokens++]);
+    memset(token, 0, sizeof(snapshot_token));
+    token->type = type;
+    return token;
+}
+
+/*
+ * Called for every value (including maps and arrays) to keep track of whether
+ * the next string within a map is a key or a value.
+ *
+ */
+static void snapshot_gen_value(snapshot_gen *gen) {
+    if (gen->depth > 0 && gen->levels[gen->depth - 1] == LEVEL_MAP_VALUE) {
+        gen->levels[gen->depth - 1] = LEVEL_MAP_KEY;
+    }
+}
+
+static void snapshot_gen_push(snapshot_gen *gen, level_t level) {
+    if (gen->depth == gen->levels_capacity) {
+        gen->levels_capacity = (gen->levels_capacity == 0 ? 32 : gen->levels_capacity * 2);
+        gen->levels = srealloc(gen->levels, gen->levels_capacity);
+    }
+    gen->levels[gen->depth++] = level;
+}
+
+static void snapshot_gen_pop(snapshot_gen *gen) {
+    assert(gen->depth > 0);
+    gen->depth--;
+}
+
+static uint32_t snapshot_hash(const unsigned char *str, size_t len) {
+    return (uint32_t)fnv1a_64(FNV1A_64_OFFSET_BASIS, str, len);
+}
+
+static void snapshot_gen_rehash(snapshot_gen *gen) {
+    free(gen->slots);
+    gen->slots_capacity = (gen->slots_capacity == 0 ? 256 : gen->slots_capacity * 2);
+    gen->slots = scalloc(gen->slots_capacity, sizeof(uint32_t));
+    const uint32_t mask = gen->slots_capacity - 1;
+    for (uint32_t i = 0; i < gen->num_strings; i++) {
+        const snapshot_string *string = &(gen->strings[i]);
+        uint32_t slot = snapshot_hash((const unsigned char *)gen->data + string->offset, string->length) & mask;
+        while (gen->slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        gen->slots[slot] = i + 1;
+    }
+}
+
+/*
+ * Returns the index of the given string in the string table, adding it if it
+ * is not yet contained.
+ *
+ */
+static uint32_t snapshot_gen_intern(snapshot_gen *gen, const unsigned char *str, size_t len) {
+    if ((gen->num_strings + 1) * 4 > gen->slots_capacity * 3) {
+        snapshot_gen_rehash(gen);
+    }
+
+    const uint32_t mask = gen->slots_capacity - 1;
+    uint32_t slot = snapshot_hash(str, len) & mask;
+    while (gen->slots[slot] != 0) {
+        const snapshot_string *string = &(gen->strings[gen->slots[slot] - 1]);
+        if (string->length == len && memcmp(gen->data + string->offset, str, len) == 0) {
+            return gen->slots[slot] - 1;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (gen->data_size + len + 1 > gen->data_capacity) {
+        while (gen->data_size + len + 1 > gen->data_capacity) {
+            gen->data_capacity = (gen->data_capacity == 0 ? 4096 : gen->data_capacity * 2);
+        }
+        gen->data = srealloc(gen->data, gen->data_capacity);
+    }
+    if (gen->num_strings == gen->strings_capacity) {
+        gen->strings_capacity = (gen->strings_capacity == 0 ? 128 : gen->strings_capacity * 2);
+        gen->strings = srealloc(gen->strings, gen->strings_capacity * sizeof(snapshot_string));
+    }
+    assert(gen->data_size + len < UINT32_MAX);
+
+    snapshot_string *string = &(gen->strings[gen->num_strings]);
+    string->offset = gen->data_size;
+    string->length = len;
+    memcpy(gen->data + gen->data_size, str, len);
+    gen->data[gen->data_size + len] = '\0';
+    gen->data_size += len + 1;
+
+    gen->slots[slot] = ++(gen->num_strings);
+    return gen->num_strings - 1;
+}
+
+void snapshot_gen_map_open(snapshot_gen *gen) {
+    snapshot_gen_value(gen);
+    snapshot_gen_token(gen, SNAP_MAP_OPEN);
+    snapshot_gen_push(gen, LEVEL_MAP_KEY);
+}
+
+void snapshot_gen_map_close(snapshot_gen *gen) {
+    snapshot_gen_token(gen, SNAP_MAP_CLOSE);
+    snapshot_gen_pop(gen);
+}
+
+void snapshot_gen_array_open(snapshot_gen *gen) {
+    snapshot_gen_value(gen);
+    snapshot_gen_token(gen, SNAP_ARRAY_OPEN);
+    snapshot_gen_push(gen, LEVEL_ARRAY);
+}
+
+void snapshot_gen_array_close(snapshot_gen *gen) {
+    snapshot_gen_token(gen, SNAP_ARRAY_CLOSE);
+    snapshot_gen_pop(gen);
+}
+
+void snapshot_gen_integer(snapshot_gen *gen, long long number) {
+    snapshot_gen_value(gen);
+    snapshot_gen_token(gen, SNAP_INTEGER)->value.integer = number;
+}
+
+void snapshot_gen_double(snapshot_gen *gen, double number) {
+    snapshot_gen_value(gen);
+    snapshot_gen_token(gen, SNAP_DOUBLE)->value.number = number;
+}
+
+void snapshot_gen_bool(snapshot_gen *gen, int boolean) {
+    snapshot_gen_value(gen);
+    snapshot_gen_token(gen, SNAP_BOOL)->value.integer = (boolean != 0);
+}
+
+void snapshot_gen_null(snapshot_gen *gen) {
+    snapshot_gen_value(gen);
+    snapshot_gen_token(gen, SNAP_NULL);
+}
+
+void snapshot_gen_string(snapshot_gen *gen, const unsigned char *str, size_t len) {
+    const uint32_t index = snapshot_gen_intern(gen, str, len);
+    if (gen->depth > 0 && gen->levels[gen->depth - 1] == LEVEL_MAP_KEY) {
+        gen->levels[gen->depth - 1] = LEVEL_MAP_VALUE;
+        snapshot_gen_token(gen, SNAP_KEY)->string = index;
+    } else {
+        snapshot_gen_value(gen);
+        snapshot_gen_token(gen, SNAP_STRING)->string = index;
+    }
+}
+
+/*
+ * Returns the serialized snapshot. The buffer is owned by the generator and
+ * stays valid until the next call of any snapshot_gen function.
+ *
+ */
+void snapshot_gen_get_buf(snapshot_gen *gen, const unsigned char **buf, size_t *len) {
+    const size_t tokens_size = gen->num_tokens * sizeof(snapshot_token);
+    const size_t strings_size = gen->num_strings * sizeof(snapshot_string);
+    *len = sizeof(snapshot_header) + tokens_size + strings_size + gen->data_size;
+
+    free(gen->buf);
+    gen->buf = smalloc(*len);
+
+    snapshot_header header = {
+        .magic = SNAPSHOT_MAGIC,
+        .version = SNAPSHOT_VERSION,
+        .num_tokens = gen->num_tokens,
+        .num_strings = gen->num_strings,
+        .strings_size = gen->data_size};
+    unsigned char *walk = gen->buf;
+    memcpy(walk, &header, sizeof(snapshot_header));
+    walk += sizeof(snapshot_header);
+    if (tokens_size > 0) {
+        memcpy(walk, gen->tokens, tokens_size);
+        walk += tokens_size;
+    }
+    if (strings_size > 0) {
+        memcpy(walk, gen->strings, strings_size);
+        walk += strings_size;
+        memcpy(walk, gen->data, gen->data_size);
+    }
+
+    *buf = gen->buf;
+}
+
+/*
+ * Returns true if the given buffer starts with a snapshot header (of any
+ * version).
+ *
+ */
+bool snapshot_is_snapshot(const char *buf, size_t len) {
+    return (len >= sizeof(snapshot_header) &&
+            memcmp(buf, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0);
+}
+
+static bool snapshot_error(char **errormsg, const char *message) {
+    ELOG("Could not load snapshot: %s\n", message);
+    if (errormsg != NULL) {
+        *errormsg = sstrdup(message);
+    }
+    return false;
+}
+
+#define CALLBACK(name, ...)                                           \
+    do {                                                              \
+        if (callbacks->name != NULL && !callbacks->name(__VA_ARGS__)) \
+            goto canceled;                                            \
+    } while (0)
+
+/*
+ * Walks over the snapshot in buf and calls the given yajl callbacks for each
+ * token, just as yajl_parse() would for the equivalent JSON. Strings are
+ * passed as pointers into buf. Returns false (and sets *errormsg, if it is not
+ * NULL) if the snapshot is malformed or a callback returned 0.
+ *
+ */
+bool snapshot_parse(const char *buf, size_t len, const yajl_callbacks *callbacks, void *ctx, char **errormsg) {
+    if (!snapshot_is_snapshot(buf, len)) {
+        return snapshot_error(errormsg, "not a snapshot");
+    }
+
+    snapshot_header header;
+    memcpy(&header, buf, sizeof(snapshot_header));
+    if (header.version != SNAPSHOT_VERSION) {
+        return snapshot_error(errormsg, "unsupported snapshot version");
+    }
+
+    const uint64_t expected = (uint64_t)sizeof(snapshot_header) +
+                              (uint64_t)header.num_tokens * sizeof(snapshot_token) +
+                              (uint64_t)header.num_strings * sizeof(snapshot_string) +
+                              header.strings_size;
+    if (expected != len) {
+        return snapshot_error(errormsg, "invalid snapshot size");
+    }
+
+    const snapshot_token *tokens = (const snapshot_token *)(buf + sizeof(snapshot_header));
+    const snapshot_string *strings = (const snapshot_string *)(tokens + header.num_tokens);
+    const unsigned char *data = (const unsigned char *)(strings + header.num_strings);
+
+    for (uint32_t i = 0; i < header.num_strings; i++) {
+        if ((uint64_t)strings[i].offset + strings[i].length >= header.strings_size ||
+            data[strings[i].offset + strings[i].length] != '\0') {
+            return snapshot_error(errormsg, "invalid string table");
+        }
+    }
+
+    /* Nesting of the maps and arrays, needed to verify that they are closed
+     * in the correct order. */
+    uint8_t *stack = NULL;
+    uint32_t depth = 0;
+    uint32_t capacity = 0;
+    const char *error = NULL;
+
+    for (uint32_t i = 0; i < header.num_tokens; i++) {
+        const snapshot_token *token = &(tokens[i]);
+        switch (token->type) {
+            case SNAP_MAP_OPEN:
+            case SNAP_ARRAY_OPEN:
+                if (depth == capacity) {
+                    capacity = (capacity == 0 ? 32 : capacity * 2);
+                    stack = srealloc(stack, capacity);
+                }
+                stack[depth++] = token->type;
+                if (token->type == SNAP_MAP_OPEN) {
+                    CALLBACK(yajl_start_map, ctx);
+                } else {
+                    CALLBACK(yajl_start_array, ctx);
+                }
+                break;
+            case SNAP_MAP_CLOSE:
+            case SNAP_ARRAY_CLOSE:
+                if (depth == 0 || stack[depth - 1] != token->type - 1) {
+                    error = "unbalanced snapshot";
+                    goto out;
+                }
+                depth--;
+                if (token->type == SNAP_MAP_CLOSE) {
+                    CALLBACK(yajl_end_map, ctx);
+                } else {
+                    CALLBACK(yajl_end_array, ctx);
+                }
+                break;
+            case SNAP_KEY:
+            case SNAP_STRING: {
+                if (token->string >= header.num_strings) {
+                    error = "invalid string index";
+                    goto out;
+                }
+                const snapshot_string *string = &(strings[token->string]);
+                if (token->type == SNAP_KEY) {
+                    CALLBACK(yajl_map_key, ctx, data + string->offset, string->length);
+                } else {
+                    CALLBACK(yajl_string, ctx, data + string->offset, string->length);
+                }
+                break;
+            }
+            case SNAP_INTEGER:
+                CALLBACK(yajl_integer, ctx, token->value.integer);
+                break;
+            case SNAP_DOUBLE:
+                CALLBACK(yajl_double, ctx, token->value.number);
+                break;
+            case SNAP_BOOL:
+                CALLBACK(yajl_boolean, ctx, token->value.integer != 0);
+                break;
+            case SNAP_NULL:
+                CALLBACK(yajl_null, ctx);
+                break;
+            default:
+                error = "invalid token type";
+                goto out;
+        }
+    }
+
+    if (depth != 0) {
+        error = "unbalanced snapshot";
+    }
+    goto out;
+
+canceled:
+    error = "parsing canceled by callback";
+
+out:
+    free(stack);
+    if (error != NULL) {
+        return snapshot_error(errormsg, error);
+    }
+    return true;
+}
+
+#undef CALLBACK
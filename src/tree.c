@@ -88,7 +88,11 @@ bool tree_restore(const char *path, xcb_get_geometry_reply_t *geometry) {
         geometry->height};
     focused = croot;
 
-    tree_append_json(focused, buf, len, NULL);
+    if (snapshot_is_snapshot(buf, len)) {
+        tree_append_snapshot(focused, buf, len, NULL);
+    } else {
+        tree_append_json(focused, buf, len, NULL);
+    }
 
     DLOG("appended tree, using new root\n");
     croot = TAILQ_FIRST(&(croot->nodes_head));
@@ -258,6 +262,7 @@ bool tree_close_internal(Con *con, kill_window_t kill_window, bool dont_kill_par
             add_ignore_event(cookie.sequence, 0);
         }
         ipc_send_window_event("close", con);
+        con_unindex_window(con);
         window_free(con->window);
         con->window = NULL;
     }
@@ -340,6 +345,7 @@ void tree_split(Con *con, orientation_t orientation) {
             }
             DLOG("Changing orientation of workspace\n");
             con->layout = (orientation == HORIZ) ? L_SPLITH : L_SPLITV;
+            con_mark_dirty(con);
             return;
         } else {
             /* if there is more than one container on the workspace
@@ -432,6 +438,18 @@ bool level_down(void) {
 static void mark_unmapped(Con *con) {
     Con *current;
 
+    /* A workspace which was hidden during the last render (this includes the
+     * scratchpad) and did not change since then is entirely unmapped already
+     * and does not get rendered, so neither this function nor
+     * x_push_changes() need to look at it. */
+    if (con->type == CT_WORKSPACE) {
+        con->render_skipped = (!con->dirty &&
+                               !con->mapped &&
+                               (con->fullscreen_mode == CF_NONE || con_is_internal(con)));
+        if (con->render_skipped)
+            return;
+    }
+
     con->mapped = false;
     TAILQ_FOREACH(current, &(con->nodes_head), nodes)
     mark_unmapped(current);
@@ -461,6 +479,14 @@ void tree_render(void) {
     render_con(croot, false);
 
     x_push_changes(croot);
+
+    /* The window/frame indexes are maintained incrementally, so make sure in
+     * debug builds that they did not get out of sync with the tree. */
+    if (is_debug_build()) {
+        bool con_index_ok = con_index_check();
+        bool x_index_ok = x_index_check();
+        assert(con_index_ok && x_index_ok);
+    }
     DLOG("-- END RENDERING --\n");
 }
 
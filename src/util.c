@@ -214,28 +214,24 @@ static char **add_argument(char **original, char *opt_char, char *opt_arg, char
     return result;
 }
 
-#define y(x, ...) yajl_gen_##x(gen, ##__VA_ARGS__)
-#define ystr(str) yajl_gen_string(gen, (unsigned char *)str, strlen(str))
-
 static char *store_restart_layout(void) {
-    setlocale(LC_NUMERIC, "C");
-    yajl_gen gen = yajl_gen_alloc(NULL);
-
-    dump_node(gen, croot, true);
+    snapshot_gen *gen = snapshot_gen_alloc();
 
-    setlocale(LC_NUMERIC, "");
+    dump_node_snapshot(gen, croot, true);
 
     const unsigned char *payload;
     size_t length;
-    y(get_buf, &payload, &length);
+    snapshot_gen_get_buf(gen, &payload, &length);
 
     /* create a temporary file if one hasn't been specified, or just
      * resolve the tildes in the specified path */
     char *filename;
     if (config.restart_state_path == NULL) {
         filename = get_process_filename("restart-state");
-        if (!filename)
+        if (!filename) {
+            snapshot_gen_free(gen);
             return NULL;
+        }
     } else {
         filename = resolve_tilde(config.restart_state_path);
     }
@@ -253,6 +249,7 @@ static char *store_restart_layout(void) {
     if (fd == -1) {
         perror("open()");
         free(filename);
+        snapshot_gen_free(gen);
         return NULL;
     }
 
@@ -260,16 +257,15 @@ static char *store_restart_layout(void) {
         ELOG("Could not write restart layout to \"%s\", layout will be lost: %s\n", filename, strerror(errno));
         free(filename);
         close(fd);
+        snapshot_gen_free(gen);
         return NULL;
     }
 
     close(fd);
 
-    if (length > 0) {
-        DLOG("layout: %.*s\n", (int)length, payload);
-    }
+    DLOG("Wrote %zu bytes of restart layout to \"%s\"\n", length, filename);
 
-    y(free);
+    snapshot_gen_free(gen);
 
     return filename;
 }
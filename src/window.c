@@ -9,6 +9,20 @@
  */
 #include "all.h"
 
+/* Global counter for the generations of window properties which criteria can
+ * match on (see regex_matches_cached()). */
+static uint64_t property_generation = 0;
+
+/*
+ * Returns true if the two strings differ, treating NULL as a distinct value.
+ *
+ */
+static bool property_changed(const char *old, const char *new) {
+    if (old == NULL || new == NULL)
+        return (old != new);
+    return (strcmp(old, new) != 0);
+}
+
 /*
  * Frees an i3Window and all its members.
  *
@@ -40,14 +54,19 @@ void window_update_class(i3Window *win, xcb_get_property_reply_t *prop, bool bef
     char *new_class = xcb_get_property_value(prop);
     const size_t class_class_index = strnlen(new_class, prop_length) + 1;
 
+    char *class_instance = sstrndup(new_class, prop_length);
+    char *class_class = NULL;
+    if (class_class_index < prop_length)
+        class_class = sstrndup(new_class + class_class_index, prop_length - class_class_index);
+
+    if (property_changed(win->class_instance, class_instance) ||
+        property_changed(win->class_class, class_class))
+        win->class_generation = ++property_generation;
+
     FREE(win->class_instance);
     FREE(win->class_class);
-
-    win->class_instance = sstrndup(new_class, prop_length);
-    if (class_class_index < prop_length)
-        win->class_class = sstrndup(new_class + class_class_index, prop_length - class_class_index);
-    else
-        win->class_class = NULL;
+    win->class_instance = class_instance;
+    win->class_class = class_class;
     LOG("WM_CLASS changed to %s (instance), %s (class)\n",
         win->class_instance, win->class_class);
 
@@ -69,11 +88,12 @@ void window_update_name(i3Window *win, xcb_get_property_reply_t *prop, bool befo
         return;
     }
 
-    i3string_free(win->name);
-
     /* Truncate the name at the first zero byte. See #3515. */
     const int len = xcb_get_property_value_length(prop);
     char *name = sstrndup(xcb_get_property_value(prop), len);
+    if (win->name == NULL || property_changed(i3string_as_utf8(win->name), name))
+        win->name_generation = ++property_generation;
+    i3string_free(win->name);
     win->name = i3string_from_utf8(name);
     free(name);
 
@@ -114,9 +134,11 @@ void window_update_name_legacy(i3Window *win, xcb_get_property_reply_t *prop, bo
         return;
     }
 
-    i3string_free(win->name);
     const int len = xcb_get_property_value_length(prop);
     char *name = sstrndup(xcb_get_property_value(prop), len);
+    if (win->name == NULL || property_changed(i3string_as_utf8(win->name), name))
+        win->name_generation = ++property_generation;
+    i3string_free(win->name);
     win->name = i3string_from_utf8(name);
     free(name);
 
@@ -228,6 +250,8 @@ void window_update_role(i3Window *win, xcb_get_property_reply_t *prop, bool befo
     char *new_role;
     sasprintf(&new_role, "%.*s", xcb_get_property_value_length(prop),
               (char *)xcb_get_property_value(prop));
+    if (property_changed(win->role, new_role))
+        win->role_generation = ++property_generation;
     FREE(win->role);
     win->role = new_role;
     LOG("WM_WINDOW_ROLE changed to \"%s\"\n", win->role);
@@ -397,10 +397,12 @@ static void workspace_reassign_sticky(Con *con) {
         }
 
         x_move_win(src, current);
+        con_unindex_window(src);
         current->window = src->window;
         current->mapped = true;
         src->window = NULL;
         src->mapped = false;
+        con_index_window(current);
 
         x_reparent_child(current, src);
 
@@ -447,14 +449,19 @@ void workspace_show(Con *workspace) {
     /* disable fullscreen for the other workspaces and get the workspace we are
      * currently on. */
     TAILQ_FOREACH(current, &(workspace->parent->nodes_head), nodes) {
-        if (current->fullscreen_mode == CF_OUTPUT)
+        if (current->fullscreen_mode == CF_OUTPUT) {
             old = current;
+            /* The workspace gets hidden, so its windows need to be unmapped in
+             * the next tree_render(). */
+            con_mark_dirty(current);
+        }
         current->fullscreen_mode = CF_NONE;
     }
 
     /* enable fullscreen for the target workspace. If it happens to be the
      * same one we are currently on anyways, we can stop here. */
     workspace->fullscreen_mode = CF_OUTPUT;
+    con_mark_dirty(workspace);
     current = con_get_workspace(focused);
     if (workspace == current) {
         DLOG("Not switching, already there.\n");
@@ -530,15 +537,21 @@ void workspace_show(Con *workspace) {
         /* check if this workspace is currently visible */
         if (!workspace_is_visible(old)) {
             LOG("Closing old workspace (%p / %s), it is empty\n", old, old->name);
-            yajl_gen gen = ipc_marshal_workspace_event("empty", old, NULL);
+            /* The event has to be serialized before the workspace is freed. */
+            yajl_gen gen = NULL;
+            if (ipc_has_event_subscribers(I3_IPC_EVENT_WORKSPACE)) {
+                gen = ipc_marshal_workspace_event("empty", old, NULL);
+            }
             tree_close_internal(old, DONT_KILL_WINDOW, false);
 
-            const unsigned char *payload;
-            ylength length;
-            y(get_buf, &payload, &length);
-            ipc_send_event("workspace", I3_IPC_EVENT_WORKSPACE, (const char *)payload);
+            if (gen != NULL) {
+                const unsigned char *payload;
+                ylength length;
+                y(get_buf, &payload, &length);
+                ipc_send_event(I3_IPC_EVENT_WORKSPACE, (const char *)payload);
 
-            y(free);
+                y(free);
+            }
 
             /* Avoid calling output_push_sticky_windows later with a freed container. */
             if (old == old_focus) {
@@ -85,6 +85,74 @@ TAILQ_HEAD(initial_mapping_head, con_state)
 initial_mapping_head =
     TAILQ_HEAD_INITIALIZER(initial_mapping_head);
 
+/* Index from frame IDs to the entries of state_head, see state_for_frame(). */
+static xid_map state_by_frame;
+
+struct render_stats render_stats;
+
+/* A growable list of X11 window IDs which is reused across renders. */
+typedef struct window_list {
+    xcb_window_t *ids;
+    int count;
+    int capacity;
+} window_list;
+
+static void window_list_append(window_list *list, xcb_window_t id) {
+    if (list->count == list->capacity) {
+        list->capacity = MAX(list->capacity * 2, 16);
+        list->ids = srealloc(list->ids, sizeof(xcb_window_t) * list->capacity);
+    }
+    list->ids[list->count++] = id;
+}
+
+/* Copies src into dest unless they are equal already. Returns true if dest
+ * was changed. */
+static bool window_list_update(window_list *dest, const window_list *src) {
+    if (dest->count == src->count &&
+        memcmp(dest->ids, src->ids, sizeof(xcb_window_t) * src->count) == 0)
+        return false;
+
+    dest->count = 0;
+    for (int i = 0; i < src->count; i++)
+        window_list_append(dest, src->ids[i]);
+    return true;
+}
+
+/* The frames which were mapped when x_push_changes() started, bottom to top.
+ * Only valid while x_push_changes() runs. */
+static window_list mapped_frames;
+static bool pushing_changes = false;
+static bool enter_events_disabled = false;
+/* Set by x_mask_event_mask(), the next x_push_changes() restores the event
+ * masks of all frames. */
+static bool event_masks_changed = false;
+
+/*
+ * Disables EnterNotify events on all mapped frames for the rest of the
+ * current x_push_changes() call. This is done lazily, right before the first
+ * request which restacks or moves a window (or warps the pointer), so that
+ * renders which only e.g. redraw decorations don’t touch the event masks at
+ * all.
+ *
+ * All mapped frames are affected, not only the ones which change, because
+ * moving or restacking a window may uncover a different window under the
+ * pointer.
+ *
+ */
+static void x_disable_enter_events(void) {
+    if (!pushing_changes || enter_events_disabled)
+        return;
+
+    /* We need to keep SubstructureRedirect around, otherwise clients can send
+     * ConfigureWindow requests and get them applied directly instead of having
+     * them become ConfigureRequests that i3 handles. */
+    uint32_t values[] = {XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT};
+    for (int i = 0; i < mapped_frames.count; i++)
+        xcb_change_window_attributes(conn, mapped_frames.ids[i], XCB_CW_EVENT_MASK, values);
+    render_stats.last_stack_requests += mapped_frames.count;
+    enter_events_disabled = true;
+}
+
 /*
  * Returns the container state for the given frame. This function always
  * returns a container state (otherwise, there is a bug in the code and the
@@ -93,9 +161,8 @@ initial_mapping_head =
  *
  */
 static con_state *state_for_frame(xcb_window_t window) {
-    con_state *state;
-    CIRCLEQ_FOREACH(state, &state_head, state)
-    if (state->id == window)
+    con_state *state = xid_map_get(&state_by_frame, window);
+    if (state != NULL)
         return state;
 
     /* TODO: better error handling? */
@@ -191,6 +258,8 @@ void x_con_init(Con *con) {
     CIRCLEQ_INSERT_HEAD(&state_head, state, state);
     CIRCLEQ_INSERT_HEAD(&old_state_head, state, old_state);
     TAILQ_INSERT_TAIL(&initial_mapping_head, state, initial_mapping_order);
+    xid_map_put(&state_by_frame, state->id, state);
+    con_index_frame(con);
     DLOG("adding new state for window id 0x%08x\n", state->id);
 }
 
@@ -273,6 +342,8 @@ static void _x_con_kill(Con *con) {
     CIRCLEQ_REMOVE(&state_head, state, state);
     CIRCLEQ_REMOVE(&old_state_head, state, old_state);
     TAILQ_REMOVE(&initial_mapping_head, state, initial_mapping_order);
+    xid_map_remove(&state_by_frame, state->id);
+    con_unindex_frame(con);
     FREE(state->name);
     free(state);
 
@@ -303,6 +374,31 @@ void x_con_reframe(Con *con) {
     x_con_init(con);
 }
 
+/*
+ * Verifies that the frame index used by state_for_frame() matches the list of
+ * container states. Returns false (and logs the differences) if it does not.
+ * This is expensive and only meant to be used in debug builds.
+ *
+ */
+bool x_index_check(void) {
+    bool ok = true;
+    uint32_t states = 0;
+    con_state *state;
+    CIRCLEQ_FOREACH(state, &state_head, state) {
+        states++;
+        if (xid_map_get(&state_by_frame, state->id) != state) {
+            ELOG("State %p of frame 0x%08x is not indexed\n", state, state->id);
+            ok = false;
+        }
+    }
+    if (states != state_by_frame.count) {
+        ELOG("Frame state index contains %u entries, but there are %u states\n",
+             state_by_frame.count, states);
+        ok = false;
+    }
+    return ok;
+}
+
 /*
  * Returns true if the client supports the given protocol atom (like WM_DELETE_WINDOW)
  *
@@ -600,8 +696,11 @@ void x_draw_decoration(Con *con) {
     if (leaf && con->frame_buffer.id == XCB_NONE)
         return;
 
-    /* 1: build deco_params and compare with cache */
-    struct deco_render_params *p = scalloc(1, sizeof(struct deco_render_params));
+    /* 1: build deco_params and compare with cache. The struct is compared
+     * using memcmp(), so the padding needs to be zeroed. */
+    struct deco_render_params params;
+    struct deco_render_params *p = &params;
+    memset(p, 0, sizeof(struct deco_render_params));
 
     /* find out which colors to use */
     if (con->urgent)
@@ -624,23 +723,18 @@ void x_draw_decoration(Con *con) {
     p->con_is_leaf = con_is_leaf(con);
     p->parent_layout = con->parent->layout;
 
-    if (con->deco_render_params != NULL &&
+    if (con->deco_render_params_valid &&
         (con->window == NULL || !con->window->name_x_changed) &&
         !parent->pixmap_recreated &&
         !con->pixmap_recreated &&
         !con->mark_changed &&
-        memcmp(p, con->deco_render_params, sizeof(struct deco_render_params)) == 0) {
-        free(p);
+        memcmp(p, &(con->deco_render_params), sizeof(struct deco_render_params)) == 0) {
         goto copy_pixmaps;
     }
 
-    Con *next = con;
-    while ((next = TAILQ_NEXT(next, nodes))) {
-        FREE(next->deco_render_params);
-    }
-
-    FREE(con->deco_render_params);
-    con->deco_render_params = p;
+    con->deco_render_params = params;
+    con->deco_render_params_valid = true;
+    p = &(con->deco_render_params);
 
     if (con->window != NULL && con->window->name_x_changed)
         con->window->name_x_changed = false;
@@ -708,13 +802,13 @@ void x_draw_decoration(Con *con) {
     if (parent->frame_buffer.id == XCB_NONE)
         goto copy_pixmaps;
 
-    /* For the first child, we clear the parent pixmap to ensure there's no
-     * garbage left on there. This is important to avoid tearing when using
-     * transparency. */
-    if (con == TAILQ_FIRST(&(con->parent->nodes_head))) {
-        draw_util_clear_surface(&(con->parent->frame_buffer), COLOR_TRANSPARENT);
-        FREE(con->parent->deco_render_params);
-    }
+    /* Only this decoration is redrawn (x_deco_recurse() clears the parent
+     * pixmap when all of them need to be redrawn), so clip the text to our
+     * own title bar. Otherwise, text drawn with an X core font (which ignores
+     * max_width) would spill into the title bars of the following siblings,
+     * which are not repainted. */
+    xcb_rectangle_t clip = {con->deco_rect.x, con->deco_rect.y, con->deco_rect.width, con->deco_rect.height};
+    xcb_set_clip_rectangles(conn, XCB_CLIP_ORDERING_UNSORTED, parent->frame_buffer.gc, 0, 0, 1, &clip);
 
     /* 4: paint the bar */
     draw_util_rectangle(&(parent->frame_buffer), p->color->background,
@@ -783,7 +877,7 @@ void x_draw_decoration(Con *con) {
         title = con->title_format == NULL ? win->name : con_parse_title_format(con);
     }
     if (title == NULL) {
-        goto copy_pixmaps;
+        goto reset_clip;
     }
 
     int title_offset_x;
@@ -819,11 +913,66 @@ void x_draw_decoration(Con *con) {
     }
 
     x_draw_decoration_after_title(con, p);
+reset_clip:
+    xcb_change_gc(conn, parent->frame_buffer.gc, XCB_GC_CLIP_MASK, (uint32_t[]){XCB_NONE});
 copy_pixmaps:
     x_shape_window(con);
     draw_util_copy_surface(&(con->frame_buffer), &(con->frame), 0, 0, 0, 0, con->rect.width, con->rect.height);
 }
 
+/*
+ * Returns true if the given container is a hidden workspace which was skipped
+ * by tree_render() and has not changed since (see con_mark_dirty()), meaning
+ * that nothing in its subtree needs to be pushed to X11.
+ *
+ */
+bool x_can_skip_subtree(Con *con) {
+    return (con->type == CT_WORKSPACE && con->render_skipped && !con->dirty);
+}
+
+/*
+ * Decides whether the decorations of all children of con need to be redrawn
+ * onto con’s pixmap: this is the case when the pixmap was recreated, or when
+ * title bars were added, removed, moved or resized. The pixmap is then cleared (so
+ * that no garbage is left on it, which is important to avoid tearing when
+ * using transparency) and the cached decoration parameters of all children
+ * are invalidated.
+ *
+ * Otherwise, the pixmap is kept and x_draw_decoration() only redraws the
+ * title bars whose parameters changed, so that e.g. a title change in a
+ * tabbed container with many tabs redraws a single tab.
+ *
+ */
+static void x_deco_prepare_children(Con *con) {
+    Con *current;
+    int children = 0;
+    bool redraw_all = con->pixmap_recreated;
+
+    if (con->frame_buffer.id == XCB_NONE)
+        return;
+
+    TAILQ_FOREACH(current, &(con->nodes_head), nodes) {
+        /* The cached parameters are kept when they are invalidated, so
+         * con_deco_rect always is where the title bar was last drawn. */
+        if (memcmp(&(current->deco_render_params.con_deco_rect), &(current->deco_rect), sizeof(Rect)) != 0)
+            redraw_all = true;
+        if (current->deco_rect.height > 0)
+            children++;
+    }
+
+    if (children != con->deco_children)
+        redraw_all = true;
+    con->deco_children = children;
+
+    if (!redraw_all)
+        return;
+
+    draw_util_clear_surface(&(con->frame_buffer), COLOR_TRANSPARENT);
+    con->deco_render_params_valid = false;
+    TAILQ_FOREACH(current, &(con->nodes_head), nodes)
+    current->deco_render_params_valid = false;
+}
+
 /*
  * Recursively calls x_draw_decoration. This cannot be done in x_push_node
  * because x_push_node uses focus order to recurse (see the comment above)
@@ -836,7 +985,12 @@ void x_deco_recurse(Con *con) {
                 TAILQ_EMPTY(&(con->floating_head));
     con_state *state = state_for_frame(con->frame.id);
 
+    if (x_can_skip_subtree(con))
+        return;
+
     if (!leaf) {
+        x_deco_prepare_children(con);
+
         TAILQ_FOREACH(current, &(con->nodes_head), nodes)
         x_deco_recurse(current);
 
@@ -954,6 +1108,9 @@ void x_push_node(Con *con) {
     con_state *state;
     Rect rect = con->rect;
 
+    if (x_can_skip_subtree(con))
+        return;
+
     //DLOG("Pushing changes for node %p / %s\n", con, con->name);
     state = state_for_frame(con->frame.id);
 
@@ -987,6 +1144,7 @@ void x_push_node(Con *con) {
      * container) */
     if (state->need_reparent && con->window != NULL) {
         DLOG("Reparenting child window\n");
+        x_disable_enter_events();
 
         /* Temporarily set the event masks to XCB_NONE so that we won’t get
          * UnmapNotify events (otherwise the handler would close the container).
@@ -1102,6 +1260,7 @@ void x_push_node(Con *con) {
         }
 
         DLOG("setting rect (%d, %d, %d, %d)\n", rect.x, rect.y, rect.width, rect.height);
+        x_disable_enter_events();
         /* flush to ensure that the following commands are sent in a single
          * buffer and will be processed directly afterwards (the contents of a
          * window get lost when resizing it, therefore we want to provide it as
@@ -1122,6 +1281,7 @@ void x_push_node(Con *con) {
         memcmp(&(state->window_rect), &(con->window_rect), sizeof(Rect)) != 0) {
         DLOG("setting window rect (%d, %d, %d, %d)\n",
              con->window_rect.x, con->window_rect.y, con->window_rect.width, con->window_rect.height);
+        x_disable_enter_events();
         xcb_set_window_rect(conn, con->window->id, con->window_rect);
         memcpy(&(state->window_rect), &(con->window_rect), sizeof(Rect));
         fake_notify = true;
@@ -1202,6 +1362,9 @@ static void x_push_node_unmaps(Con *con) {
     Con *current;
     con_state *state;
 
+    if (x_can_skip_subtree(con))
+        return;
+
     //DLOG("Pushing changes (with unmaps) for node %p / %s\n", con, con->name);
     state = state_for_frame(con->frame.id);
 
@@ -1228,6 +1391,9 @@ static void x_push_node_unmaps(Con *con) {
         }
         state->mapped = con->mapped;
     }
+    /* The unmap has been pushed. Reset the flag so that x_push_changes() does
+     * not touch this state again while its workspace is skipped. */
+    state->unmap_now = false;
 
     /* handle all children and floating windows of this node */
     TAILQ_FOREACH(current, &(con->nodes_head), nodes)
@@ -1235,6 +1401,10 @@ static void x_push_node_unmaps(Con *con) {
 
     TAILQ_FOREACH(current, &(con->floating_head), floating_windows)
     x_push_node_unmaps(current);
+
+    /* This is the last step of x_push_changes(), everything below this
+     * container is now in sync with X11. */
+    con->dirty = false;
 }
 
 /*
@@ -1269,6 +1439,7 @@ static bool is_con_attached(Con *con) {
 void x_push_changes(Con *con) {
     con_state *state;
     xcb_query_pointer_cookie_t pointercookie;
+    uint32_t values[1];
 
     /* If we need to warp later, we request the pointer position as soon as possible */
     if (warp_to) {
@@ -1276,76 +1447,81 @@ void x_push_changes(Con *con) {
     }
 
     DLOG("-- PUSHING WINDOW STACK --\n");
-    //DLOG("Disabling EnterNotify\n");
-    /* We need to keep SubstructureRedirect around, otherwise clients can send
-     * ConfigureWindow requests and get them applied directly instead of having
-     * them become ConfigureRequests that i3 handles. */
-    uint32_t values[1] = {XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT};
-    CIRCLEQ_FOREACH_REVERSE(state, &state_head, state) {
-        if (state->mapped)
-            xcb_change_window_attributes(conn, state->id, XCB_CW_EVENT_MASK, values);
-    }
-    //DLOG("Done, EnterNotify disabled\n");
+    render_stats.renders++;
+    render_stats.last_stack_requests = 0;
+
+    /* The bottom-to-top window stack of all windows which are managed by i3,
+     * and the pairs of frames (below, above) which need to be restacked. */
+    static window_list stack_windows;
+    static window_list restack_frames;
+    stack_windows.count = 0;
+    restack_frames.count = 0;
+    mapped_frames.count = 0;
     bool order_changed = false;
-    bool stacking_changed = false;
 
-    /* count first, necessary to (re)allocate memory for the bottom-to-top
-     * stack afterwards */
-    int cnt = 0;
-    CIRCLEQ_FOREACH_REVERSE(state, &state_head, state)
-    if (con_has_managed_window(state->con))
-        cnt++;
-
-    /* The bottom-to-top window stack of all windows which are managed by i3.
-     * Used for x_get_window_stack(). */
-    static xcb_window_t *client_list_windows = NULL;
-    static int client_list_count = 0;
-
-    if (cnt != client_list_count) {
-        client_list_windows = srealloc(client_list_windows, sizeof(xcb_window_t) * cnt);
-        client_list_count = cnt;
-    }
-
-    xcb_window_t *walk = client_list_windows;
-
-    /* X11 correctly represents the stack if we push it from bottom to top */
+    /* Walk the stack once, from bottom to top, and only remember what needs
+     * to be changed. No request must be sent before EnterNotify events are
+     * disabled, see x_disable_enter_events(). */
     CIRCLEQ_FOREACH_REVERSE(state, &state_head, state) {
+        if (state->mapped)
+            window_list_append(&mapped_frames, state->id);
+
         if (con_has_managed_window(state->con))
-            memcpy(walk++, &(state->con->window->id), sizeof(xcb_window_t));
+            window_list_append(&stack_windows, state->con->window->id);
 
-        //DLOG("stack: 0x%08x\n", state->id);
         con_state *prev = CIRCLEQ_PREV(state, state);
         con_state *old_prev = CIRCLEQ_PREV(state, old_state);
         if (prev != old_prev)
             order_changed = true;
         if ((state->initial || order_changed) && prev != CIRCLEQ_END(&state_head)) {
-            stacking_changed = true;
-            //DLOG("Stacking 0x%08x above 0x%08x\n", prev->id, state->id);
+            window_list_append(&restack_frames, state->id);
+            window_list_append(&restack_frames, prev->id);
+        }
+        state->initial = false;
+    }
+
+    pushing_changes = true;
+    enter_events_disabled = false;
+    if (event_masks_changed) {
+        x_disable_enter_events();
+        event_masks_changed = false;
+    }
+
+    /* X11 correctly represents the stack if we push it from bottom to top */
+    if (restack_frames.count > 0) {
+        x_disable_enter_events();
+        for (int i = 0; i < restack_frames.count; i += 2) {
+            //DLOG("Stacking 0x%08x above 0x%08x\n", restack_frames.ids[i + 1], restack_frames.ids[i]);
             uint32_t mask = 0;
             mask |= XCB_CONFIG_WINDOW_SIBLING;
             mask |= XCB_CONFIG_WINDOW_STACK_MODE;
-            uint32_t values[] = {state->id, XCB_STACK_MODE_ABOVE};
+            uint32_t values[] = {restack_frames.ids[i], XCB_STACK_MODE_ABOVE};
 
-            xcb_configure_window(conn, prev->id, mask, values);
+            xcb_configure_window(conn, restack_frames.ids[i + 1], mask, values);
         }
-        state->initial = false;
+        render_stats.last_stack_requests += restack_frames.count / 2;
     }
 
-    /* If we re-stacked something (or a new window appeared), we need to update
-     * the _NET_CLIENT_LIST and _NET_CLIENT_LIST_STACKING hints */
-    if (stacking_changed) {
-        DLOG("Client list changed (%i clients)\n", cnt);
-        ewmh_update_client_list_stacking(client_list_windows, client_list_count);
-
-        walk = client_list_windows;
+    /* Update the _NET_CLIENT_LIST and _NET_CLIENT_LIST_STACKING hints if the
+     * stack of managed windows changed (or a window appeared or vanished). */
+    static window_list client_list_stacking;
+    if (window_list_update(&client_list_stacking, &stack_windows)) {
+        DLOG("Client list changed (%i clients)\n", client_list_stacking.count);
+        ewmh_update_client_list_stacking(client_list_stacking.ids, client_list_stacking.count);
+        render_stats.last_stack_requests++;
 
         /* reorder by initial mapping */
+        stack_windows.count = 0;
         TAILQ_FOREACH(state, &initial_mapping_head, initial_mapping_order) {
             if (con_has_managed_window(state->con))
-                *walk++ = state->con->window->id;
+                window_list_append(&stack_windows, state->con->window->id);
         }
 
-        ewmh_update_client_list(client_list_windows, client_list_count);
+        static window_list client_list;
+        if (window_list_update(&client_list, &stack_windows)) {
+            ewmh_update_client_list(client_list.ids, client_list.count);
+            render_stats.last_stack_requests++;
+        }
     }
 
     DLOG("PUSHING CHANGES\n");
@@ -1362,6 +1538,7 @@ void x_push_changes(Con *con) {
             Output *current = get_output_containing(pointerreply->root_x, pointerreply->root_y);
             Output *target = get_output_containing(mid_x, mid_y);
             if (current != target) {
+                x_disable_enter_events();
                 /* Ignore MotionNotify events generated by warping */
                 xcb_change_window_attributes(conn, root, XCB_CW_EVENT_MASK, (uint32_t[]){XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT});
                 xcb_warp_pointer(conn, XCB_NONE, root, 0, 0, 0, 0, mid_x, mid_y);
@@ -1373,13 +1550,16 @@ void x_push_changes(Con *con) {
         warp_to = NULL;
     }
 
-    //DLOG("Re-enabling EnterNotify\n");
-    values[0] = FRAME_EVENT_MASK;
-    CIRCLEQ_FOREACH_REVERSE(state, &state_head, state) {
-        if (state->mapped)
-            xcb_change_window_attributes(conn, state->id, XCB_CW_EVENT_MASK, values);
+    if (enter_events_disabled) {
+        //DLOG("Re-enabling EnterNotify\n");
+        uint32_t values[] = {FRAME_EVENT_MASK};
+        for (int i = 0; i < mapped_frames.count; i++)
+            xcb_change_window_attributes(conn, mapped_frames.ids[i], XCB_CW_EVENT_MASK, values);
+        render_stats.last_stack_requests += mapped_frames.count;
+        enter_events_disabled = false;
     }
-    //DLOG("Done, EnterNotify re-enabled\n");
+    pushing_changes = false;
+    render_stats.stack_requests += render_stats.last_stack_requests;
 
     x_deco_recurse(con);
 
@@ -1460,10 +1640,12 @@ void x_push_changes(Con *con) {
     /* Push all pending unmaps */
     x_push_node_unmaps(con);
 
-    /* save the current stack as old stack */
-    CIRCLEQ_FOREACH(state, &state_head, state) {
-        CIRCLEQ_REMOVE(&old_state_head, state, old_state);
-        CIRCLEQ_INSERT_TAIL(&old_state_head, state, old_state);
+    /* save the current stack as old stack (unless it is unchanged) */
+    if (order_changed) {
+        CIRCLEQ_FOREACH(state, &state_head, state) {
+            CIRCLEQ_REMOVE(&old_state_head, state, old_state);
+            CIRCLEQ_INSERT_TAIL(&old_state_head, state, old_state);
+        }
     }
     //CIRCLEQ_FOREACH(state, &old_state_head, old_state) {
     //    DLOG("old stack: 0x%08x\n", state->id);
@@ -1502,6 +1684,7 @@ void x_set_name(Con *con, const char *name) {
 
     FREE(state->name);
     state->name = sstrdup(name);
+    con_mark_dirty(con);
 }
 
 /*
@@ -1557,6 +1740,7 @@ void x_mask_event_mask(uint32_t mask) {
         if (state->mapped)
             xcb_change_window_attributes(conn, state->id, XCB_CW_EVENT_MASK, values);
     }
+    event_masks_changed = true;
 }
 
 /*
@@ -0,0 +1,144 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved dynamic tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * xid_map.c: Hash map from X11 IDs (windows, pixmaps, …) to pointers, used to
+ *            avoid linear scans over all containers in the event handlers.
+ *
+ */
+#include "all.h"
+
+#define XID_MAP_INITIAL_CAPACITY 64
+
+/*
+ * X11 resource IDs are allocated sequentially per client (a client base ORed
+ * with a counter), so we need to mix the bits before using them as a slot
+ * index. This is the finalizer of MurmurHash3.
+ *
+ */
+static uint32_t xid_hash(uint32_t id) {
+    id ^= id >> 16;
+    id *= 0x85ebca6b;
+    id ^= id >> 13;
+    id *= 0xc2b2ae35;
+    id ^= id >> 16;
+    return id;
+}
+
+/*
+ * Returns the slot which contains the given ID or the empty slot at which the
+ * ID would have to be inserted.
+ *
+ */
+static xid_map_slot *xid_map_find(const xid_map *map, uint32_t id) {
+    uint32_t mask = map->capacity - 1;
+    uint32_t idx = xid_hash(id) & mask;
+    while (map->slots[idx].id != XCB_NONE && map->slots[idx].id != id) {
+        idx = (idx + 1) & mask;
+    }
+    return &(map->slots[idx]);
+}
+
+static void xid_map_resize(xid_map *map, uint32_t capacity) {
+    xid_map_slot *old_slots = map->slots;
+    uint32_t old_capacity = map->capacity;
+
+    map->slots = scalloc(capacity, sizeof(xid_map_slot));
+    map->capacity = capacity;
+
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (old_slots[i].id == XCB_NONE) {
+            continue;
+        }
+        *xid_map_find(map, old_slots[i].id) = old_slots[i];
+    }
+    free(old_slots);
+}
+
+/*
+ * Returns the value stored for the given ID or NULL if there is none.
+ *
+ */
+void *xid_map_get(const xid_map *map, uint32_t id) {
+    if (map->count == 0 || id == XCB_NONE) {
+        return NULL;
+    }
+    return xid_map_find(map, id)->value;
+}
+
+/*
+ * Stores the given value for the given ID, replacing any previous value.
+ * Storing XCB_NONE is not allowed.
+ *
+ */
+void xid_map_put(xid_map *map, uint32_t id, void *value) {
+    assert(id != XCB_NONE);
+
+    /* Keep the load factor below 3/4 so that probe sequences stay short. */
+    if (map->capacity == 0) {
+        xid_map_resize(map, XID_MAP_INITIAL_CAPACITY);
+    } else if ((map->count + 1) * 4 > map->capacity * 3) {
+        xid_map_resize(map, map->capacity * 2);
+    }
+
+    xid_map_slot *slot = xid_map_find(map, id);
+    if (slot->id == XCB_NONE) {
+        slot->id = id;
+        map->count++;
+    }
+    slot->value = value;
+}
+
+/*
+ * Removes the given ID from the map. Returns the value which was stored for it
+ * or NULL if the ID was not in the map.
+ *
+ */
+void *xid_map_remove(xid_map *map, uint32_t id) {
+    if (map->count == 0 || id == XCB_NONE) {
+        return NULL;
+    }
+
+    xid_map_slot *slot = xid_map_find(map, id);
+    if (slot->id == XCB_NONE) {
+        return NULL;
+    }
+    void *value = slot->value;
+
+    /* Instead of leaving a tombstone, move entries of the probe sequence
+     * following the removed slot back into the hole (backward shift
+     * deletion), so that lookups never need to skip deleted slots. */
+    uint32_t mask = map->capacity - 1;
+    uint32_t hole = slot - map->slots;
+    uint32_t idx = hole;
+    while (true) {
+        idx = (idx + 1) & mask;
+        if (map->slots[idx].id == XCB_NONE) {
+            break;
+        }
+        uint32_t home = xid_hash(map->slots[idx].id) & mask;
+        /* The entry can only be moved if its home slot is not located
+         * (cyclically) between the hole and its current position. */
+        if (((idx - home) & mask) >= ((idx - hole) & mask)) {
+            map->slots[hole] = map->slots[idx];
+            hole = idx;
+        }
+    }
+    map->slots[hole].id = XCB_NONE;
+    map->slots[hole].value = NULL;
+    map->count--;
+
+    return value;
+}
+
+/*
+ * Removes all entries and frees the memory used by the map.
+ *
+ */
+void xid_map_free(xid_map *map) {
+    FREE(map->slots);
+    map->capacity = 0;
+    map->count = 0;
+}
@@ -116,6 +116,10 @@ sub activate_i3 {
             $i3cmd .= ' -C';
         }
 
+        if ($args{config_cache}) {
+            $i3cmd .= ' --config-cache';
+        }
+
         if ($args{valgrind}) {
             $i3cmd =
                 qq|valgrind --log-file="$outdir/valgrind-for-$test.log" | .
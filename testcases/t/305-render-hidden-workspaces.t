@@ -0,0 +1,114 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that changes to hidden workspaces are still pushed to X11 even
+# though tree_render() skips hidden workspaces which did not change.
+use i3test;
+use X11::XCB qw(:all);
+
+sub is_hidden {
+    sync_with_i3;
+    my $atom = $x->atom(name => '_NET_WM_STATE_HIDDEN');
+
+    my ($con) = @_;
+    my $cookie = $x->get_property(
+        0,
+        $con->{id},
+        $x->atom(name => '_NET_WM_STATE')->id,
+        GET_PROPERTY_TYPE_ANY,
+        0,
+        4096
+    );
+
+    my $reply = $x->get_property_reply($cookie->{sequence});
+    my $len = $reply->{length};
+    return 0 if $len == 0;
+
+    my @atoms = unpack("L$len", $reply->{value});
+    for (my $i = 0; $i < $len; $i++) {
+        return 1 if $atoms[$i] == $atom->id;
+    }
+
+    return 0;
+}
+
+###############################################################################
+# Windows get unmapped when their workspace gets hidden and stay unmapped
+# while other workspaces are rendered.
+###############################################################################
+
+my $ws = fresh_workspace;
+my $first = open_window;
+my $second = open_window;
+
+my $other = fresh_workspace;
+sync_with_i3;
+ok(!$first->mapped, 'first window unmapped after switching away');
+ok(!$second->mapped, 'second window unmapped after switching away');
+
+open_window;
+cmd 'split v';
+open_window;
+sync_with_i3;
+ok(!$first->mapped, 'first window still unmapped');
+ok(!$second->mapped, 'second window still unmapped');
+
+###############################################################################
+# Changing the layout of a hidden workspace updates _NET_WM_STATE_HIDDEN.
+###############################################################################
+
+ok(!is_hidden($first), 'first window not hidden before layout change');
+cmd '[id="' . $second->id . '"] layout tabbed';
+ok(is_hidden($first), 'first window hidden after layout change on hidden workspace');
+ok(!is_hidden($second), 'second (focused) window not hidden');
+
+cmd "workspace $ws";
+sync_with_i3;
+ok($second->mapped, 'second window mapped after switching back');
+
+cmd "workspace $other";
+sync_with_i3;
+ok(!$second->mapped, 'second window unmapped again');
+
+###############################################################################
+# Windows moved to a hidden workspace get unmapped and are mapped again once
+# the workspace is shown.
+###############################################################################
+
+my $moved = open_window;
+cmd "move container to workspace $ws";
+sync_with_i3;
+ok(!$moved->mapped, 'moved window unmapped');
+
+cmd "workspace $ws";
+sync_with_i3;
+ok($moved->mapped, 'moved window mapped after switching to its workspace');
+
+###############################################################################
+# Closing a window on a hidden workspace does not break rendering of the
+# workspace once it is shown again.
+###############################################################################
+
+cmd "workspace $other";
+$moved->destroy;
+sync_with_i3;
+
+cmd "workspace $ws";
+sync_with_i3;
+is(@{get_ws_content($ws)}, 1, 'one container left on the workspace');
+ok($second->mapped, 'second window mapped again');
+
+done_testing;
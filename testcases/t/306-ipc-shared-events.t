@@ -0,0 +1,55 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that events are delivered to every subscribed client when they are
+# shared between several connections and that unknown event names do not break
+# subscribing.
+use i3test;
+
+my @received = ([], []);
+my @ticks;
+my @conns;
+for my $idx (0 .. 1) {
+    my $i3 = i3(get_socket_path(0));
+    $i3->connect->recv;
+
+    my $tick = AnyEvent->condvar;
+    my $reply = $i3->subscribe({
+        window => sub { push @{$received[$idx]}, shift },
+        tick => sub { my ($event) = @_; $tick->send($event) unless $event->{first} },
+        ($idx == 1 ? (bogus => sub { }) : ()),
+    })->recv;
+    ok($reply->{success}, "connection $idx subscribed");
+
+    push @conns, $i3;
+    push @ticks, $tick;
+}
+
+fresh_workspace;
+my $window = open_window;
+
+# Events are delivered in order, so once the tick arrived on a connection, all
+# window events have been received as well.
+$conns[0]->send_tick('shared')->recv;
+$_->recv for @ticks;
+
+ok(scalar @{$received[0]} > 0, 'first connection received window events');
+is(scalar @{$received[1]}, scalar @{$received[0]}, 'both connections received the same number of events');
+is($received[0]->[0]->{change}, 'new', 'first event is "new"');
+is($received[0]->[0]->{container}->{window}, $window->id, 'event contains the new window');
+is_deeply($received[1], $received[0], 'both connections got the same events');
+
+done_testing;
@@ -0,0 +1,114 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Tests the GET_CLIENTS IPC message and verifies that a client which does not
+# read its events is disconnected once its output queue exceeds
+# ipc_max_pending, long before ipc_kill_timeout expires. This includes a client
+# which goes over the limit with events caused by its own request.
+use i3test i3_config => <<EOT;
+# i3 config file (v4)
+font -misc-fixed-medium-r-normal--13-120-75-75-C-70-iso10646-1
+ipc_kill_timeout 100000
+ipc_max_pending 4096
+EOT
+use IO::Socket::UNIX;
+use IO::Select;
+
+# Manually connect to i3 so that we can choose to not read events
+my $sock = IO::Socket::UNIX->new(Peer => get_socket_path());
+my $payload = '["workspace"]';
+print $sock "i3-ipc" . pack("LL", length($payload), 2) . $payload;
+
+my $i3 = i3(get_socket_path());
+$i3->connect->recv;
+
+# The subscribe reply is only written once the message was handled, so wait
+# for it before querying the clients.
+my $s = IO::Select->new($sock);
+ok($s->can_read(1), 'subscribe reply received');
+
+my $clients = $i3->get_clients->recv;
+my ($self) = grep { $_->{current} } @$clients;
+ok(defined($self), 'current connection is listed');
+is_deeply($self->{events}, [], 'current connection has no subscriptions');
+is($self->{pending_messages}, 0, 'no messages pending for the current connection');
+
+my ($subscriber) = grep { "@{$_->{events}}" eq 'workspace' } @$clients;
+ok(defined($subscriber), 'subscribed connection is listed');
+is_deeply($subscriber->{events}, ['workspace'], 'subscribed to workspace events');
+
+# Constantly switch between 2 workspaces to generate events.
+fresh_workspace;
+open_window;
+fresh_workspace;
+open_window;
+
+for (my $i = 0; $i < 500; $i++) {
+    cmd 'workspace back_and_forth';
+}
+
+my $reached_eof = 0;
+while ($s->can_read(0.5)) {
+    if (read($sock, my $buffer, 4096) == 0) {
+        $reached_eof = 1;
+        last;
+    }
+}
+ok($reached_eof, 'socket connection closed');
+
+$clients = $i3->get_clients->recv;
+ok(!(grep { $_->{fd} == $subscriber->{fd} } @$clients), 'subscribed connection is gone');
+
+close $sock;
+
+################################################################################
+# A client which exceeds the limit with the tick event of its own send_tick
+# request is disconnected after the request was handled.
+################################################################################
+
+$sock = IO::Socket::UNIX->new(Peer => get_socket_path());
+$payload = '["tick"]';
+print $sock "i3-ipc" . pack("LL", length($payload), 2) . $payload;
+$s = IO::Select->new($sock);
+ok($s->can_read(1), 'subscribe reply received');
+
+# Keep sending ticks without reading anything until i3 stops reading from the
+# socket, too.
+$sock->blocking(0);
+my $tick = 'x' x 1024;
+my $message = "i3-ipc" . pack("LL", length($tick), 10) . $tick;
+for (my $i = 0; $i < 2000; $i++) {
+    my $written = syswrite($sock, $message);
+    last unless defined($written) && $written == length($message);
+}
+$sock->blocking(1);
+
+$reached_eof = 0;
+while ($s->can_read(0.5)) {
+    if (sysread($sock, my $buffer, 65536) == 0) {
+        $reached_eof = 1;
+        last;
+    }
+}
+ok($reached_eof, 'tick sending connection closed');
+
+$clients = $i3->get_clients->recv;
+is(scalar(grep { "@{$_->{events}}" eq 'tick' } @$clients), 0, 'tick sending connection is gone');
+
+does_i3_live;
+
+close $sock;
+done_testing;
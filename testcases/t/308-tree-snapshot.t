@@ -0,0 +1,149 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that the binary tree snapshot (GET_TREE_SNAPSHOT, also used for the
+# restart state) contains the same data as the JSON tree and that the layout
+# survives an in-place restart through a snapshot.
+use i3test;
+use Encode qw(decode_utf8);
+use IO::Socket::UNIX;
+
+# Decodes a snapshot as described in docs/ipc into a Perl data structure.
+sub decode_snapshot {
+    my ($buf) = @_;
+    my ($magic, $version, $num_tokens, $num_strings, $strings_size) = unpack('Z8 L L L L', $buf);
+    is($magic, 'i3-snap', 'snapshot magic ok');
+    is($version, 1, 'snapshot version ok');
+
+    my $strings_offset = 24 + 16 * $num_tokens;
+    my $data_offset = $strings_offset + 8 * $num_strings;
+    is(length($buf), $data_offset + $strings_size, 'snapshot size ok');
+
+    my @strings;
+    for my $idx (0 .. $num_strings - 1) {
+        my ($offset, $length) = unpack('L L', substr($buf, $strings_offset + 8 * $idx, 8));
+        push @strings, decode_utf8(substr($buf, $data_offset + $offset, $length));
+    }
+
+    my ($root, @stack, @keys);
+    my $add = sub {
+        my ($value) = @_;
+        if (!@stack) {
+            $root = $value;
+        } elsif (ref($stack[-1]) eq 'ARRAY') {
+            push @{$stack[-1]}, $value;
+        } else {
+            $stack[-1]->{pop @keys} = $value;
+        }
+    };
+    for my $idx (0 .. $num_tokens - 1) {
+        my $token = substr($buf, 24 + 16 * $idx, 16);
+        my ($type, $string) = unpack('L L', $token);
+        my $value = substr($token, 8, 8);
+        if ($type == 0 || $type == 2) {
+            my $container = ($type == 0 ? {} : []);
+            $add->($container);
+            push @stack, $container;
+        } elsif ($type == 1 || $type == 3) {
+            pop @stack;
+        } elsif ($type == 4) {
+            push @keys, $strings[$string];
+        } elsif ($type == 5) {
+            $add->($strings[$string]);
+        } elsif ($type == 6 || $type == 8) {
+            $add->(unpack('q', $value));
+        } elsif ($type == 7) {
+            $add->(unpack('d', $value));
+        } else {
+            $add->(undef);
+        }
+    }
+    return $root;
+}
+
+# Replaces JSON booleans by plain numbers so that both trees can be compared.
+sub normalize {
+    my ($value) = @_;
+    if (ref($value) eq 'HASH') {
+        return { map { ($_ => normalize($value->{$_})) } keys %$value };
+    } elsif (ref($value) eq 'ARRAY') {
+        return [ map { normalize($_) } @$value ];
+    } elsif (ref($value)) {
+        return $value ? 1 : 0;
+    }
+    return $value;
+}
+
+sub get_snapshot {
+    my $sock = IO::Socket::UNIX->new(Peer => get_socket_path());
+    print $sock 'i3-ipc' . pack('LL', 0, 13);
+
+    read($sock, my $header, 14);
+    my ($magic, $length, $type) = unpack('a6 L L', $header);
+    is($type, 13, 'reply has type TREE_SNAPSHOT');
+    my $buf = '';
+    while (length($buf) < $length) {
+        read($sock, $buf, $length - length($buf), length($buf)) or last;
+    }
+    close($sock);
+    return $buf;
+}
+
+my $ws = fresh_workspace;
+my $first = open_window(name => 'first');
+cmd 'split v';
+my $second = open_window(name => 'second');
+cmd 'layout tabbed';
+cmd 'mark snapshot';
+cmd 'focus parent';
+cmd 'split h';
+my $third = open_window(name => 'third');
+my $floating = open_floating_window(name => 'floating');
+sync_with_i3;
+
+###############################################################################
+# The snapshot contains the same data as the JSON tree.
+###############################################################################
+
+my $tree = i3(get_socket_path())->get_tree->recv;
+my $snapshot = decode_snapshot(get_snapshot);
+is_deeply(normalize($snapshot), normalize($tree), 'snapshot matches the JSON tree');
+
+###############################################################################
+# Restarting (which stores the layout as a snapshot) preserves the layout.
+###############################################################################
+
+# Returns the parts of a workspace which have to survive a restart.
+sub layout_of {
+    my ($con) = @_;
+    return {
+        name => $con->{name},
+        layout => $con->{layout},
+        window => $con->{window},
+        marks => $con->{marks},
+        percent => $con->{percent},
+        nodes => [ map { layout_of($_) } @{$con->{nodes}} ],
+        floating_nodes => [ map { layout_of($_) } @{$con->{floating_nodes}} ],
+    };
+}
+
+my $before = layout_of(get_ws($ws));
+cmd 'restart';
+does_i3_live;
+my $after = layout_of(get_ws($ws));
+is_deeply($after, $before, 'layout preserved across the restart');
+
+done_testing;
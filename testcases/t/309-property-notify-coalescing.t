@@ -0,0 +1,51 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that PropertyNotify events are coalesced per window and property,
+# but that the handlers still see the last value and run before a following
+# I3_SYNC client message is answered.
+use i3test;
+
+sub coalesced {
+    return i3(get_socket_path())->get_stats->recv->{events}->{coalesced_property_notifies};
+}
+
+my $window = open_window(name => 'Title 0');
+my $before = coalesced();
+
+# Grab the server while changing the title, so that i3 receives all
+# PropertyNotify events at once instead of handling each change before the
+# next one arrives.
+my @events = events_for(
+    sub {
+        $x->grab_server;
+        $window->name("Title $_") for 1 .. 50;
+        $x->ungrab_server;
+        $x->flush;
+        sync_with_i3;
+    },
+    'window');
+
+cmp_ok(coalesced(), '>', $before, 'PropertyNotify events were coalesced');
+cmp_ok(scalar @events, '>=', 1, 'at least one title event received');
+cmp_ok(scalar @events, '<', 50, 'fewer title events than changes');
+is($events[-1]->{change}, 'title', 'last event is a title change');
+is($events[-1]->{container}->{name}, 'Title 50', 'last event has the last title');
+
+my @nodes = @{get_ws_content(focused_ws)};
+is($nodes[0]->{name}, 'Title 50', 'window title is up to date');
+
+done_testing;
@@ -0,0 +1,64 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Tests the RUN_COMMANDS IPC message, which runs a batch of commands, and
+# verifies that assignments still operate on the new window.
+use i3test i3_config => <<EOT;
+# i3 config file (v4)
+font -misc-fixed-medium-r-normal--13-120-75-75-C-70-iso10646-1
+for_window [title="^assigned\$"] mark assigned, floating enable
+EOT
+
+my $i3 = i3(get_socket_path());
+$i3->connect->recv;
+
+my $ws = fresh_workspace;
+my $target = get_unused_workspace;
+my $window = open_window;
+
+my $reply = $i3->commands([
+    'mark batch',
+    "[con_mark=batch] move to workspace $target",
+    'invalid_command',
+])->recv;
+
+is(scalar @$reply, 3, 'one reply per command');
+ok($reply->[0]->[0]->{success}, 'mark succeeded');
+ok($reply->[1]->[0]->{success}, 'move succeeded');
+ok(!$reply->[2]->[0]->{success}, 'invalid command failed');
+ok($reply->[2]->[0]->{parse_error}, 'invalid command is a parse error');
+
+is(@{get_ws_content($ws)}, 0, 'window moved away');
+is(@{get_ws_content($target)}, 1, 'window moved to the target workspace');
+
+$reply = $i3->commands({ command => 'nop' })->recv;
+ok(!$reply->{success}, 'non-array payload is rejected');
+
+$reply = $i3->commands([])->recv;
+is_deeply($reply, [], 'empty batch');
+
+################################################################################
+# Assignments are run on the container of the new window.
+################################################################################
+
+fresh_workspace;
+open_window(name => 'assigned');
+
+my $floating = get_ws(focused_ws)->{floating_nodes};
+is(@$floating, 1, 'assigned window is floating');
+is_deeply($floating->[0]->{nodes}->[0]->{marks}, ['assigned'], 'assigned window is marked');
+
+done_testing;
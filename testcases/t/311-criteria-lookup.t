@@ -0,0 +1,72 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that criteria which are looked up directly (anchored literals, marks
+# and window ids) match exactly the same containers as regular expressions.
+use i3test;
+
+sub marks_of {
+    my ($ws) = @_;
+    return [ map { join(',', @{$_->{marks} // []}) } @{get_ws_content($ws)} ];
+}
+
+################################################################################
+# Anchored literal patterns only match the whole value.
+################################################################################
+
+my $tmp = fresh_workspace;
+
+open_window(wm_class => 'exact', name => 'one');
+open_window(wm_class => 'exactly', name => 'two');
+
+cmd '[class="^exact$"] mark --add literal';
+is_deeply(marks_of($tmp), [ 'literal', '' ], 'only the exact class matched');
+
+cmd '[class="exact"] mark --add substring';
+is_deeply(marks_of($tmp), [ 'literal,substring', 'substring' ], 'unanchored pattern matches both windows');
+
+cmd '[title="^two$" class="^exactly$"] mark --add both';
+is_deeply(marks_of($tmp), [ 'literal,substring', 'substring,both' ], 'multiple literals are combined');
+
+################################################################################
+# Exact marks are looked up directly, other criteria still apply.
+################################################################################
+
+cmd '[con_mark="^both$" title="^one$"] mark --add wrong';
+is_deeply(marks_of($tmp), [ 'literal,substring', 'substring,both' ], 'other criteria still checked');
+
+cmd '[con_mark="^both$"] mark --add right';
+is_deeply(marks_of($tmp), [ 'literal,substring', 'substring,both,right' ], 'mark looked up');
+
+cmd '[con_mark="^does-not-exist$"] mark --add nothing';
+is_deeply(marks_of($tmp), [ 'literal,substring', 'substring,both,right' ], 'missing mark matches nothing');
+
+################################################################################
+# Window ids are looked up directly.
+################################################################################
+
+$tmp = fresh_workspace;
+
+my $first = open_window;
+my $second = open_window;
+
+cmd '[id="' . $second->id . '"] mark --add by_id';
+is_deeply(marks_of($tmp), [ '', 'by_id' ], 'window id looked up');
+
+cmd '[id="' . $second->id . '" class="^nonexistent$"] mark --add wrong';
+is_deeply(marks_of($tmp), [ '', 'by_id' ], 'other criteria still checked');
+
+done_testing;
@@ -0,0 +1,54 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that the results of criteria are cached per window property and
+# re-evaluated only when the property changes, using the GET_STATS counters.
+use i3test i3_config => <<EOT;
+# i3 config file (v4)
+font -misc-fixed-medium-r-normal--13-120-75-75-C-70-iso10646-1
+for_window [class="^cached" title="^never$"] mark never
+for_window [title="^renamed.*"] mark renamed
+EOT
+
+my $i3 = i3(get_socket_path());
+$i3->connect->recv;
+
+my $stats = $i3->get_stats->recv;
+cmp_ok($stats->{regex}->{compiled}, '>=', 3, 'criteria regexes compiled');
+
+fresh_workspace;
+my $window = open_window(wm_class => 'cached', name => 'first');
+
+my $before = $i3->get_stats->recv->{regex};
+
+# Every title change runs the assignments again. The class does not change,
+# so its result must come from the cache.
+for my $i (1 .. 5) {
+    $window->name("title $i");
+    sync_with_i3;
+}
+
+my $after = $i3->get_stats->recv->{regex};
+cmp_ok($after->{cache_hits} - $before->{cache_hits}, '>=', 5, 'class results cached');
+cmp_ok($after->{evaluations} - $before->{evaluations}, '>=', 5, 'titles evaluated again');
+
+$window->name('renamed');
+sync_with_i3;
+
+my @nodes = @{get_ws_content(focused_ws)};
+is_deeply($nodes[0]->{marks}, [ 'renamed' ], 'changed title matched');
+
+done_testing;
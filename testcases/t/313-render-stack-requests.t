@@ -0,0 +1,45 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that renders which do not change the window stack or move any
+# window do not send requests for the window stack, using the GET_STATS
+# counters.
+use i3test;
+
+my $i3 = i3(get_socket_path());
+$i3->connect->recv;
+
+fresh_workspace;
+
+my $before = $i3->get_stats->recv->{render};
+my $first = open_window(name => 'first');
+my $second = open_window(name => 'second');
+my $after = $i3->get_stats->recv->{render};
+
+cmp_ok($after->{renders}, '>', $before->{renders}, 'windows were rendered');
+cmp_ok($after->{stack_requests}, '>', $before->{stack_requests}, 'new windows were stacked');
+
+# A title change only redraws the decoration.
+$before = $after;
+$second->name('renamed');
+sync_with_i3;
+$after = $i3->get_stats->recv->{render};
+
+cmp_ok($after->{renders}, '>', $before->{renders}, 'title change was rendered');
+is($after->{last_stack_requests}, 0, 'no stack requests for a title change');
+is($after->{stack_requests}, $before->{stack_requests}, 'stack request total unchanged');
+
+done_testing;
@@ -0,0 +1,53 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that windows which are mapped at once are managed in the order in
+# which they were mapped, that property changes made while a window is being
+# managed are not lost and that windows which are destroyed before they are
+# managed are ignored.
+use i3test;
+
+my $tmp = fresh_workspace;
+
+my @windows;
+for my $i (1 .. 10) {
+    my $window = open_window(name => "window $i", dont_map => 1);
+    $window->map;
+    push @windows, $window;
+}
+# Change a title right after mapping, before i3 could manage the window.
+$windows[-1]->name('renamed');
+sync_with_i3;
+
+my @nodes = @{get_ws_content($tmp)};
+is(scalar @nodes, 10, 'all windows managed');
+is_deeply([ map { $_->{window} } @nodes ], [ map { $_->id } @windows ],
+          'windows managed in the order they were mapped');
+is($nodes[-1]->{name}, 'renamed', 'title change while managing was applied');
+
+$tmp = fresh_workspace;
+
+my $gone = open_window(dont_map => 1);
+$gone->map;
+$gone->destroy;
+my $kept = open_window;
+sync_with_i3;
+
+@nodes = @{get_ws_content($tmp)};
+is(scalar @nodes, 1, 'destroyed window not managed');
+is($nodes[0]->{window}, $kept->id, 'other window managed');
+
+done_testing;
@@ -0,0 +1,76 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that reloading the config only applies what changed: bars whose
+# configuration did not change do not get a barconfig_update event and
+# unchanged for_window assignments are not run again on existing windows.
+use i3test i3_config => <<EOT;
+# i3 config file (v4)
+font -misc-fixed-medium-r-normal--13-120-75-75-C-70-iso10646-1
+
+for_window [title="^tagged"] mark --add --toggle seen
+
+bar {
+    id mybar
+    mode hide
+}
+EOT
+
+sub get_marks {
+    return i3(get_socket_path())->get_marks->recv;
+}
+
+################################################################################
+# Reloading an unchanged config does not send barconfig_update events.
+################################################################################
+
+my @events = events_for(
+    sub { cmd 'reload' },
+    'barconfig_update');
+
+is(scalar @events, 0, 'no barconfig_update event for an unchanged bar');
+
+################################################################################
+# Reloading reverts runtime changes of a bar and sends an event for it.
+################################################################################
+
+cmd 'bar hidden_state show mybar';
+
+@events = events_for(
+    sub { cmd 'reload' },
+    'barconfig_update');
+
+is(scalar @events, 1, 'barconfig_update event for the changed bar');
+is($events[0]->{id}, 'mybar', 'event is for mybar');
+is($events[0]->{hidden_state}, 'hide', 'hidden_state reverted');
+
+################################################################################
+# Assignments which already ran are not run again after a reload.
+################################################################################
+
+fresh_workspace;
+
+my $window = open_window(name => 'tagged');
+is_deeply(get_marks(), [ 'seen' ], 'for_window ran');
+
+cmd 'reload';
+
+$window->name('tagged again');
+sync_with_i3;
+
+is_deeply(get_marks(), [ 'seen' ], 'for_window not run again after reload');
+
+done_testing;
@@ -0,0 +1,41 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that a window gets focused when i3 starts over existing windows,
+# even though the tree is only rendered once after all windows were adopted.
+use i3test i3_autostart => 0;
+
+my $config = <<EOT;
+# i3 config file (v4)
+font -misc-fixed-medium-r-normal--13-120-75-75-C-70-iso10646-1
+EOT
+
+# Without a window manager running, the windows are mapped right away.
+my $first = open_window;
+my $second = open_window;
+
+my $pid = launch_with_config($config);
+
+my $ws = focused_ws;
+is(@{get_ws_content($ws)}, 2, 'both existing windows were adopted');
+
+my $focused = get_focused($ws);
+ok(defined($focused), 'a container is focused');
+is($x->input_focus, $second->id, 'last adopted window has the input focus');
+
+exit_gracefully($pid);
+
+done_testing;
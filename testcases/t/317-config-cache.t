@@ -0,0 +1,145 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Tests the cache of parsed configs (--config-cache): reloading an unchanged
+# config replays the cached directives with the same result as parsing it,
+# while changing the config file or an X resource it uses falls back to
+# parsing.
+use i3test i3_autostart => 0;
+use i3test::XTEST;
+use X11::XCB qw(PROP_MODE_REPLACE);
+
+sub set_resources {
+    my ($resources) = @_;
+    $x->change_property(
+        PROP_MODE_REPLACE,
+        $x->get_root_window(),
+        $x->atom(name => 'RESOURCE_MANAGER')->id,
+        $x->atom(name => 'STRING')->id,
+        32,
+        length($resources),
+        $resources);
+    $x->flush;
+}
+
+sub cache_stats {
+    return i3(get_socket_path())->get_stats->recv->{config_cache};
+}
+
+sub get_marks {
+    return i3(get_socket_path())->get_marks->recv;
+}
+
+sub mark_of_new_window {
+    my $ws = fresh_workspace;
+    open_window(wm_class => 'cachetest');
+    sync_with_i3;
+    my $marks = get_marks();
+    cmd 'kill';
+    return $marks;
+}
+
+sub press_binding {
+    return listen_for_binding(
+        sub {
+            xtest_key_press(39); # s
+            xtest_key_release(39); # s
+            xtest_sync_with_i3;
+        });
+}
+
+sub get_bar_config {
+    return i3(get_socket_path())->get_bar_config('cachebar')->recv;
+}
+
+my $config = <<EOT;
+# i3 config file (v4)
+font -misc-fixed-medium-r-normal--13-120-75-75-C-70-iso10646-1
+
+bindcode 39 nop cached
+
+set_from_resource \$mark i3wm.mark none
+for_window [class=cachetest] mark \$mark
+
+bar {
+    id cachebar
+    mode hide
+    position top
+}
+EOT
+
+set_resources('*mark: first');
+
+my $pid = launch_with_config($config, config_cache => 1);
+
+is_deeply(cache_stats(), { hits => 0, misses => 1, stores => 1 },
+          'config parsed and stored on startup');
+
+is(press_binding(), 'cached', 'binding works after parsing');
+is_deeply(mark_of_new_window(), [ 'first' ], 'for_window works after parsing');
+my $bar_config = get_bar_config();
+is($bar_config->{mode}, 'hide', 'bar mode parsed');
+is($bar_config->{position}, 'top', 'bar position parsed');
+
+################################################################################
+# Reloading the unchanged config replays the cache.
+################################################################################
+
+cmd 'reload';
+
+is(cache_stats()->{hits}, 1, 'cached config applied on reload');
+is(press_binding(), 'cached', 'binding works after replaying the cache');
+is_deeply(mark_of_new_window(), [ 'first' ], 'for_window works after replaying the cache');
+is_deeply(get_bar_config(), $bar_config, 'bar config is the same after replaying the cache');
+
+################################################################################
+# Editing the config file falls back to parsing.
+################################################################################
+
+my $path = i3(get_socket_path())->get_version->recv->{loaded_config_file_name};
+open(my $fh, '<', $path) or die "Could not open $path: $!";
+my $contents = do { local $/; <$fh> };
+close($fh);
+
+$contents =~ s/nop cached/nop edited/;
+open($fh, '>', $path) or die "Could not open $path: $!";
+print $fh $contents;
+close($fh);
+
+cmd 'reload';
+
+is_deeply(cache_stats(), { hits => 1, misses => 2, stores => 2 },
+          'edited config parsed and stored');
+is(press_binding(), 'edited', 'edited binding works');
+
+################################################################################
+# Changing an X resource used by the config falls back to parsing.
+################################################################################
+
+cmd 'reload';
+is(cache_stats()->{hits}, 2, 'cache of the edited config applied');
+
+set_resources('*mark: second');
+
+cmd 'reload';
+
+is_deeply(cache_stats(), { hits => 2, misses => 3, stores => 3 },
+          'config parsed after the X resource changed');
+is_deeply(mark_of_new_window(), [ 'second' ], 'changed X resource is used');
+
+exit_gracefully($pid);
+
+done_testing;